@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include "glm/glm.hpp"
+
+// Trades resolution for frame rate, and refines the image once the view
+// settles. Frames are drawn at a fraction of the window size, chosen from the
+// measured frame time to hold the target rate: while the camera moves with
+// adaptive quality, and for every frame that shows a change with dynamic
+// resolution. Still frames of adaptive quality are drawn at full size with a
+// sub-pixel jitter and averaged by SceneTarget, so edges converge over
+// REFINEMENT_FRAMES frames. When even the smallest scale misses the target,
+// moving frames also draw coarse meshes, for frames bound by vertices rather
+// than pixels
+class AdaptiveQuality
+{
+public:
+    // Still frames averaged into one image, and the smallest scale used
+    static const unsigned int REFINEMENT_FRAMES = 8;
+    static constexpr float MIN_SCALE = 0.25f;
+
+    // Call before drawing a frame. moving: the view changed since the last
+    // frame, changed: anything else that shows did, e.g. the menu or animated
+    // meshes. frameMilliseconds is the cost of a recent frame
+    void update(bool enabled, bool dynamicResolution, int targetFps, bool moving, bool changed, double frameMilliseconds) {
+        const float lastScale = m_scale;
+        const double budget = 1000.0 / std::max(1, targetFps);
+        const bool scaled = (enabled && moving) || (dynamicResolution && (moving || changed || !enabled));
+        if (scaled && frameMilliseconds > 0.0) {
+            // Fragment cost follows the pixel count, the square of the scale.
+            // Move halfway to the estimate and ignore small errors, the
+            // measured frames lag a few frames behind
+            const float wanted = m_scale * (float)std::sqrt(budget / frameMilliseconds);
+            if (std::abs(wanted - m_scale) > 0.1f * m_scale)
+                m_scale = std::clamp(m_scale + (wanted - m_scale) * 0.5f, MIN_SCALE, 1.0f);
+            if (enabled && moving && m_scale == MIN_SCALE && frameMilliseconds > budget)
+                m_coarse = true;
+        }
+        else if (!scaled) {
+            // Still frames of adaptive quality, or no scaling at all
+            m_scale = 1.0f;
+        }
+        if (!enabled || !moving)
+            m_coarse = false;
+
+        if (!enabled || moving || changed || m_scale != lastScale) {
+            m_sample = 0;
+            m_draw = true;
+        }
+        else if (m_sample + 1 < REFINEMENT_FRAMES) {
+            m_sample++;
+            m_draw = true;
+        }
+        else {
+            // Converged, the averaged image can be shown again as it is
+            m_draw = false;
+        }
+        m_enabled = enabled;
+    }
+
+    // Whether this frame needs drawing, or the last image still holds
+    bool shouldDraw() const { return m_draw; }
+    // Whether more frames are needed to finish the still image
+    bool isRefining() const { return m_enabled && m_sample + 1 < REFINEMENT_FRAMES; }
+    // Scale of the window size to draw at
+    float getScale() const { return m_scale; }
+    // Whether to draw the coarse meshes, see MeshBatch
+    bool isCoarse() const { return m_coarse; }
+    // Frames averaged into the current image so far, this one included
+    unsigned int getSample() const { return m_sample; }
+
+    // Projection shifted by this frame's sub-pixel jitter, a Halton (2, 3)
+    // sequence. The first frame of an image is not shifted
+    glm::mat4 jitter(glm::mat4 projection, int width, int height) const {
+        if (m_sample == 0)
+            return projection;
+        const glm::vec2 offset(halton(m_sample, 2) - 0.5f, halton(m_sample, 3) - 0.5f);
+        projection[2][0] += offset.x * 2.0f / width;
+        projection[2][1] += offset.y * 2.0f / height;
+        return projection;
+    }
+
+private:
+    float m_scale = 1.0f;
+    bool m_coarse = false;
+    unsigned int m_sample = 0;
+    bool m_draw = true;
+    bool m_enabled = false;
+
+    static float halton(unsigned int index, unsigned int base) {
+        float result = 0.0f, fraction = 1.0f;
+        for (; index > 0; index /= base) {
+            fraction /= base;
+            result += fraction * (index % base);
+        }
+        return result;
+    }
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include "glm/glm.hpp"
+#include "shader.h"
+
+// Screen-space ambient occlusion of the opaque geometry. apply() runs after
+// the opaque pass and before anything transparent: it copies the depth
+// buffer, estimates the occlusion at half resolution (shaders/ssao.glsl),
+// blurs it with a separable depth-aware blur (shaders/ssaoblur.glsl) and
+// brings it back to full resolution with a bilateral upsample that takes it
+// out of the ambient light (shaders/ssaoupsample.glsl).
+//
+// The scene shaders light every surface with the same ambient color,
+// light.ambient * material.ambient, so the occluded share of it can be
+// subtracted from the drawn image without a pass before the scene: only
+// the ambient term darkens, diffuse and specular light stay as drawn.
+class AmbientOcclusion
+{
+public:
+    // Range of samples per half resolution pixel, the quality setting
+    static const int MIN_SAMPLES = 4;
+    static const int MAX_SAMPLES = 32;
+
+    AmbientOcclusion() : m_occlusion("shaders/fullscreen.glsl", "shaders/ssao.glsl"),
+        m_blur("shaders/fullscreen.glsl", "shaders/ssaoblur.glsl"),
+        m_upsample("shaders/fullscreen.glsl", "shaders/ssaoupsample.glsl") {
+        GLint program = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        m_occlusion.use();
+        m_occlusion.setInt("depth", 0);
+        m_blur.use();
+        m_blur.setInt("occlusion", 0);
+        m_upsample.use();
+        m_upsample.setInt("depth", 0);
+        m_upsample.setInt("occlusion", 1);
+        glUseProgram(program);
+
+        glGenVertexArrays(1, &m_vao);
+        glGenFramebuffers(3, m_framebuffers);
+        glGenTextures(3, m_textures);
+    }
+    ~AmbientOcclusion() {
+        glDeleteProgram(m_occlusion.get_id());
+        glDeleteProgram(m_blur.get_id());
+        glDeleteProgram(m_upsample.get_id());
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteFramebuffers(3, m_framebuffers);
+        glDeleteTextures(3, m_textures);
+    }
+    AmbientOcclusion(const AmbientOcclusion&) = delete;
+    AmbientOcclusion& operator=(const AmbientOcclusion&) = delete;
+
+    // Darken the ambient light of target, a width x height framebuffer with a
+    // 24 bit depth buffer, drawn with projection. radius is how far around a
+    // point geometry occludes it, in view space units, samples how many
+    // points of that neighborhood are tested, and ambient the ambient color
+    // of the scene shaders. The framebuffer and viewport bound before are
+    // bound again after
+    void apply(unsigned int target, int width, int height, const glm::mat4& projection, float radius, int samples,
+        const glm::vec3& ambient) {
+        GLint framebuffer = 0, program = 0, viewport[4] = { 0, 0, 0, 0 }, polygonMode[2] = { GL_FILL, GL_FILL };
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetIntegerv(GL_POLYGON_MODE, polygonMode);
+        GLint blendSource = GL_ONE, blendDestination = GL_ZERO;
+        glGetIntegerv(GL_BLEND_SRC_RGB, &blendSource);
+        glGetIntegerv(GL_BLEND_DST_RGB, &blendDestination);
+        const GLboolean blend = glIsEnabled(GL_BLEND);
+        if (width != m_width || height != m_height)
+            allocate(width, height);
+        const int halfWidth = (width + 1) / 2, halfHeight = (height + 1) / 2;
+        // A perspective projection takes view space depth z to -(z * p22 + p32) / z
+        // in normalized device coordinates, and x to (x * p00 + z * p20) / -z
+        const glm::vec4 unproject(1.0f / projection[0][0], 1.0f / projection[1][1], projection[2][0], projection[2][1]);
+        const glm::vec2 linearize(projection[3][2], projection[2][2]);
+
+        // The blit resolves a multisampled depth buffer
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, target);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffers[0]);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glBindVertexArray(m_vao);
+
+        // Occlusion and linear depth at half resolution
+        glViewport(0, 0, halfWidth, halfHeight);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[1]);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_textures[0]);
+        m_occlusion.use();
+        m_occlusion.setVec4("unproject", unproject);
+        m_occlusion.setVec2("linearize", linearize);
+        m_occlusion.setFloat("radius", radius);
+        m_occlusion.setInt("samples", std::clamp(samples, MIN_SAMPLES, MAX_SAMPLES));
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        // Horizontally into the second texture, vertically back into the first
+        m_blur.use();
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[2]);
+        glBindTexture(GL_TEXTURE_2D, m_textures[1]);
+        m_blur.setVec2("direction", glm::vec2(1.0f, 0.0f));
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[1]);
+        glBindTexture(GL_TEXTURE_2D, m_textures[2]);
+        m_blur.setVec2("direction", glm::vec2(0.0f, 1.0f));
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        // Subtract the occluded ambient light from every sample of the target
+        glViewport(0, 0, width, height);
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+        glBindTexture(GL_TEXTURE_2D, m_textures[0]);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, m_textures[1]);
+        m_upsample.use();
+        m_upsample.setVec2("linearize", linearize);
+        m_upsample.setVec3("ambient", ambient);
+        glEnable(GL_BLEND);
+        glBlendEquation(GL_FUNC_REVERSE_SUBTRACT);
+        glBlendFunc(GL_ONE, GL_ONE);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBlendEquation(GL_FUNC_ADD);
+        glBlendFunc(blendSource, blendDestination);
+        if (!blend)
+            glDisable(GL_BLEND);
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindVertexArray(0);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glUseProgram(program);
+        glPolygonMode(GL_FRONT_AND_BACK, polygonMode[0]);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+private:
+    Shader m_occlusion, m_blur, m_upsample;
+    unsigned int m_vao = 0;
+    // Depth copy, then the two half resolution occlusion and depth targets
+    unsigned int m_framebuffers[3] = {}, m_textures[3] = {};
+    int m_width = 0, m_height = 0;
+
+    void allocate(int width, int height) {
+        m_width = width;
+        m_height = height;
+
+        glBindTexture(GL_TEXTURE_2D, m_textures[0]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+        setNearest();
+        setClampToEdge();
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[0]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_textures[0], 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+
+        for (int i = 1; i < 3; i++) {
+            glBindTexture(GL_TEXTURE_2D, m_textures[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, (width + 1) / 2, (height + 1) / 2, 0, GL_RG, GL_FLOAT, NULL);
+            setNearest();
+            setClampToEdge();
+            glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[i]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_textures[i], 0);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    static void setNearest() {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    }
+    // Taps past the border repeat the edge
+    static void setClampToEdge() {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+};
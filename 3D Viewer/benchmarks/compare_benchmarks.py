@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""Compare two render_benchmark JSON files and flag regressions.
+
+Usage: compare_benchmarks.py baseline.json current.json [--threshold 0.10]
+
+A metric regresses when the current value exceeds the baseline by more than
+the threshold (a fraction, 0.10 = 10 %). Values below --min-ms milliseconds
+are ignored, they are dominated by timer noise. Exits with 1 if anything
+regressed, so it can gate a CI job.
+"""
+
+import argparse
+import json
+import sys
+
+# Metric path inside a result, and whether it is a time in milliseconds
+METRICS = [
+    (("import_ms",), True),
+    (("upload_ms",), True),
+    (("cpu_frame_ms", "median"), True),
+    (("gpu_frame_ms", "median"), True),
+    (("frame_ms", "median"), True),
+    (("peak_rss_mb",), False),
+]
+
+
+def lookup(result, path):
+    value = result
+    for key in path:
+        if not isinstance(value, dict) or key not in value:
+            return None
+        value = value[key]
+    return value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.10)
+    parser.add_argument("--min-ms", type=float, default=0.05)
+    args = parser.parse_args()
+
+    with open(args.baseline) as file:
+        baseline = {result["name"]: result for result in json.load(file)["results"]}
+    with open(args.current) as file:
+        current = json.load(file)["results"]
+
+    regressions = 0
+    print(f"{'mesh':<24} {'metric':<20} {'baseline':>12} {'current':>12} {'change':>8}")
+    for result in current:
+        reference = baseline.get(result["name"])
+        if reference is None:
+            print(f"{result['name']:<24} not in baseline")
+            continue
+        for path, is_time in METRICS:
+            old, new = lookup(reference, path), lookup(result, path)
+            if old is None or new is None:
+                continue
+            if is_time and max(old, new) < args.min_ms:
+                continue
+            change = (new - old) / old if old > 0 else 0.0
+            regressed = change > args.threshold
+            regressions += regressed
+            print(f"{result['name']:<24} {'.'.join(path):<20} {old:>12.3f} {new:>12.3f} {change:>+7.1%}"
+                  + ("  REGRESSION" if regressed else ""))
+
+    if regressions:
+        print(f"{regressions} regression(s) over {args.threshold:.0%}")
+        return 1
+    print(f"no regressions over {args.threshold:.0%}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,398 @@
+// Import benchmark
+//
+// Measures how the STL, OBJ, PLY and glTF2 importers and the post-processing
+// steps the viewer runs scale with input size. Synthetic height field grids
+// are written in every format at each size (quads for OBJ and PLY so the
+// triangulation has work, triangles for STL and glTF2), then each file is
+// imported without post-processing and the steps are applied one at a time:
+// Triangulate, GenSmoothNormals (after the loaded normals are removed),
+// JoinIdenticalVertices and ImproveCacheLocality, and the scene is freed.
+// Every stage reports its median time and the number and size of the
+// allocations it made, and how many it freed.
+//
+// Usage: import_benchmark [--triangles 1000,10000,...] [--formats stl,obj,ply,glb]
+//                         [-n iterations] [--data folder] [--out file.json]
+//                         [--arena] [--mmap] [--trusted]
+// Results go to stdout as JSON, a table goes to stderr. See CMakeLists.txt.
+
+#include <string>
+#include <vector>
+#include <map>
+#include <new>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <assimp/include/scene.h>
+#include <assimp/include/Importer.hpp>
+#include <assimp/include/postprocess.h>
+#include <assimp/include/MMapIOSystem.h>
+
+// Every operator new and delete of the process, assimp included, is counted
+static std::atomic<size_t> allocations{ 0 }, allocatedBytes{ 0 }, deallocations{ 0 };
+
+void* operator new(size_t size) {
+    allocations++;
+    allocatedBytes += size;
+    if (void* memory = malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    allocations++;
+    allocatedBytes += size;
+    return malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* memory) noexcept {
+    if (memory)
+        deallocations++;
+    free(memory);
+}
+void operator delete[](void* memory) noexcept { operator delete(memory); }
+void operator delete(void* memory, size_t) noexcept { operator delete(memory); }
+void operator delete[](void* memory, size_t) noexcept { operator delete(memory); }
+
+struct Grid {
+    unsigned int n;  // Quads per side
+    std::vector<float> positions;
+
+    explicit Grid(unsigned int triangles) : n(std::max(1u, (unsigned int)std::ceil(std::sqrt(triangles / 2.0)))) {
+        positions.reserve((n + 1) * (n + 1) * 3);
+        for (unsigned int y = 0; y <= n; y++) {
+            for (unsigned int x = 0; x <= n; x++) {
+                float u = (float)x / n, v = (float)y / n;
+                positions.insert(positions.end(), { u, v, 0.05f * std::sin(12.0f * u) * std::cos(9.0f * v) });
+            }
+        }
+    }
+    unsigned int vertex(unsigned int x, unsigned int y) const { return y * (n + 1) + x; }
+    unsigned int numVertices() const { return (n + 1) * (n + 1); }
+    // Corners of quad (x, y), counter-clockwise seen from +z
+    void quad(unsigned int x, unsigned int y, unsigned int* corners) const {
+        corners[0] = vertex(x, y);
+        corners[1] = vertex(x + 1, y);
+        corners[2] = vertex(x + 1, y + 1);
+        corners[3] = vertex(x, y + 1);
+    }
+    template <typename Callback>
+    void forEachTriangle(Callback callback) const {
+        unsigned int corners[4];
+        for (unsigned int y = 0; y < n; y++) {
+            for (unsigned int x = 0; x < n; x++) {
+                quad(x, y, corners);
+                callback(corners[0], corners[1], corners[2]);
+                callback(corners[0], corners[2], corners[3]);
+            }
+        }
+    }
+};
+
+static bool writeSTL(const Grid& grid, const std::string& path) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    char header[80] = "import_benchmark grid";
+    unsigned int count = 2 * grid.n * grid.n;
+    fwrite(header, 1, sizeof(header), file);
+    fwrite(&count, 4, 1, file);
+    grid.forEachTriangle([&](unsigned int a, unsigned int b, unsigned int c) {
+        float record[12] = { 0.0f, 0.0f, 1.0f };
+        memcpy(record + 3, &grid.positions[a * 3], 12);
+        memcpy(record + 6, &grid.positions[b * 3], 12);
+        memcpy(record + 9, &grid.positions[c * 3], 12);
+        unsigned short attributes = 0;
+        fwrite(record, 4, 12, file);
+        fwrite(&attributes, 2, 1, file);
+    });
+    return fclose(file) == 0;
+}
+
+static bool writeOBJ(const Grid& grid, const std::string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+    for (unsigned int i = 0; i < grid.numVertices(); i++)
+        fprintf(file, "v %.6f %.6f %.6f\n", grid.positions[i * 3], grid.positions[i * 3 + 1], grid.positions[i * 3 + 2]);
+    unsigned int corners[4];
+    for (unsigned int y = 0; y < grid.n; y++) {
+        for (unsigned int x = 0; x < grid.n; x++) {
+            grid.quad(x, y, corners);
+            fprintf(file, "f %u %u %u %u\n", corners[0] + 1, corners[1] + 1, corners[2] + 1, corners[3] + 1);
+        }
+    }
+    return fclose(file) == 0;
+}
+
+static bool writePLY(const Grid& grid, const std::string& path) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    fprintf(file, "ply\nformat binary_little_endian 1.0\nelement vertex %u\n"
+        "property float x\nproperty float y\nproperty float z\n"
+        "element face %u\nproperty list uchar uint vertex_indices\nend_header\n", grid.numVertices(), grid.n * grid.n);
+    fwrite(grid.positions.data(), 4, grid.positions.size(), file);
+    unsigned int corners[4];
+    for (unsigned int y = 0; y < grid.n; y++) {
+        for (unsigned int x = 0; x < grid.n; x++) {
+            grid.quad(x, y, corners);
+            unsigned char count = 4;
+            fwrite(&count, 1, 1, file);
+            fwrite(corners, 4, 4, file);
+        }
+    }
+    return fclose(file) == 0;
+}
+
+// Binary glTF2 with one indexed triangle primitive
+static bool writeGLB(const Grid& grid, const std::string& path) {
+    std::vector<unsigned int> indices;
+    indices.reserve(6 * grid.n * grid.n);
+    grid.forEachTriangle([&](unsigned int a, unsigned int b, unsigned int c) {
+        indices.insert(indices.end(), { a, b, c });
+    });
+    const size_t positionBytes = grid.positions.size() * 4, indexBytes = indices.size() * 4;
+    float boundsMin[3] = { 0.0f, 0.0f, 1e30f }, boundsMax[3] = { 1.0f, 1.0f, -1e30f };
+    for (unsigned int i = 0; i < grid.numVertices(); i++) {
+        boundsMin[2] = std::min(boundsMin[2], grid.positions[i * 3 + 2]);
+        boundsMax[2] = std::max(boundsMax[2], grid.positions[i * 3 + 2]);
+    }
+
+    char json[2048];
+    int length = snprintf(json, sizeof(json),
+        "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+        "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"indices\":1,\"mode\":4}]}],"
+        "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\","
+        "\"min\":[%g,%g,%g],\"max\":[%g,%g,%g]},"
+        "{\"bufferView\":1,\"componentType\":5125,\"count\":%zu,\"type\":\"SCALAR\"}],"
+        "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%zu,\"target\":34962},"
+        "{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu,\"target\":34963}],"
+        "\"buffers\":[{\"byteLength\":%zu}]}",
+        grid.numVertices(), boundsMin[0], boundsMin[1], boundsMin[2], boundsMax[0], boundsMax[1], boundsMax[2],
+        indices.size(), positionBytes, positionBytes, indexBytes, positionBytes + indexBytes);
+    // Chunks are padded to 4 bytes, JSON with spaces
+    while (length % 4)
+        json[length++] = ' ';
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    unsigned int binLength = (unsigned int)(positionBytes + indexBytes);
+    unsigned int header[5] = { 0x46546C67, 2, (unsigned int)(12 + 8 + length + 8 + binLength), (unsigned int)length, 0x4E4F534A };
+    fwrite(header, 4, 5, file);
+    fwrite(json, 1, length, file);
+    unsigned int binHeader[2] = { binLength, 0x004E4942 };
+    fwrite(binHeader, 4, 2, file);
+    fwrite(grid.positions.data(), 1, positionBytes, file);
+    fwrite(indices.data(), 1, indexBytes, file);
+    return fclose(file) == 0;
+}
+
+struct Format {
+    const char* name;
+    bool (*write)(const Grid&, const std::string&);
+};
+static const Format formats[] = { { "stl", writeSTL }, { "obj", writeOBJ }, { "ply", writePLY }, { "glb", writeGLB } };
+
+// Stages in the order assimp runs them, "import" is the loader without
+// post-processing. Normals are generated on unjoined vertices. "free" is
+// Importer::FreeScene(), a single release with the scene arena
+struct Stage {
+    const char* name;
+    unsigned int flags;
+};
+static const Stage stages[] = {
+    { "import", 0 },
+    { "triangulate", aiProcess_Triangulate },
+    { "gen_normals", aiProcess_GenSmoothNormals },
+    { "join_vertices", aiProcess_JoinIdenticalVertices },
+    { "cache_locality", aiProcess_ImproveCacheLocality },
+    { "free", 0 },
+};
+static const unsigned int numStages = sizeof(stages) / sizeof(stages[0]);
+
+struct Sample {
+    double ms = 0.0;
+    size_t allocations = 0, bytes = 0, frees = 0;
+};
+
+struct Options {
+    std::vector<unsigned int> triangles = { 1000, 10000, 100000, 1000000 };
+    std::vector<std::string> formats = { "stl", "obj", "ply", "glb" };
+    int iterations = 5;
+    std::string dataFolder = "benchmark_data", outPath;
+    bool arena = false, mmap = false, trusted = false;
+};
+
+template <typename Function>
+static Sample measure(Function function) {
+    size_t startAllocations = allocations, startBytes = allocatedBytes, startFrees = deallocations;
+    auto start = std::chrono::steady_clock::now();
+    bool ok = function();
+    Sample sample;
+    sample.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    sample.allocations = allocations - startAllocations;
+    sample.bytes = allocatedBytes - startBytes;
+    sample.frees = deallocations - startFrees;
+    if (!ok)
+        sample.ms = -1.0;
+    return sample;
+}
+
+// One pass over all stages on a fresh import, false if the file fails to load
+static bool runPipeline(const std::string& path, const Options& options, Sample* samples, unsigned int& numMeshTriangles) {
+    Assimp::Importer import;
+    if (options.mmap)
+        import.SetIOHandler(new Assimp::MMapIOSystem());
+    import.SetPropertyBool(AI_CONFIG_IMPORT_SCENE_ARENA, options.arena);
+    import.SetPropertyBool(AI_CONFIG_IMPORT_TRUSTED_INPUT, options.trusted);
+    import.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, aiComponent_NORMALS);
+
+    for (unsigned int i = 0; i < numStages; i++) {
+        const Stage& stage = stages[i];
+        if (!strcmp(stage.name, "gen_normals")) {
+            // Loaded normals would make the step a no-op, STL always has them
+            import.ApplyPostProcessing(aiProcess_RemoveComponent);
+        }
+        if (!strcmp(stage.name, "free")) {
+            numMeshTriangles = 0;
+            const aiScene* scene = import.GetScene();
+            for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+                numMeshTriangles += scene->mMeshes[m]->mNumFaces;
+            samples[i] = measure([&]() {
+                import.FreeScene();
+                return true;
+            });
+            continue;
+        }
+        samples[i] = measure([&]() {
+            return stage.flags ? import.ApplyPostProcessing(stage.flags) != nullptr : import.ReadFile(path, 0) != nullptr;
+        });
+        if (samples[i].ms < 0.0)
+            return false;
+    }
+    return true;
+}
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0.0 : values[values.size() / 2];
+}
+
+static std::vector<unsigned int> parseCounts(const char* list) {
+    std::vector<unsigned int> counts;
+    while (*list) {
+        char* end;
+        unsigned long count = strtoul(list, &end, 10);
+        if (end == list)
+            break;
+        if (count)
+            counts.push_back((unsigned int)count);
+        list = *end == ',' ? end + 1 : end;
+    }
+    return counts;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--triangles") && hasValue) {
+            options.triangles = parseCounts(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--formats") && hasValue) {
+            options.formats.clear();
+            std::string list = argv[++i];
+            for (size_t begin = 0, end; begin < list.size(); begin = end + 1) {
+                end = std::min(list.find(',', begin), list.size());
+                options.formats.push_back(list.substr(begin, end - begin));
+            }
+        }
+        else if (!strcmp(argv[i], "-n") && hasValue) {
+            options.iterations = std::max(1, atoi(argv[++i]));
+        }
+        else if (!strcmp(argv[i], "--data") && hasValue) {
+            options.dataFolder = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--out") && hasValue) {
+            options.outPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--arena")) {
+            options.arena = true;
+        }
+        else if (!strcmp(argv[i], "--mmap")) {
+            options.mmap = true;
+        }
+        else if (!strcmp(argv[i], "--trusted")) {
+            options.trusted = true;
+        }
+        else {
+            printf("usage: %s [--triangles 1000,10000,...] [--formats stl,obj,ply,glb] [-n iterations] "
+                "[--data folder] [--out file.json] [--arena] [--mmap] [--trusted]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(options.dataFolder, error);
+    FILE* out = options.outPath.empty() ? stdout : fopen(options.outPath.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "could not write %s\n", options.outPath.c_str());
+        return 1;
+    }
+    fprintf(out, "{\n  \"iterations\": %d,\n  \"arena\": %s,\n  \"mmap\": %s,\n  \"trusted\": %s,\n  \"results\": [",
+        options.iterations, options.arena ? "true" : "false", options.mmap ? "true" : "false", options.trusted ? "true" : "false");
+    fprintf(stderr, "%-6s %10s %-15s %12s %12s %14s %12s   (median of %d)\n", "format", "triangles", "stage", "ms",
+        "allocations", "bytes", "frees", options.iterations);
+
+    bool first = true;
+    int failures = 0;
+    for (unsigned int triangles : options.triangles) {
+        Grid grid(triangles);
+        for (const Format& format : formats) {
+            if (std::find(options.formats.begin(), options.formats.end(), format.name) == options.formats.end())
+                continue;
+            std::string path = (std::filesystem::path(options.dataFolder) /
+                ("grid_" + std::to_string(triangles) + "." + format.name)).string();
+            if (!std::filesystem::exists(path) && !format.write(grid, path)) {
+                fprintf(stderr, "could not write %s\n", path.c_str());
+                return 1;
+            }
+
+            std::vector<double> times[numStages];
+            Sample last[numStages];
+            unsigned int numMeshTriangles = 0;
+            bool ok = true;
+            for (int iteration = 0; iteration < options.iterations && ok; iteration++) {
+                ok = runPipeline(path, options, last, numMeshTriangles);
+                for (unsigned int i = 0; i < numStages && ok; i++)
+                    times[i].push_back(last[i].ms);
+            }
+            if (!ok) {
+                fprintf(stderr, "%-6s %10u failed to import %s\n", format.name, triangles, path.c_str());
+                failures++;
+                continue;
+            }
+
+            for (unsigned int i = 0; i < numStages; i++) {
+                double ms = median(times[i]);
+                fprintf(stderr, "%-6s %10u %-15s %12.3f %12zu %14zu %12zu\n", format.name, triangles, stages[i].name, ms,
+                    last[i].allocations, last[i].bytes, last[i].frees);
+                fprintf(out, "%s\n    { \"format\": \"%s\", \"triangles\": %u, \"mesh_triangles\": %u, \"stage\": \"%s\", "
+                    "\"ms\": %.4f, \"allocations\": %zu, \"bytes\": %zu, \"frees\": %zu }", first ? "" : ",", format.name,
+                    triangles, numMeshTriangles, stages[i].name, ms, last[i].allocations, last[i].bytes, last[i].frees);
+                first = false;
+            }
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout)
+        fclose(out);
+    return failures ? 2 : 0;
+}
@@ -0,0 +1,113 @@
+// Import phase benchmark
+//
+// Imports every file given on the command line with the checked profile
+// (aiProcess_ValidateDataStructure on top of the viewer's flags) and the
+// trusted profile (AI_CONFIG_IMPORT_TRUSTED_INPUT), then prints the median
+// time of each import phase. The phases are the Tracer regions that
+// Importer::ReadFile() records when AI_CONFIG_GLOB_MEASURE_TIME is set.
+//
+// Usage: import_phases [-n iterations] file...
+// Build against the same assimp as the viewer.
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <assimp/include/scene.h>
+#include <assimp/include/Importer.hpp>
+#include <assimp/include/postprocess.h>
+#include <assimp/include/MMapIOSystem.h>
+#include <assimp/include/Tracer.h>
+
+using Assimp::Profiling::Tracer;
+using Assimp::Profiling::TraceEvent;
+
+// Phases in report order, postprocess sums up all executed steps
+static const char* phases[] = { "import", "validate", "preprocess", "postprocess", "ReadFile" };
+
+// Sums up the time spent in each region recorded since the last call
+static std::map<std::string, double> collectSeconds() {
+    std::vector<TraceEvent> events;
+    Tracer::Collect(events);
+    Tracer::Clear();
+
+    std::map<std::string, double> seconds;
+    std::map<unsigned int, std::vector<uint64_t>> open;
+    for (const TraceEvent& event : events) {
+        std::vector<uint64_t>& stack = open[event.mThread];
+        if (event.mBegin) {
+            stack.push_back(event.mTime);
+        }
+        else if (!stack.empty()) {
+            seconds[Tracer::GetName(event.mName)] += (event.mTime - stack.back()) * 1e-9;
+            stack.pop_back();
+        }
+    }
+    return seconds;
+}
+
+static double median(std::vector<double> values) {
+    if (values.empty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 5;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            iterations = std::max(1, atoi(argv[++i]));
+        else
+            files.push_back(argv[i]);
+    }
+    if (files.empty()) {
+        printf("usage: %s [-n iterations] file...\n", argv[0]);
+        return 1;
+    }
+
+    printf("%-32s %-8s %10s %10s %10s %12s %10s   (ms, median of %d)\n",
+        "file", "profile", "import", "validate", "preprocess", "postprocess", "total", iterations);
+
+    for (const std::string& file : files) {
+        for (int trusted = 0; trusted < 2; trusted++) {
+            // Same setup as Model::loadModel, plus validation for the checked profile
+            Assimp::Importer import;
+            import.SetIOHandler(new Assimp::MMapIOSystem());
+            import.SetPropertyBool(AI_CONFIG_IMPORT_SCENE_ARENA, true);
+            import.SetPropertyBool(AI_CONFIG_IMPORT_TRUSTED_INPUT, trusted != 0);
+            import.SetPropertyBool(AI_CONFIG_GLOB_MEASURE_TIME, true);
+            const unsigned int flags = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices |
+                aiProcess_ImproveCacheLocality | aiProcess_ValidateDataStructure;
+
+            std::map<std::string, std::vector<double>> samples;
+            bool failed = false;
+            for (int i = 0; i < iterations; i++) {
+                Tracer::Clear();
+                if (!import.ReadFile(file, flags)) {
+                    failed = true;
+                    break;
+                }
+                import.FreeScene();
+                std::map<std::string, double> seconds = collectSeconds();
+                for (const char* phase : phases)
+                    samples[phase].push_back(seconds[phase] * 1000.0);
+            }
+            if (failed) {
+                printf("%-32s %-8s failed: %s\n", file.c_str(), trusted ? "trusted" : "checked", import.GetErrorString());
+                continue;
+            }
+
+            printf("%-32s %-8s %10.2f %10.2f %10.2f %12.2f %10.2f\n", file.c_str(), trusted ? "trusted" : "checked",
+                median(samples["import"]), median(samples["validate"]), median(samples["preprocess"]),
+                median(samples["postprocess"]), median(samples["ReadFile"]));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,586 @@
+// Render benchmark
+//
+// Loads reference meshes through Model, the viewer's own import and upload
+// path, then renders a fixed camera path of N frames through Camera::orbit
+// and Camera::zoom into an offscreen framebuffer. Per mesh it records import
+// time, upload time, CPU frame time, GPU frame time (timer queries) and peak
+// RSS, and writes all of it as JSON for compare_benchmarks.py.
+//
+// The reference meshes are tori of 1K to 50M triangles, written once as
+// binary PLY files into the data folder and reused by later runs. --mesh adds
+// any other model file. --parts adds grids of separate cubes, many small
+// meshes rather than one large one. The context comes from GLFW's null
+// platform with EGL or OSMesa, as in headless mode, so it runs on CI machines
+// without a GPU.
+//
+// --transparency renders every model again with all materials at half
+// opacity, through weighted blended transparency (oit) or culling and sorting
+// on the CPU each frame (sorted). --lights renders them again with that
+// many random point lights through the clustered lighting. --occlusion on
+// renders them again culling parts hidden in the depth pyramid of earlier
+// frames (see DepthPyramid), and reports the fraction of parts culled.
+// --meshlets on renders them again with frustum culling and the meshlets of
+// large meshes culled by frustum and normal cone (see Meshlets), and reports
+// the fraction of meshlets drawn. --ssao on renders them again with screen-
+// space ambient occlusion after the opaque pass (see AmbientOcclusion), at
+// the viewer's default quality. These results get the mode, light count,
+// occlusion, meshlets or ssao as a suffix.
+//
+// The time to build the viewer's shaders is reported as shader_ms, loaded
+// from the program cache unless --no-shader-cache is given. Meshlets are
+// part of the upload, loaded from their cache unless --no-meshlet-cache.
+//
+// Usage: render_benchmark [--frames N] [--size WxH] [--triangles 1000,10000,...]
+//                         [--parts 1000,20000,...] [--transparency none,oit,sorted] [--lights 0,100,...]
+//                         [--occlusion off,on] [--meshlets off,on] [--ssao off,on] [--no-shader-cache]
+//                         [--no-meshlet-cache] [--mesh file]... [--data folder] [--out file.json]
+// Run it from the viewer folder so shaders/ is found. See CMakeLists.txt.
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <memory>
+#include <sys/resource.h>
+#include "../headless.h"
+#include "../lights.h"
+#include "../depthpyramid.h"
+#include "../ambientocclusion.h"
+
+struct Result {
+    std::string name;
+    unsigned int triangles = 0, vertices = 0;
+    double importMs = 0.0, uploadMs = 0.0;
+    std::vector<double> cpuFrameMs, gpuFrameMs, frameMs;
+    double peakRssMb = 0.0;
+    // Mean fraction of the parts occlusion culling dropped, negative without it
+    double occludedFraction = -1.0;
+    // Mean fraction of the meshlets drawn, negative without meshlet culling
+    double meshletsDrawnFraction = -1.0;
+};
+
+// Forget the peak so far, so each mesh reports its own
+static void resetPeakRss() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+}
+
+// VmHWM of the process, ru_maxrss where /proc is missing
+static double peakRssMb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0)
+            return atof(line.c_str() + 6) / 1024.0;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+// Binary PLY torus of about the given triangle count, with normals so the
+// import does not spend its time generating them
+static bool writeTorus(const std::string& path, unsigned int triangles) {
+    const unsigned int n = std::max(3u, (unsigned int)std::ceil(std::sqrt(triangles / 2.0)));
+    const unsigned int numVertices = n * n, numFaces = 2 * n * n;
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    fprintf(file, "ply\nformat binary_little_endian 1.0\nelement vertex %u\n"
+        "property float x\nproperty float y\nproperty float z\n"
+        "property float nx\nproperty float ny\nproperty float nz\n"
+        "element face %u\nproperty list uchar uint vertex_indices\nend_header\n", numVertices, numFaces);
+
+    const float pi = 3.14159265f, major = 1.0f, minor = 0.35f;
+    std::vector<float> row(n * 6);
+    for (unsigned int i = 0; i < n; i++) {
+        float u = 2.0f * pi * i / n;
+        for (unsigned int j = 0; j < n; j++) {
+            float v = 2.0f * pi * j / n;
+            float* vertex = &row[j * 6];
+            vertex[3] = std::cos(u) * std::cos(v);
+            vertex[4] = std::sin(v);
+            vertex[5] = std::sin(u) * std::cos(v);
+            vertex[0] = major * std::cos(u) + minor * vertex[3];
+            vertex[1] = minor * vertex[4];
+            vertex[2] = major * std::sin(u) + minor * vertex[5];
+        }
+        fwrite(row.data(), sizeof(float), row.size(), file);
+    }
+
+    #pragma pack(push, 1)
+    struct Face { unsigned char count; unsigned int index[3]; };
+    #pragma pack(pop)
+    std::vector<Face> faces(2 * n);
+    for (unsigned int i = 0; i < n; i++) {
+        unsigned int next = (i + 1) % n;
+        for (unsigned int j = 0; j < n; j++) {
+            unsigned int up = (j + 1) % n;
+            unsigned int a = i * n + j, b = next * n + j, c = next * n + up, d = i * n + up;
+            faces[2 * j] = { 3, { a, d, c } };
+            faces[2 * j + 1] = { 3, { a, c, b } };
+        }
+        fwrite(faces.data(), sizeof(Face), faces.size(), file);
+    }
+    return fclose(file) == 0;
+}
+
+// OBJ grid of separate unit cubes, one object each, so every cube stays its
+// own mesh through the import
+static bool writeParts(const std::string& path, unsigned int parts) {
+    const unsigned int side = std::max(1u, (unsigned int)std::ceil(std::cbrt((double)parts)));
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+    fprintf(file, "vn 1 0 0\nvn -1 0 0\nvn 0 1 0\nvn 0 -1 0\nvn 0 0 1\nvn 0 0 -1\n");
+    // Corners as bits x, y, z, and each face's corners counter-clockwise from outside
+    static const unsigned int faces[6][4] = { { 1, 3, 7, 5 }, { 0, 4, 6, 2 }, { 2, 6, 7, 3 }, { 0, 1, 5, 4 },
+        { 4, 5, 7, 6 }, { 0, 2, 3, 1 } };
+    for (unsigned int part = 0; part < parts; part++) {
+        const float x = (float)(part % side) * 2.0f, y = (float)(part / side % side) * 2.0f, z = (float)(part / side / side) * 2.0f;
+        fprintf(file, "o part_%u\n", part);
+        for (unsigned int corner = 0; corner < 8; corner++)
+            fprintf(file, "v %g %g %g\n", x + (corner & 1), y + (corner >> 1 & 1), z + (corner >> 2 & 1));
+        for (unsigned int face = 0; face < 6; face++) {
+            const unsigned int* c = faces[face];
+            fprintf(file, "f %d//%u %d//%u %d//%u %d//%u\n", (int)c[0] - 8, face + 1, (int)c[1] - 8, face + 1,
+                (int)c[2] - 8, face + 1, (int)c[3] - 8, face + 1);
+        }
+    }
+    return fclose(file) == 0;
+}
+
+// Comma-separated counts, zeros skipped
+static std::vector<unsigned int> parseCounts(const char* list) {
+    std::vector<unsigned int> counts;
+    while (*list) {
+        char* end;
+        unsigned long count = strtoul(list, &end, 10);
+        if (end == list)
+            break;
+        if (count)
+            counts.push_back((unsigned int)count);
+        list = *end == ',' ? end + 1 : end;
+    }
+    return counts;
+}
+
+enum class Transparency { None, WeightedBlended, Sorted };
+
+static double percentile(std::vector<double> values, double fraction) {
+    if (values.empty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, (size_t)(fraction * values.size()))];
+}
+
+static void writeStats(FILE* out, const char* name, const std::vector<double>& values) {
+    double mean = 0.0;
+    for (double value : values)
+        mean += value;
+    mean = values.empty() ? 0.0 : mean / values.size();
+    fprintf(out, "      \"%s\": { \"mean\": %.4f, \"median\": %.4f, \"p95\": %.4f },\n", name, mean,
+        percentile(values, 0.5), percentile(values, 0.95));
+}
+
+static void escape(FILE* out, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            fputc('\\', out);
+        fputc(c, out);
+    }
+}
+
+static Result benchmark(const std::string& path, unsigned int frames, unsigned int width, unsigned int height,
+    ShaderVariants& variants, Menu& menu, OffscreenFramebuffer& framebuffer, Transparency transparency, WeightedBlendedOIT& oit,
+    unsigned int numLights, ClusteredLights& lights, bool occlusion, bool meshlets, AmbientOcclusion* ambientOcclusion) {
+    Result result;
+    result.name = std::filesystem::path(path).stem().string();
+    if (transparency == Transparency::WeightedBlended)
+        result.name += "_oit";
+    else if (transparency == Transparency::Sorted)
+        result.name += "_sorted";
+    if (numLights)
+        result.name += "_lights" + std::to_string(numLights);
+    if (occlusion)
+        result.name += "_occlusion";
+    if (meshlets)
+        result.name += "_meshlets";
+    if (ambientOcclusion)
+        result.name += "_ssao";
+
+    resetPeakRss();
+    Model model(path);
+    // Count the driver's copy into the upload
+    auto finish = std::chrono::steady_clock::now();
+    glFinish();
+    result.importMs = model.getImportTime() * 1000.0;
+    result.uploadMs = (model.getUploadTime() + std::chrono::duration<double>(std::chrono::steady_clock::now() - finish).count()) * 1000.0;
+    result.triangles = model.getNumTriangles();
+    result.vertices = model.getNumVertices();
+    // The variants drawn with, built before the frames are timed
+    const unsigned int features = numLights ? ShaderVariants::SCENE_LIGHTS : 0;
+    Shader& shader = variants.select(features);
+    Shader& accumulate = variants.select(features | ShaderVariants::OIT_ACCUMULATE);
+    for (Shader* pass : { &shader, &accumulate }) {
+        pass->use();
+        pass->reloadValues(&menu);
+        pass->setMat4("model", model.getFitTransform());
+    }
+    if (transparency != Transparency::None) {
+        for (unsigned int material = 0; material < model.getMaterials().size(); material++)
+            model.setMaterialOpacity(material, 0.5f);
+    }
+    // Lights through the fitted model, which is centered on the origin
+    lights.clear();
+    glm::vec3 boundsMin, boundsMax;
+    if (numLights && model.getBounds(boundsMin, boundsMax)) {
+        const glm::mat4 fit = model.getFitTransform();
+        lights.addRandomLights(numLights, glm::vec3(fit * glm::vec4(boundsMin, 1.0f)), glm::vec3(fit * glm::vec4(boundsMax, 1.0f)));
+    }
+
+    Camera camera;
+    camera.setScreenDimensions(width, height);
+    camera.setSensitivities(1.0f, 1.0f, 1.0f);
+    // A pyramid of its own, so no depth of the previous model is tested against
+    std::unique_ptr<DepthPyramid> pyramid(occlusion ? new DepthPyramid() : nullptr);
+    const glm::mat4 fit = model.getFitTransform();
+    double occluded = 0.0, meshletsDrawn = 0.0;
+    // Occlusion radius as the viewer scales it to the model
+    float radius = 0.0f;
+    if (model.getBounds(boundsMin, boundsMax))
+        radius = glm::length(glm::vec3(fit * glm::vec4(boundsMax - boundsMin, 0.0f))) * 0.04f;
+    auto occludeAmbient = [&]() {
+        if (ambientOcclusion)
+            ambientOcclusion->apply(framebuffer.getFramebuffer(), width, height, camera.getProjectionMatrix(), radius,
+                menu.getAmbientOcclusionSamples(), menu.getAmbientLightingColor() * menu.getAmbientMaterialColor());
+    };
+
+    // A few frames in flight, like a swap chain would allow
+    const unsigned int latency = 3;
+    std::vector<unsigned int> queries(frames);
+    glGenQueries(frames, queries.data());
+    for (unsigned int frame = 0; frame < frames; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        // Two turns around the model, zooming in for the first and out for the second
+        camera.orbit(720.0f / frames, frame < frames / 2 ? 0.05f : -0.05f);
+        camera.zoom(frame < frames / 2 ? 0.02 : -0.02);
+        lights.update(camera.getViewMatrix(), camera.getProjectionMatrix(), width, height);
+        for (Shader* pass : { &accumulate, &shader }) {
+            pass->use();
+            pass->setMat4("view", camera.getViewMatrix());
+            pass->setMat4("projection", camera.getProjectionMatrix());
+            pass->setVec3("light.position", camera.getPosition());
+            pass->setVec3("view_pos", camera.getPosition());
+            lights.apply(*pass);
+        }
+
+        framebuffer.bind();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glBeginQuery(GL_TIME_ELAPSED, queries[frame]);
+        const glm::mat4 viewProjection = camera.getProjectionMatrix() * camera.getViewMatrix();
+        if (pyramid || meshlets) {
+            if (pyramid)
+                pyramid->collect();
+            model.cull(viewProjection * fit, meshlets, transparency == Transparency::Sorted, false, pyramid.get(),
+                pyramid ? pyramid->getViewProjection() * fit : glm::mat4(1.0f), meshlets);
+            occluded += model.getNumParts() ? (double)model.getNumOccludedParts() / model.getNumParts() : 0.0;
+            meshletsDrawn += model.getNumMeshlets() ? (double)model.getNumMeshletsDrawn() / model.getNumMeshlets() : 1.0;
+        }
+        if (transparency == Transparency::None) {
+            model.Draw();
+            if (pyramid)
+                pyramid->build(framebuffer.getFramebuffer(), width, height, viewProjection);
+            occludeAmbient();
+        }
+        else {
+            // Frustum culling is off, the sort is what is measured
+            if (!pyramid && !meshlets)
+                model.cull(viewProjection * fit, false, transparency == Transparency::Sorted);
+            model.Draw(MeshBatch::Pass::Opaque);
+            if (pyramid)
+                pyramid->build(framebuffer.getFramebuffer(), width, height, viewProjection);
+            occludeAmbient();
+            if (transparency == Transparency::WeightedBlended) {
+                oit.begin(framebuffer.getFramebuffer(), width, height);
+                accumulate.use();
+                model.Draw(MeshBatch::Pass::Transparent);
+                oit.composite(framebuffer.getFramebuffer());
+                shader.use();
+            }
+            else {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                glDepthMask(GL_FALSE);
+                model.Draw(MeshBatch::Pass::Transparent);
+                glDepthMask(GL_TRUE);
+                glDisable(GL_BLEND);
+            }
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+        auto submitted = std::chrono::steady_clock::now();
+        glFlush();
+
+        if (frame >= latency) {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(queries[frame - latency], GL_QUERY_RESULT, &nanoseconds);
+        }
+        auto end = std::chrono::steady_clock::now();
+        result.cpuFrameMs.push_back(std::chrono::duration<double, std::milli>(submitted - start).count());
+        result.frameMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    for (unsigned int frame = 0; frame < frames; frame++) {
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[frame], GL_QUERY_RESULT, &nanoseconds);
+        result.gpuFrameMs.push_back(nanoseconds / 1e6);
+    }
+    glDeleteQueries(frames, queries.data());
+    if (pyramid)
+        result.occludedFraction = occluded / frames;
+    if (meshlets)
+        result.meshletsDrawnFraction = meshletsDrawn / frames;
+    result.peakRssMb = peakRssMb();
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int frames = 200, width = 1280, height = 800;
+    std::vector<unsigned int> triangles = { 1000, 10000, 100000, 1000000, 10000000, 50000000 }, parts;
+    std::vector<Transparency> transparencies = { Transparency::None };
+    std::vector<unsigned int> lightCounts = { 0 };
+    std::vector<bool> occlusions = { false };
+    std::vector<bool> meshletModes = { false };
+    std::vector<bool> ssaoModes = { false };
+    std::vector<std::string> meshes;
+    std::string dataFolder = "benchmark_data", outPath;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--frames") && hasValue) {
+            frames = std::max(1, atoi(argv[++i]));
+        }
+        else if (!strcmp(argv[i], "--size") && hasValue) {
+            sscanf(argv[++i], "%ux%u", &width, &height);
+        }
+        else if (!strcmp(argv[i], "--triangles") && hasValue) {
+            triangles = parseCounts(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--parts") && hasValue) {
+            parts = parseCounts(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--lights") && hasValue) {
+            // Zero is a valid count here, without lights
+            lightCounts.clear();
+            for (const char* list = argv[++i]; *list; ) {
+                char* end;
+                unsigned long count = strtoul(list, &end, 10);
+                if (end == list)
+                    break;
+                lightCounts.push_back((unsigned int)count);
+                list = *end == ',' ? end + 1 : end;
+            }
+        }
+        else if (!strcmp(argv[i], "--transparency") && hasValue) {
+            transparencies.clear();
+            std::string list = argv[++i];
+            for (size_t begin = 0; begin <= list.size(); ) {
+                size_t end = std::min(list.find(',', begin), list.size());
+                std::string mode = list.substr(begin, end - begin);
+                if (mode == "none")
+                    transparencies.push_back(Transparency::None);
+                else if (mode == "oit")
+                    transparencies.push_back(Transparency::WeightedBlended);
+                else if (mode == "sorted")
+                    transparencies.push_back(Transparency::Sorted);
+                begin = end + 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--occlusion") && hasValue) {
+            occlusions.clear();
+            std::string list = argv[++i];
+            for (size_t begin = 0; begin <= list.size(); ) {
+                size_t end = std::min(list.find(',', begin), list.size());
+                std::string mode = list.substr(begin, end - begin);
+                if (mode == "off" || mode == "on")
+                    occlusions.push_back(mode == "on");
+                begin = end + 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--meshlets") && hasValue) {
+            meshletModes.clear();
+            std::string list = argv[++i];
+            for (size_t begin = 0; begin <= list.size(); ) {
+                size_t end = std::min(list.find(',', begin), list.size());
+                std::string mode = list.substr(begin, end - begin);
+                if (mode == "off" || mode == "on")
+                    meshletModes.push_back(mode == "on");
+                begin = end + 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--ssao") && hasValue) {
+            ssaoModes.clear();
+            std::string list = argv[++i];
+            for (size_t begin = 0; begin <= list.size(); ) {
+                size_t end = std::min(list.find(',', begin), list.size());
+                std::string mode = list.substr(begin, end - begin);
+                if (mode == "off" || mode == "on")
+                    ssaoModes.push_back(mode == "on");
+                begin = end + 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--no-shader-cache")) {
+            ProgramCache::folder().clear();
+        }
+        else if (!strcmp(argv[i], "--no-meshlet-cache")) {
+            Meshlets::folder().clear();
+        }
+        else if (!strcmp(argv[i], "--mesh") && hasValue) {
+            meshes.push_back(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--data") && hasValue) {
+            dataFolder = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--out") && hasValue) {
+            outPath = argv[++i];
+        }
+        else {
+            printf("usage: %s [--frames N] [--size WxH] [--triangles 1000,10000,...] [--parts 1000,20000,...]\n"
+                "       [--transparency none,oit,sorted] [--lights 0,100,...] [--occlusion off,on] [--meshlets off,on]\n"
+                "       [--ssao off,on] [--no-shader-cache] [--no-meshlet-cache] [--mesh file]... [--data folder] [--out file.json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Reference meshes first, smallest to largest
+    std::error_code error;
+    std::filesystem::create_directories(dataFolder, error);
+    std::vector<std::string> paths;
+    for (unsigned int count : triangles) {
+        std::string path = (std::filesystem::path(dataFolder) / ("torus_" + std::to_string(count) + ".ply")).string();
+        if (!std::filesystem::exists(path) && !writeTorus(path, count)) {
+            fprintf(stderr, "could not write %s\n", path.c_str());
+            return 1;
+        }
+        paths.push_back(path);
+    }
+    for (unsigned int count : parts) {
+        std::string path = (std::filesystem::path(dataFolder) / ("parts_" + std::to_string(count) + ".obj")).string();
+        if (!std::filesystem::exists(path) && !writeParts(path, count)) {
+            fprintf(stderr, "could not write %s\n", path.c_str());
+            return 1;
+        }
+        paths.push_back(path);
+    }
+    paths.insert(paths.end(), meshes.begin(), meshes.end());
+
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    if (!glfwInit()) {
+        fprintf(stderr, "GLFW null platform unavailable\n");
+        return 1;
+    }
+    GLFWwindow* context = HeadlessRenderer::createContext();
+    if (!context) {
+        fprintf(stderr, "could not create an EGL or OSMesa context\n");
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(context);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        fprintf(stderr, "Failed to initialize GLAD\n");
+        glfwTerminate();
+        return 1;
+    }
+
+    std::vector<Result> results;
+    std::string renderer = (const char*)glGetString(GL_RENDERER), version = (const char*)glGetString(GL_VERSION);
+    double shaderMs = 0.0;
+    const char* shaderCache = ProgramCache::isEnabled() ? "miss" : "off";
+    {
+        // Viewer state: shaders, default material and lighting, depth test and culling
+        auto shadersStart = std::chrono::steady_clock::now();
+        ShaderVariants variants(
+            "shaders/vertex.glsl",
+            "shaders/fragment.glsl",
+            "shaders/geometry.glsl"
+        );
+        Shader& shader = variants.select(0);
+        WeightedBlendedOIT oit;
+        glFinish();
+        shaderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shadersStart).count();
+        if (shader.is_from_cache())
+            shaderCache = "hit";
+        fprintf(stderr, "shaders %.1f ms, program cache %s\n", shaderMs, shaderCache);
+        Camera defaultCamera;
+        Menu menu(defaultCamera);
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_CULL_FACE);
+        glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+        OffscreenFramebuffer framebuffer(width, height);
+        ClusteredLights lights;
+        AmbientOcclusion ambientOcclusion;
+
+        for (const std::string& path : paths) {
+            for (Transparency transparency : transparencies) {
+                for (unsigned int numLights : lightCounts) {
+                    for (bool occlusion : occlusions) {
+                        for (bool meshlets : meshletModes) {
+                            for (bool ssao : ssaoModes) {
+                                Result result = benchmark(path, frames, width, height, variants, menu, framebuffer, transparency, oit,
+                                    numLights, lights, occlusion, meshlets, ssao ? &ambientOcclusion : nullptr);
+                                fprintf(stderr, "%-24s %10u tris  import %9.1f ms  upload %8.1f ms  cpu %7.3f ms  gpu %8.3f ms  rss %8.1f MB\n",
+                                    result.name.c_str(), result.triangles, result.importMs, result.uploadMs, percentile(result.cpuFrameMs, 0.5),
+                                    percentile(result.gpuFrameMs, 0.5), result.peakRssMb);
+                                if (occlusion)
+                                    fprintf(stderr, "%-24s %.1f%% of parts occluded\n", "", result.occludedFraction * 100.0);
+                                if (meshlets)
+                                    fprintf(stderr, "%-24s %.1f%% of meshlets drawn\n", "", result.meshletsDrawnFraction * 100.0);
+                                results.push_back(result);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    glfwDestroyWindow(context);
+    glfwTerminate();
+
+    FILE* out = outPath.empty() ? stdout : fopen(outPath.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "could not write %s\n", outPath.c_str());
+        return 1;
+    }
+    fprintf(out, "{\n  \"renderer\": \"");
+    escape(out, renderer);
+    fprintf(out, "\",\n  \"version\": \"");
+    escape(out, version);
+    fprintf(out, "\",\n  \"shader_ms\": %.3f,\n  \"shader_cache\": \"%s\",\n  \"frames\": %u,\n  \"width\": %u,\n  \"height\": %u,\n  \"results\": [\n",
+        shaderMs, shaderCache, frames, width, height);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        fprintf(out, "    {\n      \"name\": \"");
+        escape(out, result.name);
+        fprintf(out, "\",\n      \"triangles\": %u,\n      \"vertices\": %u,\n", result.triangles, result.vertices);
+        fprintf(out, "      \"import_ms\": %.3f,\n      \"upload_ms\": %.3f,\n", result.importMs, result.uploadMs);
+        writeStats(out, "cpu_frame_ms", result.cpuFrameMs);
+        writeStats(out, "gpu_frame_ms", result.gpuFrameMs);
+        writeStats(out, "frame_ms", result.frameMs);
+        if (result.occludedFraction >= 0.0)
+            fprintf(out, "      \"occluded_fraction\": %.4f,\n", result.occludedFraction);
+        if (result.meshletsDrawnFraction >= 0.0)
+            fprintf(out, "      \"meshlets_drawn_fraction\": %.4f,\n", result.meshletsDrawnFraction);
+        fprintf(out, "      \"peak_rss_mb\": %.1f\n    }%s\n", result.peakRssMb, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <cstdlib>
+#include <filesystem>
+
+// Per-user folder for data the viewer can rebuild, such as program binaries
+// and meshlets: %LOCALAPPDATA%\3D Viewer on Windows, $XDG_CACHE_HOME/3d-viewer
+// or ~/.cache/3d-viewer elsewhere. Without these variables the folder is
+// relative to the working directory
+inline std::string cacheFolder(const std::string& name) {
+    std::filesystem::path base;
+#ifdef _WIN32
+    if (const char* local = std::getenv("LOCALAPPDATA"))
+        base = std::filesystem::path(local) / "3D Viewer";
+#else
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    if (xdg && *xdg)
+        base = std::filesystem::path(xdg) / "3d-viewer";
+    else if (home && *home)
+        base = std::filesystem::path(home) / ".cache" / "3d-viewer";
+#endif
+    return (base / name).string();
+}
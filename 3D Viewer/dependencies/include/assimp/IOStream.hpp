@@ -48,6 +48,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define AI_IOSTREAM_H_INC
 
 #include "types.h"
+#include <stdint.h>
 
 #ifndef __cplusplus
 #   error This header requires C++ to be used. aiFileIO.h is the \
@@ -121,6 +122,17 @@ public:
      *  See fflush() for more details.
      */
     virtual void Flush() = 0;
+
+    // -------------------------------------------------------------------
+    /** @brief Get a direct, read-only view of the whole file
+     *
+     *  Streams that are backed by memory (e.g. a memory-mapped file or a
+     *  caller-supplied buffer) return a pointer to FileSize() bytes so that
+     *  importers can parse in place instead of copying through Read().
+     *  The view stays valid until the stream is closed. The default
+     *  implementation returns NULL, callers must then fall back to Read().
+     */
+    virtual const uint8_t* GetMappedData() const;
 }; //! class IOStream
 
 // ----------------------------------------------------------------------------------
@@ -134,6 +146,12 @@ inline IOStream::~IOStream()
 {
     // empty
 }
+
+// ----------------------------------------------------------------------------------
+inline const uint8_t* IOStream::GetMappedData() const
+{
+    return NULL;
+}
 // ----------------------------------------------------------------------------------
 } //!namespace Assimp
 
@@ -0,0 +1,165 @@
+/*
+Open Asset Import Library (assimp)
+----------------------------------------------------------------------
+
+Copyright (c) 2006-2017, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the
+following conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+----------------------------------------------------------------------
+*/
+
+/** @file Tracer.h
+ *  @brief Low-overhead tracing of nested regions, exported as Chrome trace files
+ */
+#ifndef AI_TRACER_H_INC
+#define AI_TRACER_H_INC
+
+#include <assimp/defs.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Assimp    {
+namespace Profiling {
+
+// ----------------------------------------------------------------------------------
+//! @class  TraceName
+//! @brief  Region name, interned once into the process-wide name table.
+//!
+//! Declare it static next to the region (see ASSIMP_TRACE_SCOPE) so the
+//! lookup happens on first use only and events just carry the integer id.
+//! The name must be a string literal or otherwise outlive the tracer.
+class ASSIMP_API TraceName
+{
+public:
+    explicit TraceName(const char* pName);
+
+    unsigned int GetId() const {
+        return mId;
+    }
+
+private:
+    unsigned int mId;
+};
+
+// ----------------------------------------------------------------------------------
+/** A recorded begin or end of a region, as returned by Tracer::Collect() */
+struct TraceEvent
+{
+    //! Nanoseconds since the tracer was first used
+    uint64_t mTime;
+    //! Id of the TraceName, see Tracer::GetName()
+    unsigned int mName;
+    //! Small per-process thread number, 1 is the first thread that traced
+    unsigned int mThread;
+    //! true for the start of a region, false for its end
+    bool mBegin;
+};
+
+// ----------------------------------------------------------------------------------
+//! @class  Tracer
+//! @brief  Process-wide tracer writing into per-thread ring buffers.
+//!
+//! Every thread records into its own fixed-size ring, so Begin()/End() take no
+//! lock, allocate nothing and format nothing; once a ring is full the oldest
+//! events are overwritten. Collect() may run while other threads keep
+//! tracing, events overwritten during the copy are dropped.
+class ASSIMP_API Tracer
+{
+public:
+    /** Events per thread before the ring wraps around */
+    static const unsigned int RingSize = 1u << 16;
+
+    /** Turn recording on or off, it is off by default. Regions already
+     *  open when tracing is turned off still record their end. */
+    static void SetEnabled(bool pEnabled);
+    static bool IsEnabled();
+
+    static void Begin(unsigned int pName);
+    static void End(unsigned int pName);
+
+    /** Name the calling thread in exported traces */
+    static void SetThreadName(const char* pName);
+
+    /** Copy all events still held in the rings, per thread in recording order */
+    static void Collect(std::vector<TraceEvent>& pEvents);
+
+    /** Forget everything recorded so far */
+    static void Clear();
+
+    /** Interned name for an id, NULL if unknown */
+    static const char* GetName(unsigned int pName);
+
+    /** Write everything recorded so far in the Chrome trace event format,
+     *  viewable in chrome://tracing, Perfetto or Speedscope.
+     *  @return false if the file could not be written */
+    static bool WriteChromeTrace(const char* pFile);
+};
+
+// ----------------------------------------------------------------------------------
+/** Records a region for the lifetime of the object, if tracing is enabled */
+class TraceScope
+{
+public:
+    explicit TraceScope(const TraceName& pName)
+    : mName(Tracer::IsEnabled() ? pName.GetId() : 0) {
+        if (mName) {
+            Tracer::Begin(mName);
+        }
+    }
+
+    ~TraceScope() {
+        if (mName) {
+            Tracer::End(mName);
+        }
+    }
+
+private:
+    TraceScope(const TraceScope&);
+    TraceScope& operator=(const TraceScope&);
+
+    unsigned int mName;
+};
+
+} // ! namespace Profiling
+} // ! namespace Assimp
+
+#define AI_TRACE_CONCAT_IMPL(a, b) a##b
+#define AI_TRACE_CONCAT(a, b) AI_TRACE_CONCAT_IMPL(a, b)
+
+/** Traces the rest of the enclosing block as region @p name (a string literal) */
+#define ASSIMP_TRACE_SCOPE(name) \
+    static const ::Assimp::Profiling::TraceName AI_TRACE_CONCAT(aiTraceName_, __LINE__)(name); \
+    ::Assimp::Profiling::TraceScope AI_TRACE_CONCAT(aiTraceScope_, __LINE__)(AI_TRACE_CONCAT(aiTraceName_, __LINE__))
+
+#endif // AI_TRACER_H_INC
@@ -52,11 +52,20 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/importerdesc.h>
+#include <assimp/Tracer.h>
 #include <ios>
 #include <list>
+#include <deque>
 #include <memory>
 #include <sstream>
 #include <cctype>
+#include <algorithm>
+
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+#   include <thread>
+#   include <mutex>
+#   include <atomic>
+#endif
 
 using namespace Assimp;
 
@@ -64,6 +73,8 @@ using namespace Assimp;
 // Constructor to be privately used by Importer
 BaseImporter::BaseImporter()
 : m_progress()
+, m_arena()
+, m_trustedInput( false )
 {
     // nothing to do here
 }
@@ -81,6 +92,8 @@ aiScene* BaseImporter::ReadFile(const Importer* pImp, const std::string& pFile,
 {
     m_progress = pImp->GetProgressHandler();
     ai_assert(m_progress);
+    m_arena = pImp->Pimpl()->mArena;
+    m_trustedInput = pImp->GetPropertyBool(AI_CONFIG_IMPORT_TRUSTED_INPUT, false);
 
     // Gather configuration properties for this run
     SetupProperties( pImp );
@@ -465,11 +478,15 @@ struct Assimp::BatchData {
     : pIOSystem( pIO )
     , pImporter( nullptr )
     , next_id(0xffff)
-    , validate( validate ) {
+    , validate( validate )
+    , numThreads( 1 ) {
         ai_assert( NULL != pIO );
         
         pImporter = new Importer();
         pImporter->SetIOHandler( pIO );
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+        cancel = false;
+#endif
     }
 
     ~BatchData() {
@@ -494,10 +511,114 @@ struct Assimp::BatchData {
 
     // Validation enabled state
     bool validate;
+
+    // Number of workers, 0 for one per core
+    unsigned int numThreads;
+
+    // Ids of finished requests not yet reported by PollImport()
+    std::deque<unsigned int> finished;
+
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+    // Next request to be picked up by a worker
+    std::list<LoadRequest>::iterator nextRequest;
+
+    // Running workers, each with its own importer
+    std::vector<std::thread> workers;
+
+    // Guards requests, nextRequest and finished while workers are running
+    std::mutex mutex;
+
+    // Set by ~BatchLoader, workers finish their current request but take no new one
+    std::atomic<bool> cancel;
+
+    void Work();
+    void Wait();
+#endif
 };
 
 typedef std::list<LoadRequest>::iterator LoadReqIt;
 
+// ------------------------------------------------------------------------------------------------
+// Runs a single request on the given importer and hands back the scene
+static aiScene* LoadSingleRequest( Importer* pImporter, const LoadRequest& req, bool validate )
+{
+    // force validation in debug builds
+    unsigned int pp = req.flags;
+    if ( validate ) {
+        pp |= aiProcess_ValidateDataStructure;
+    }
+
+    // setup config properties if necessary
+    ImporterPimpl* pimpl = pImporter->Pimpl();
+    pimpl->mFloatProperties  = req.map.floats;
+    pimpl->mIntProperties    = req.map.ints;
+    pimpl->mStringProperties = req.map.strings;
+    pimpl->mMatrixProperties = req.map.matrices;
+
+    if (!DefaultLogger::isNullLogger())
+    {
+        DefaultLogger::get()->info("%%% BEGIN EXTERNAL FILE %%%");
+        DefaultLogger::get()->info("File: " + req.file);
+    }
+    pImporter->ReadFile(req.file,pp);
+    aiScene* scene = pImporter->GetOrphanedScene();
+
+    DefaultLogger::get()->info("%%% END EXTERNAL FILE %%%");
+    return scene;
+}
+
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+// ------------------------------------------------------------------------------------------------
+// Worker thread: takes requests off the queue until none are left
+void BatchData::Work()
+{
+    Profiling::Tracer::SetThreadName( "BatchLoader" );
+
+    // the IO system is shared, the importer and its post-processing state are not
+    Importer importer;
+    importer.SetIOHandler( pIOSystem );
+
+    for (;;) {
+        LoadReqIt it;
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            while ( nextRequest != requests.end() && (*nextRequest).loaded ) {
+                ++nextRequest;
+            }
+            if ( cancel || nextRequest == requests.end() ) {
+                break;
+            }
+            it = nextRequest++;
+        }
+
+        aiScene* scene = NULL;
+        try {
+            scene = LoadSingleRequest( &importer, *it, validate );
+        }
+        catch ( const std::exception& e ) {
+            DefaultLogger::get()->error( "Batch import of " + (*it).file + " failed: " + e.what() );
+        }
+
+        std::lock_guard<std::mutex> lock( mutex );
+        (*it).scene = scene;
+        (*it).loaded = true;
+        finished.push_back( (*it).id );
+    }
+
+    importer.SetIOHandler( NULL ); /* get pointer back into our possession */
+}
+
+// ------------------------------------------------------------------------------------------------
+// Blocks until all workers are done
+void BatchData::Wait()
+{
+    for ( std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it ) {
+        (*it).join();
+    }
+    workers.clear();
+}
+#endif
+
 // ------------------------------------------------------------------------------------------------
 BatchLoader::BatchLoader(IOSystem* pIO, bool validate )
 {
@@ -509,6 +630,13 @@ BatchLoader::BatchLoader(IOSystem* pIO, bool validate )
 // ------------------------------------------------------------------------------------------------
 BatchLoader::~BatchLoader()
 {
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+    // don't start the requests still queued, then wait for the ones in progress,
+    // workers must not touch the request list while we tear it down
+    m_data->cancel = true;
+    m_data->Wait();
+#endif
+
     // delete all scenes what have not been polled by the user
     for ( LoadReqIt it = m_data->requests.begin();it != m_data->requests.end(); ++it) {
         delete (*it).scene;
@@ -526,11 +654,24 @@ bool BatchLoader::getValidation() const {
     return m_data->validate;
 }
 
+// ------------------------------------------------------------------------------------------------
+void BatchLoader::setNumThreads( unsigned int numThreads ) {
+    m_data->numThreads = numThreads;
+}
+
+// ------------------------------------------------------------------------------------------------
+unsigned int BatchLoader::getNumThreads() const {
+    return m_data->numThreads;
+}
+
 // ------------------------------------------------------------------------------------------------
 unsigned int BatchLoader::AddLoadRequest(const std::string& file,
     unsigned int steps /*= 0*/, const PropertyMap* map /*= NULL*/)
 {
     ai_assert(!file.empty());
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+    ai_assert(m_data->workers.empty());
+#endif
 
     // check whether we have this loading request already
     for ( LoadReqIt it = m_data->requests.begin();it != m_data->requests.end(); ++it)  {
@@ -558,6 +699,9 @@ unsigned int BatchLoader::AddLoadRequest(const std::string& file,
 // ------------------------------------------------------------------------------------------------
 aiScene* BatchLoader::GetImport( unsigned int which )
 {
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+    std::lock_guard<std::mutex> lock( m_data->mutex );
+#endif
     for ( LoadReqIt it = m_data->requests.begin();it != m_data->requests.end(); ++it) {
         if ((*it).id == which && (*it).loaded)  {
             aiScene* sc = (*it).scene;
@@ -571,32 +715,75 @@ aiScene* BatchLoader::GetImport( unsigned int which )
 }
 
 // ------------------------------------------------------------------------------------------------
-void BatchLoader::LoadAll()
+bool BatchLoader::PollImport( unsigned int& which )
 {
-    // no threaded implementation for the moment
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+    std::lock_guard<std::mutex> lock( m_data->mutex );
+#endif
+    if ( m_data->finished.empty() ) {
+        return false;
+    }
+    which = m_data->finished.front();
+    m_data->finished.pop_front();
+    return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+unsigned int BatchLoader::GetNumPending() const
+{
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+    std::lock_guard<std::mutex> lock( m_data->mutex );
+#endif
+    unsigned int pending = 0;
     for ( LoadReqIt it = m_data->requests.begin();it != m_data->requests.end(); ++it) {
-        // force validation in debug builds
-        unsigned int pp = (*it).flags;
-        if ( m_data->validate ) {
-            pp |= aiProcess_ValidateDataStructure;
+        if ( !(*it).loaded ) {
+            ++pending;
         }
+    }
+    return pending;
+}
 
-        // setup config properties if necessary
-        ImporterPimpl* pimpl = m_data->pImporter->Pimpl();
-        pimpl->mFloatProperties  = (*it).map.floats;
-        pimpl->mIntProperties    = (*it).map.ints;
-        pimpl->mStringProperties = (*it).map.strings;
-        pimpl->mMatrixProperties = (*it).map.matrices;
+// ------------------------------------------------------------------------------------------------
+void BatchLoader::LoadAsync()
+{
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+    if ( !m_data->workers.empty() ) {
+        return;
+    }
 
-        if (!DefaultLogger::isNullLogger())
-        {
-            DefaultLogger::get()->info("%%% BEGIN EXTERNAL FILE %%%");
-            DefaultLogger::get()->info("File: " + (*it).file);
+    m_data->nextRequest = m_data->requests.begin();
+    const unsigned int pending = GetNumPending();
+    unsigned int numThreads = m_data->numThreads;
+    if ( 0 == numThreads ) {
+        numThreads = std::max( 1u, std::thread::hardware_concurrency() );
+    }
+    numThreads = std::min( numThreads, pending );
+
+    for ( unsigned int i = 0; i < numThreads; ++i ) {
+        m_data->workers.push_back( std::thread( &BatchData::Work, m_data ) );
+    }
+#else
+    LoadAll();
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+void BatchLoader::LoadAll()
+{
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+    if ( 1 != m_data->numThreads || !m_data->workers.empty() ) {
+        LoadAsync();
+        m_data->Wait();
+        return;
+    }
+#endif
+
+    for ( LoadReqIt it = m_data->requests.begin();it != m_data->requests.end(); ++it) {
+        if ( (*it).loaded ) {
+            continue;
         }
-        m_data->pImporter->ReadFile((*it).file,pp);
-        (*it).scene = m_data->pImporter->GetOrphanedScene();
+        (*it).scene = LoadSingleRequest( m_data->pImporter, *it, m_data->validate );
         (*it).loaded = true;
-
-        DefaultLogger::get()->info("%%% END EXTERNAL FILE %%%");
+        m_data->finished.push_back( (*it).id );
     }
 }
@@ -60,6 +60,7 @@ class IOSystem;
 class BaseProcess;
 class SharedPostProcessInfo;
 class IOStream;
+class SceneArena;
 
 // utility to do char4 to uint32 in a portable manner
 #define AI_MAKE_MAGIC(string) ((uint32_t)((string[0] << 24) + \
@@ -352,6 +353,11 @@ protected:
     std::string m_ErrorText;
     /// Currently set progress handler.
     ProgressHandler* m_progress;
+    /// Arena for face indices of the current import, NULL if disabled.
+    SceneArena* m_arena;
+    /// Only positions, normals and faces are needed, see
+    /// #AI_CONFIG_IMPORT_TRUSTED_INPUT.
+    bool m_trustedInput;
 };
 
 
@@ -58,7 +58,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "D3MFOpcPackage.h"
 //#include <contrib/unzip/unzip.h>
-#include <unzip/unzip.h>
+#include <minizip/unzip.h>
 #include "irrXMLWrapper.h"
 #include "3MFXmlTags.h"
 
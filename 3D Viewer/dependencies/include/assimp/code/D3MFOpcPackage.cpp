@@ -55,7 +55,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <map>
 #include <algorithm>
 #include <cassert>
-#include <contrib/unzip/unzip.h>
+#include <minizip/unzip.h>
+//#include <contrib/unzip/unzip.h>
 #include "3MFXmlTags.h"
 
 namespace Assimp {
@@ -63,6 +63,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #   include <mutex>
 
 std::mutex loggerMutex;
+
+// Guards the streams and the last message, batch imports log from several threads
+static std::mutex streamMutex;
 #endif
 
 namespace Assimp    {
@@ -307,6 +310,10 @@ bool DefaultLogger::attachStream( LogStream *pStream, unsigned int severity )
         severity = Logger::Info | Logger::Err | Logger::Warn | Logger::Debugging;
     }
 
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+    std::lock_guard<std::mutex> lock(streamMutex);
+#endif
+
     for ( StreamIt it = m_StreamArray.begin();
         it != m_StreamArray.end();
         ++it )
@@ -334,6 +341,10 @@ bool DefaultLogger::detatchStream( LogStream *pStream, unsigned int severity )
         severity = SeverityAll;
     }
 
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+    std::lock_guard<std::mutex> lock(streamMutex);
+#endif
+
     for ( StreamIt it = m_StreamArray.begin();
         it != m_StreamArray.end();
         ++it )
@@ -381,6 +392,10 @@ void DefaultLogger::WriteToStreams(const char *message, ErrorSeverity ErrorSev )
 {
     ai_assert(NULL != message);
 
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+    std::lock_guard<std::mutex> lock(streamMutex);
+#endif
+
     // Check whether this is a repeated message
     if (! ::strncmp( message,lastMsg, lastLen-1))
     {
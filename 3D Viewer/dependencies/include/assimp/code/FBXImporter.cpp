@@ -153,11 +153,22 @@ void FBXImporter::InternReadFile( const std::string& pFile,
     // then becomes very large, too. Assimp doesn't support
     // streaming for its output data structures so the net win with
     // streaming input data would be very low.
+    // Binary files are tokenized in place if the stream is mapped, the
+    // tokens then point straight into the mapping which outlives them.
+    static const char binaryMagic[] = "Kaydara FBX Binary";
+    const size_t fileSize = stream->FileSize();
+    const char* mapped = reinterpret_cast<const char*>(stream->GetMappedData());
+    if (mapped && (fileSize < sizeof(binaryMagic) - 1 || strncmp(mapped,binaryMagic,sizeof(binaryMagic) - 1))) {
+        mapped = NULL;
+    }
+
     std::vector<char> contents;
-    contents.resize(stream->FileSize()+1);
-    stream->Read( &*contents.begin(), 1, contents.size()-1 );
-    contents[ contents.size() - 1 ] = 0;
-    const char* const begin = &*contents.begin();
+    if (!mapped) {
+        contents.resize(fileSize+1);
+        stream->Read( &*contents.begin(), 1, contents.size()-1 );
+        contents[ contents.size() - 1 ] = 0;
+    }
+    const char* const begin = mapped ? mapped : &*contents.begin();
 
     // broadphase tokenizing pass in which we identify the core
     // syntax elements of FBX (brackets, commas, key:value mappings)
@@ -165,9 +176,9 @@ void FBXImporter::InternReadFile( const std::string& pFile,
     try {
 
         bool is_binary = false;
-        if (!strncmp(begin,"Kaydara FBX Binary",18)) {
+        if (!strncmp(begin,binaryMagic,sizeof(binaryMagic) - 1)) {
             is_binary = true;
-            TokenizeBinary(tokens,begin,static_cast<unsigned int>(contents.size()));
+            TokenizeBinary(tokens,begin,static_cast<unsigned int>(mapped ? fileSize : contents.size()));
         }
         else {
             Tokenize(tokens,begin);
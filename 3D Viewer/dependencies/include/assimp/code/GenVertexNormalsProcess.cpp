@@ -51,6 +51,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ProcessHelper.h"
 #include "Exceptional.h"
 #include "qnan.h"
+#include <assimp/Tracer.h>
 
 using namespace Assimp;
 
@@ -87,6 +88,7 @@ void GenVertexNormalsProcess::SetupProperties(const Importer* pImp)
 // Executes the post processing step on the given imported data.
 void GenVertexNormalsProcess::Execute( aiScene* pScene)
 {
+    ASSIMP_TRACE_SCOPE("GenVertexNormals");
     DefaultLogger::get()->debug("GenVertexNormalsProcess begin");
 
     if (pScene->mFlags & AI_SCENE_FLAGS_NON_VERBOSE_FORMAT)
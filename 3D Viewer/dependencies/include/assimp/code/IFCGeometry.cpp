@@ -51,7 +51,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <poly2tri/poly2tri.h>
 //#include "../contrib/poly2tri/poly2tri/poly2tri.h"
-#include <clipper/clipper.hpp>
+#include <polyclipping/clipper.hpp>
 //#include "../contrib/clipper/clipper.hpp"
 #include <memory>
 
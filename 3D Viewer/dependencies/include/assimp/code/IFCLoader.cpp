@@ -51,7 +51,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <tuple>
 
 #ifndef ASSIMP_BUILD_NO_COMPRESSED_IFC
-#include <unzip/unzip.h>
+#include <minizip/unzip.h>
 //#   include <contrib/unzip/unzip.h>
 #endif
 
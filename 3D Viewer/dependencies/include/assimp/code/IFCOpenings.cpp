@@ -51,7 +51,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <poly2tri/poly2tri.h>
 //#include "../contrib/poly2tri/poly2tri/poly2tri.h"
-#include <clipper/clipper.hpp>
+#include <polyclipping/clipper.hpp>
 //#include "../contrib/clipper/clipper.hpp"
 
 #include <iterator>
@@ -59,12 +59,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace Assimp {
     namespace IFC {
 
-        using ClipperLib::ulong64;
+        using ClipperLib::cInt;
         // XXX use full -+ range ...
-        const ClipperLib::long64 max_ulong64 = 1518500249; // clipper.cpp / hiRange var
+        const cInt max_ulong64 = 1518500249; // clipper.cpp / hiRange var
 
-        //#define to_int64(p)  (static_cast<ulong64>( std::max( 0., std::min( static_cast<IfcFloat>((p)), 1.) ) * max_ulong64 ))
-#define to_int64(p)  (static_cast<ulong64>(static_cast<IfcFloat>((p) ) * max_ulong64 ))
+        //#define to_int64(p)  (static_cast<cInt>( std::max( 0., std::min( static_cast<IfcFloat>((p)), 1.) ) * max_ulong64 ))
+#define to_int64(p)  (static_cast<cInt>(static_cast<IfcFloat>((p) ) * max_ulong64 ))
 #define from_int64(p) (static_cast<IfcFloat>((p)) / max_ulong64)
 #define one_vec (IfcVector2(static_cast<IfcFloat>(1.0),static_cast<IfcFloat>(1.0)))
 
@@ -224,7 +224,45 @@ bool IsDuplicateVertex(const IfcVector2& vv, const std::vector<IfcVector2>& temp
 }
 
 // ------------------------------------------------------------------------------------------------
-void ExtractVerticesFromClipper(const ClipperLib::Polygon& poly, std::vector<IfcVector2>& temp_contour,
+// Clipper 6 returns polygons with holes as a PolyTree instead of the ExPolygons of Clipper 4
+struct ExPolygon {
+    ClipperLib::Path outer;
+    ClipperLib::Paths holes;
+};
+typedef std::vector<ExPolygon> ExPolygons;
+
+// ------------------------------------------------------------------------------------------------
+void AddOuterPolygons(const ClipperLib::PolyNode& node, ExPolygons& out)
+{
+    for(int i = 0; i < node.ChildCount(); ++i) {
+        const ClipperLib::PolyNode& outer = *node.Childs[i];
+
+        ExPolygon ex;
+        ex.outer = outer.Contour;
+        for(int j = 0; j < outer.ChildCount(); ++j) {
+            ex.holes.push_back(outer.Childs[j]->Contour);
+        }
+        out.push_back(ex);
+
+        // islands inside the holes
+        for(int j = 0; j < outer.ChildCount(); ++j) {
+            AddOuterPolygons(*outer.Childs[j], out);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+void ExecuteClipper(ClipperLib::Clipper& clipper, ClipperLib::ClipType clipType, ExPolygons& out)
+{
+    ClipperLib::PolyTree tree;
+    clipper.Execute(clipType, tree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+
+    out.clear();
+    AddOuterPolygons(tree, out);
+}
+
+// ------------------------------------------------------------------------------------------------
+void ExtractVerticesFromClipper(const ClipperLib::Path& poly, std::vector<IfcVector2>& temp_contour,
     bool filter_duplicates = false)
 {
     temp_contour.clear();
@@ -240,7 +278,7 @@ void ExtractVerticesFromClipper(const ClipperLib::Polygon& poly, std::vector<Ifc
 }
 
 // ------------------------------------------------------------------------------------------------
-BoundingBox GetBoundingBox(const ClipperLib::Polygon& poly)
+BoundingBox GetBoundingBox(const ClipperLib::Path& poly)
 {
     IfcVector2 newbb_min, newbb_max;
     MinMaxChooser<IfcVector2>()(newbb_min, newbb_max);
@@ -386,12 +424,12 @@ void InsertWindowContours(const ContourVector& contours,
 // ------------------------------------------------------------------------------------------------
 void MergeWindowContours (const std::vector<IfcVector2>& a,
     const std::vector<IfcVector2>& b,
-    ClipperLib::ExPolygons& out)
+    ExPolygons& out)
 {
     out.clear();
 
     ClipperLib::Clipper clipper;
-    ClipperLib::Polygon clip;
+    ClipperLib::Path clip;
 
     for(const IfcVector2& pip : a) {
         clip.push_back(ClipperLib::IntPoint(  to_int64(pip.x), to_int64(pip.y) ));
@@ -401,7 +439,7 @@ void MergeWindowContours (const std::vector<IfcVector2>& a,
         std::reverse(clip.begin(), clip.end());
     }
 
-    clipper.AddPolygon(clip, ClipperLib::ptSubject);
+    clipper.AddPath(clip, ClipperLib::ptSubject, true);
     clip.clear();
 
     for(const IfcVector2& pip : b) {
@@ -412,20 +450,20 @@ void MergeWindowContours (const std::vector<IfcVector2>& a,
         std::reverse(clip.begin(), clip.end());
     }
 
-    clipper.AddPolygon(clip, ClipperLib::ptSubject);
-    clipper.Execute(ClipperLib::ctUnion, out,ClipperLib::pftNonZero,ClipperLib::pftNonZero);
+    clipper.AddPath(clip, ClipperLib::ptSubject, true);
+    ExecuteClipper(clipper, ClipperLib::ctUnion, out);
 }
 
 // ------------------------------------------------------------------------------------------------
 // Subtract a from b
 void MakeDisjunctWindowContours (const std::vector<IfcVector2>& a,
     const std::vector<IfcVector2>& b,
-    ClipperLib::ExPolygons& out)
+    ExPolygons& out)
 {
     out.clear();
 
     ClipperLib::Clipper clipper;
-    ClipperLib::Polygon clip;
+    ClipperLib::Path clip;
 
     for(const IfcVector2& pip : a) {
         clip.push_back(ClipperLib::IntPoint(  to_int64(pip.x), to_int64(pip.y) ));
@@ -435,7 +473,7 @@ void MakeDisjunctWindowContours (const std::vector<IfcVector2>& a,
         std::reverse(clip.begin(), clip.end());
     }
 
-    clipper.AddPolygon(clip, ClipperLib::ptClip);
+    clipper.AddPath(clip, ClipperLib::ptClip, true);
     clip.clear();
 
     for(const IfcVector2& pip : b) {
@@ -446,8 +484,8 @@ void MakeDisjunctWindowContours (const std::vector<IfcVector2>& a,
         std::reverse(clip.begin(), clip.end());
     }
 
-    clipper.AddPolygon(clip, ClipperLib::ptSubject);
-    clipper.Execute(ClipperLib::ctDifference, out,ClipperLib::pftNonZero,ClipperLib::pftNonZero);
+    clipper.AddPath(clip, ClipperLib::ptSubject, true);
+    ExecuteClipper(clipper, ClipperLib::ctDifference, out);
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -456,16 +494,16 @@ void CleanupWindowContour(ProjectedWindowContour& window)
     std::vector<IfcVector2> scratch;
     std::vector<IfcVector2>& contour = window.contour;
 
-    ClipperLib::Polygon subject;
+    ClipperLib::Path subject;
     ClipperLib::Clipper clipper;
-    ClipperLib::ExPolygons clipped;
+    ExPolygons clipped;
 
     for(const IfcVector2& pip : contour) {
         subject.push_back(ClipperLib::IntPoint(  to_int64(pip.x), to_int64(pip.y) ));
     }
 
-    clipper.AddPolygon(subject,ClipperLib::ptSubject);
-    clipper.Execute(ClipperLib::ctUnion,clipped,ClipperLib::pftNonZero,ClipperLib::pftNonZero);
+    clipper.AddPath(subject,ClipperLib::ptSubject, true);
+    ExecuteClipper(clipper, ClipperLib::ctUnion, clipped);
 
     // This should yield only one polygon or something went wrong
     if (clipped.size() != 1) {
@@ -494,9 +532,9 @@ void CleanupWindowContours(ContourVector& contours)
             CleanupWindowContour(window);
         }
     }
-    catch (const char* sx) {
+    catch (const ClipperLib::clipperException& e) {
         IFCImporter::LogError("error during polygon clipping, window shape may be wrong: (Clipper: "
-            + std::string(sx) + ")");
+            + std::string(e.what()) + ")");
     }
 }
 
@@ -512,11 +550,11 @@ void CleanupOuterContour(const std::vector<IfcVector2>& contour_flat, TempMesh&
     // Fix the outer contour using polyclipper
     try {
 
-        ClipperLib::Polygon subject;
+        ClipperLib::Path subject;
         ClipperLib::Clipper clipper;
-        ClipperLib::ExPolygons clipped;
+        ExPolygons clipped;
 
-        ClipperLib::Polygon clip;
+        ClipperLib::Path clip;
         clip.reserve(contour_flat.size());
         for(const IfcVector2& pip : contour_flat) {
             clip.push_back(ClipperLib::IntPoint(  to_int64(pip.x), to_int64(pip.y) ));
@@ -545,12 +583,12 @@ void CleanupOuterContour(const std::vector<IfcVector2>& contour_flat, TempMesh&
                     std::reverse(subject.begin(), subject.end());
                 }
 
-                clipper.AddPolygon(subject,ClipperLib::ptSubject);
-                clipper.AddPolygon(clip,ClipperLib::ptClip);
+                clipper.AddPath(subject,ClipperLib::ptSubject, true);
+                clipper.AddPath(clip,ClipperLib::ptClip, true);
 
-                clipper.Execute(ClipperLib::ctIntersection,clipped,ClipperLib::pftNonZero,ClipperLib::pftNonZero);
+                ExecuteClipper(clipper, ClipperLib::ctIntersection, clipped);
 
-                for(const ClipperLib::ExPolygon& ex : clipped) {
+                for(const ExPolygon& ex : clipped) {
                     iold.push_back(static_cast<unsigned int>(ex.outer.size()));
                     for(const ClipperLib::IntPoint& point : ex.outer) {
                         vold.push_back(IfcVector3(
@@ -566,9 +604,9 @@ void CleanupOuterContour(const std::vector<IfcVector2>& contour_flat, TempMesh&
             }
         }
     }
-    catch (const char* sx) {
+    catch (const ClipperLib::clipperException& e) {
         IFCImporter::LogError("Ifc: error during polygon clipping, wall contour line may be wrong: (Clipper: "
-            + std::string(sx) + ")");
+            + std::string(e.what()) + ")");
 
         return;
     }
@@ -1324,7 +1362,7 @@ bool GenerateOpenings(std::vector<TempOpening>& openings,
                 }
 
                 const std::vector<IfcVector2>& other = (*it).contour;
-                ClipperLib::ExPolygons poly;
+                ExPolygons poly;
 
                 // First check whether subtracting the old contour (to which ibb belongs)
                 // from the new contour (to which bb belongs) yields an updated bb which
@@ -1496,8 +1534,8 @@ bool TryAddOpenings_Poly2Tri(const std::vector<TempOpening>& openings,const std:
     // If this happens then the projection must have been wrong.
     ai_assert(vmax.Length());
 
-    ClipperLib::ExPolygons clipped;
-    ClipperLib::Polygons holes_union;
+    ExPolygons clipped;
+    ClipperLib::Paths holes_union;
 
 
     IfcVector3 wall_extrusion;
@@ -1541,7 +1579,7 @@ bool TryAddOpenings_Poly2Tri(const std::vector<TempOpening>& openings,const std:
                 contour.push_back(IfcVector2(vv.x,vv.y));
             }
 
-            ClipperLib::Polygon hole;
+            ClipperLib::Path hole;
             for(IfcVector2& pip : contour) {
                 pip.x  = (pip.x - vmin.x) / vmax.x;
                 pip.y  = (pip.y - vmin.y) / vmax.y;
@@ -1554,13 +1592,13 @@ bool TryAddOpenings_Poly2Tri(const std::vector<TempOpening>& openings,const std:
             //  assert(ClipperLib::Orientation(hole));
             }
 
-            /*ClipperLib::Polygons pol_temp(1), pol_temp2(1);
+            /*ClipperLib::Paths pol_temp(1), pol_temp2(1);
             pol_temp[0] = hole;
 
             ClipperLib::OffsetPolygons(pol_temp,pol_temp2,5.0);
             hole = pol_temp2[0];*/
 
-            clipper_holes.AddPolygon(hole,ClipperLib::ptSubject);
+            clipper_holes.AddPath(hole,ClipperLib::ptSubject, true);
         }
 
         clipper_holes.Execute(ClipperLib::ctUnion,holes_union,
@@ -1574,7 +1612,7 @@ bool TryAddOpenings_Poly2Tri(const std::vector<TempOpening>& openings,const std:
         // Now that we have the big union of all holes, subtract it from the outer contour
         // to obtain the final polygon to feed into the triangulator.
         {
-            ClipperLib::Polygon poly;
+            ClipperLib::Path poly;
             for(IfcVector2& pip : contour_flat) {
                 pip.x  = (pip.x - vmin.x) / vmax.x;
                 pip.y  = (pip.y - vmin.y) / vmax.y;
@@ -1586,18 +1624,16 @@ bool TryAddOpenings_Poly2Tri(const std::vector<TempOpening>& openings,const std:
                 std::reverse(poly.begin(), poly.end());
             }
             clipper_holes.Clear();
-            clipper_holes.AddPolygon(poly,ClipperLib::ptSubject);
+            clipper_holes.AddPath(poly,ClipperLib::ptSubject, true);
 
-            clipper_holes.AddPolygons(holes_union,ClipperLib::ptClip);
-            clipper_holes.Execute(ClipperLib::ctDifference,clipped,
-                ClipperLib::pftNonZero,
-                ClipperLib::pftNonZero);
+            clipper_holes.AddPaths(holes_union,ClipperLib::ptClip, true);
+            ExecuteClipper(clipper_holes, ClipperLib::ctDifference, clipped);
         }
 
     }
-    catch (const char* sx) {
+    catch (const ClipperLib::clipperException& e) {
         IFCImporter::LogError("Ifc: error during polygon clipping, skipping openings for this face: (Clipper: "
-            + std::string(sx) + ")");
+            + std::string(e.what()) + ")");
 
         return false;
     }
@@ -1609,7 +1645,7 @@ bool TryAddOpenings_Poly2Tri(const std::vector<TempOpening>& openings,const std:
     old_vertcnt.swap(curmesh.vertcnt);
 
     std::vector< std::vector<p2t::Point*> > contours;
-    for(ClipperLib::ExPolygon& clip : clipped) {
+    for(ExPolygon& clip : clipped) {
 
         contours.clear();
 
@@ -1635,7 +1671,7 @@ bool TryAddOpenings_Poly2Tri(const std::vector<TempOpening>& openings,const std:
 
 
         // Build the poly2tri inner contours for all holes we got from ClipperLib
-        for(ClipperLib::Polygon& opening : clip.holes) {
+        for(ClipperLib::Path& opening : clip.holes) {
 
             contours.push_back(std::vector<p2t::Point*>());
             std::vector<p2t::Point*>& contour = contours.back();
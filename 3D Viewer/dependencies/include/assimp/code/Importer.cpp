@@ -72,23 +72,22 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ProcessHelper.h"
 #include "ScenePreprocessor.h"
 #include "ScenePrivate.h"
+#include "SceneArena.h"
 #include "MemoryIOWrapper.h"
-#include "Profiler.h"
 #include "TinyFormatter.h"
 #include "Exceptional.h"
-#include "Profiler.h"
 #include <set>
 #include <memory>
 #include <cctype>
 
 #include <assimp/DefaultIOStream.h>
 #include <assimp/DefaultIOSystem.h>
+#include <assimp/Tracer.h>
 
 #ifndef ASSIMP_BUILD_NO_VALIDATEDS_PROCESS
 #   include "ValidateDataStructure.h"
 #endif
 
-using namespace Assimp::Profiling;
 using namespace Assimp::Formatter;
 
 namespace Assimp {
@@ -152,6 +151,7 @@ Importer::Importer()
 
     pimpl->mScene = NULL;
     pimpl->mErrorString = "";
+    pimpl->mArena = NULL;
 
     // Allocate a default IO handler
     pimpl->mIOHandler = new DefaultIOSystem;
@@ -190,7 +190,8 @@ Importer::~Importer()
     delete pimpl->mProgressHandler;
 
     // Kill imported scene. Destructors should do that recursivly
-    delete pimpl->mScene;
+    FreeScene();
+    delete pimpl->mArena;
 
     // Delete shared post-processing data
     delete pimpl->mPPShared;
@@ -397,7 +398,14 @@ bool _ValidateFlags(unsigned int pFlags)
 void Importer::FreeScene( )
 {
     ASSIMP_BEGIN_EXCEPTION_REGION();
-    delete pimpl->mScene;
+    {
+        // Faces skip their arena indices, the arena frees them in one go
+        ArenaScope arenaScope(pimpl->mArena);
+        delete pimpl->mScene;
+    }
+    if (pimpl->mArena) {
+        pimpl->mArena->Release();
+    }
     pimpl->mScene = NULL;
 
     pimpl->mErrorString = "";
@@ -433,6 +441,11 @@ aiScene* Importer::GetOrphanedScene()
     aiScene* s = pimpl->mScene;
 
     ASSIMP_BEGIN_EXCEPTION_REGION();
+    if (s && pimpl->mArena) {
+        // The scene keeps its arena alive; a new one is created on the next import
+        ScenePriv(s)->mArena = pimpl->mArena;
+        pimpl->mArena = NULL;
+    }
     pimpl->mScene = NULL;
 
     pimpl->mErrorString = ""; /* reset error string */
@@ -612,10 +625,31 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
             return NULL;
         }
 
-        std::unique_ptr<Profiler> profiler(GetPropertyInteger(AI_CONFIG_GLOB_MEASURE_TIME,0)?new Profiler():NULL);
-        if (profiler) {
-            profiler->BeginRegion("total");
+        if (GetPropertyInteger(AI_CONFIG_GLOB_MEASURE_TIME,0)) {
+            Profiling::Tracer::SetEnabled(true);
         }
+        ASSIMP_TRACE_SCOPE("ReadFile");
+
+        // Trusted input skips the full validation walk, even if requested
+        const bool trustedInput = GetPropertyBool(AI_CONFIG_IMPORT_TRUSTED_INPUT, false);
+        if (trustedInput && (pFlags & aiProcess_ValidateDataStructure)) {
+            DefaultLogger::get()->debug("Trusted input, skipping aiProcess_ValidateDataStructure");
+            pFlags &= ~aiProcess_ValidateDataStructure;
+        }
+
+        // Set up the scene arena, loaders pick it up in BaseImporter::ReadFile
+        if (GetPropertyBool(AI_CONFIG_IMPORT_SCENE_ARENA, false)) {
+            if (!pimpl->mArena) {
+                pimpl->mArena = new SceneArena();
+            }
+            // Reclaim anything left behind by a failed import
+            pimpl->mArena->Release();
+        }
+        else if (pimpl->mArena) {
+            delete pimpl->mArena;
+            pimpl->mArena = NULL;
+        }
+        ArenaScope arenaScope(pimpl->mArena);
 
         // Find an worker class which can handle the file
         BaseImporter* imp = NULL;
@@ -648,13 +682,16 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
             }
         }
 
-        // Get file size for progress handler
-        IOStream * fileIO = pimpl->mIOHandler->Open( pFile );
+        // Get file size for progress handler, the default one ignores it
+        // so don't open the file an extra time just for that
         uint32_t fileSize = 0;
-        if (fileIO)
-        {
-            fileSize = static_cast<uint32_t>(fileIO->FileSize());
-            pimpl->mIOHandler->Close( fileIO );
+        if (!pimpl->mIsDefaultProgressHandler) {
+            IOStream * fileIO = pimpl->mIOHandler->Open( pFile );
+            if (fileIO)
+            {
+                fileSize = static_cast<uint32_t>(fileIO->FileSize());
+                pimpl->mIOHandler->Close( fileIO );
+            }
         }
 
         // Dispatch the reading to the worker class for this format
@@ -666,15 +703,14 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
         DefaultLogger::get()->info("Found a matching importer for this file format: " + ext + "." );
         pimpl->mProgressHandler->UpdateFileRead( 0, fileSize );
 
-        if (profiler) {
-            profiler->BeginRegion("import");
+        {
+            ASSIMP_TRACE_SCOPE("import");
+            pimpl->mScene = imp->ReadFile( this, pFile, pimpl->mIOHandler);
+            pimpl->mProgressHandler->UpdateFileRead( fileSize, fileSize );
         }
-
-        pimpl->mScene = imp->ReadFile( this, pFile, pimpl->mIOHandler);
-        pimpl->mProgressHandler->UpdateFileRead( fileSize, fileSize );
-
-        if (profiler) {
-            profiler->EndRegion("import");
+        if (pimpl->mArena) {
+            DefaultLogger::get()->debug((format("Scene arena: "),pimpl->mArena->GetNumAllocations()," allocations, ",
+                pimpl->mArena->GetBytesUsed()," bytes in ",pimpl->mArena->GetNumBlocks()," blocks"));
         }
 
         // If successful, apply all active post processing steps to the imported data
@@ -684,6 +720,7 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
             // The ValidateDS process is an exception. It is executed first, even before ScenePreprocessor is called.
             if (pFlags & aiProcess_ValidateDataStructure)
             {
+                ASSIMP_TRACE_SCOPE("validate");
                 ValidateDSProcess ds;
                 ds.ExecuteOnScene (this);
                 if (!pimpl->mScene) {
@@ -693,15 +730,11 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
 #endif // no validation
 
             // Preprocess the scene and prepare it for post-processing
-            if (profiler) {
-                profiler->BeginRegion("preprocess");
-            }
-
-            ScenePreprocessor pre(pimpl->mScene);
-            pre.ProcessScene();
-
-            if (profiler) {
-                profiler->EndRegion("preprocess");
+            {
+                ASSIMP_TRACE_SCOPE("preprocess");
+                ScenePreprocessor pre(pimpl->mScene);
+                pre.SetTrustedInput(trustedInput);
+                pre.ProcessScene();
             }
 
             // Ensure that the validation process won't be called twice
@@ -714,10 +747,6 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
 
         // clear any data allocated by post-process steps
         pimpl->mPPShared->Clean();
-
-        if (profiler) {
-            profiler->EndRegion("total");
-        }
     }
 #ifdef ASSIMP_CATCH_GLOBAL_EXCEPTIONS
     catch (std::exception &e)
@@ -730,6 +759,7 @@ const aiScene* Importer::ReadFile( const char* _pFile, unsigned int pFlags)
 #endif
 
         DefaultLogger::get()->error(pimpl->mErrorString);
+        ArenaScope arenaScope(pimpl->mArena);
         delete pimpl->mScene; pimpl->mScene = NULL;
     }
 #endif // ! ASSIMP_CATCH_GLOBAL_EXCEPTIONS
@@ -758,6 +788,12 @@ const aiScene* Importer::ApplyPostProcessing(unsigned int pFlags)
     // In debug builds: run basic flag validation
     ai_assert(_ValidateFlags(pFlags));
     DefaultLogger::get()->info("Entering post processing pipeline");
+    ArenaScope arenaScope(pimpl->mArena);
+
+    // Trusted input is never validated, see ReadFile()
+    if (GetPropertyBool(AI_CONFIG_IMPORT_TRUSTED_INPUT, false)) {
+        pFlags &= ~aiProcess_ValidateDataStructure;
+    }
 
 #ifndef ASSIMP_BUILD_NO_VALIDATEDS_PROCESS
     // The ValidateDS process plays an exceptional role. It isn't contained in the global
@@ -785,21 +821,20 @@ const aiScene* Importer::ApplyPostProcessing(unsigned int pFlags)
     }
 #endif // ! DEBUG
 
-    std::unique_ptr<Profiler> profiler(GetPropertyInteger(AI_CONFIG_GLOB_MEASURE_TIME,0)?new Profiler():NULL);
     for( unsigned int a = 0; a < pimpl->mPostProcessingSteps.size(); a++)   {
 
         BaseProcess* process = pimpl->mPostProcessingSteps[a];
         pimpl->mProgressHandler->UpdatePostProcess(static_cast<int>(a), static_cast<int>(pimpl->mPostProcessingSteps.size()) );
         if( process->IsActive( pFlags)) {
 
-            if (profiler) {
-                profiler->BeginRegion("postprocess");
+            {
+                ASSIMP_TRACE_SCOPE("postprocess");
+                process->ExecuteOnScene ( this );
             }
 
-            process->ExecuteOnScene ( this );
-
-            if (profiler) {
-                profiler->EndRegion("postprocess");
+            // Steps may replace faces, keep the flat index arrays honest
+            if (pimpl->mArena && pimpl->mScene) {
+                pimpl->mArena->UpdateTriangleIndices(pimpl->mScene);
             }
         }
         if( !pimpl->mScene) {
@@ -854,6 +889,7 @@ const aiScene* Importer::ApplyCustomizedPostProcessing( BaseProcess *rootProcess
 
     // In debug builds: run basic flag validation
     DefaultLogger::get()->info( "Entering customized post processing pipeline" );
+    ArenaScope arenaScope( pimpl->mArena );
 
 #ifndef ASSIMP_BUILD_NO_VALIDATEDS_PROCESS
     // The ValidateDS process plays an exceptional role. It isn't contained in the global
@@ -880,16 +916,13 @@ const aiScene* Importer::ApplyCustomizedPostProcessing( BaseProcess *rootProcess
     }
 #endif // ! DEBUG
 
-    std::unique_ptr<Profiler> profiler( GetPropertyInteger( AI_CONFIG_GLOB_MEASURE_TIME, 0 ) ? new Profiler() : NULL );
-
-    if ( profiler ) {
-        profiler->BeginRegion( "postprocess" );
+    {
+        ASSIMP_TRACE_SCOPE( "postprocess" );
+        rootProcess->ExecuteOnScene( this );
     }
 
-    rootProcess->ExecuteOnScene( this );
-
-    if ( profiler ) {
-        profiler->EndRegion( "postprocess" );
+    if ( pimpl->mArena && pimpl->mScene ) {
+        pimpl->mArena->UpdateTriangleIndices( pimpl->mScene );
     }
 
     // If the extra verbose mode is active, execute the ValidateDataStructureStep again - after each step
@@ -57,6 +57,7 @@ namespace Assimp    {
     class BaseImporter;
     class BaseProcess;
     class SharedPostProcessInfo;
+    class SceneArena;
 
 
 //! @cond never
@@ -121,6 +122,9 @@ public:
 
     /** Used by post-process steps to share data */
     SharedPostProcessInfo* mPPShared;
+
+    /** Arena for scene data, NULL unless #AI_CONFIG_IMPORT_SCENE_ARENA is set */
+    SceneArena* mArena;
 };
 //! @endcond
 
@@ -131,8 +135,10 @@ struct BatchData;
 /** FOR IMPORTER PLUGINS ONLY: A helper class to the pleasure of importers
  *  that need to load many external meshes recursively.
  *
- *  The class uses several threads to load these meshes (or at least it
- *  could, this has not yet been implemented at the moment).
+ *  By default all meshes are loaded one after another on the calling
+ *  thread. setNumThreads() enables a parallel mode in which a pool of
+ *  workers, each with its own Importer, shares the IOSystem and works
+ *  through the queue; PollImport() reports requests as they finish.
  *
  *  @note The class may not be used by more than one thread*/
 class ASSIMP_API BatchLoader
@@ -170,7 +176,8 @@ public:
     explicit BatchLoader(IOSystem* pIO, bool validate = false );
 
     // -------------------------------------------------------------------
-    /** The class destructor.
+    /** The class destructor. Requests not yet started by LoadAsync()
+     *  are dropped, the ones being loaded are waited for.
      */
     ~BatchLoader();
 
@@ -185,6 +192,21 @@ public:
      *  @return The current validation step.
      */
     bool getValidation() const;
+
+    // -------------------------------------------------------------------
+    /** Sets the number of worker threads used to load the queue.
+     *  The IOSystem is shared by all workers and must be safe to use
+     *  from several threads, DefaultIOSystem is.
+     *  @param  numThreads  Number of workers, 0 for one per core. 1 (the
+     *    default) loads everything on the calling thread in LoadAll().
+     */
+    void setNumThreads( unsigned int numThreads );
+
+    // -------------------------------------------------------------------
+    /** Returns the number of worker threads.
+     *  @return The number of worker threads, 0 for one per core.
+     */
+    unsigned int getNumThreads() const;
     
     // -------------------------------------------------------------------
     /** Add a new file to the list of files to be loaded.
@@ -218,6 +240,27 @@ public:
      *  immediately if no scenes are queued.*/
     void LoadAll();
 
+    // -------------------------------------------------------------------
+    /** Starts loading all queued scenes on the worker threads and
+     *  returns immediately. No requests may be added until LoadAll()
+     *  has returned. Loads synchronously in single-threaded builds. */
+    void LoadAsync();
+
+    // -------------------------------------------------------------------
+    /** Get the next request that finished loading.
+     *  Each finished request is reported once, in completion order.
+     *
+     *  @param which Receives the LRWC of the finished request, to be
+     *    passed to GetImport().
+     *  @return false if no request finished since the last call. */
+    bool PollImport(
+        unsigned int& which
+        );
+
+    // -------------------------------------------------------------------
+    /** Returns the number of queued requests still being loaded. */
+    unsigned int GetNumPending() const;
+
 private:
     // No need to have that in the public API ...
     BatchData *m_data;
@@ -38,13 +38,14 @@ THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ---------------------------------------------------------------------------
-*/
 
 /** @file Implementation of the post processing step to improve the cache locality of a mesh.
  * <br>
  * The algorithm is roughly basing on this paper:
  * http://www.cs.princeton.edu/gfx/pubs/Sander_2007_%3ETR/tipsy.pdf
- *   .. although overdraw rduction isn't implemented yet ...
+ * Faces are reordered with tipsify first. The clusters it produces are then
+ * split further and sorted with the view-independent overdraw estimate from
+ * the same paper. At last the vertices are renumbered in fetch order.
  */
 
 
@@ -56,15 +57,155 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <assimp/DefaultLogger.hpp>
+#include <assimp/Tracer.h>
 #include <stdio.h>
+#include <float.h>
+#include <limits.h>
 #include <stack>
+#include <algorithm>
 
 using namespace Assimp;
 
+namespace {
+
+// ------------------------------------------------------------------------------------------------
+// Counts the misses of a FIFO post-transform cache of the given size
+unsigned int CountCacheMisses(const unsigned int* piIndices, size_t iIdxCnt,
+    unsigned int iNumVertices, unsigned int iCacheDepth)
+{
+    // a vertex is still cached as long as less than iCacheDepth misses happened since it was loaded
+    std::vector<unsigned int> piCachingStamps(iNumVertices, 0);
+    unsigned int iStampCnt = iCacheDepth + 1;
+    unsigned int iCacheMisses = 0;
+    for (size_t i = 0; i < iIdxCnt; ++i) {
+        const unsigned int dp = piIndices[i];
+        if (iStampCnt - piCachingStamps[dp] > iCacheDepth) {
+            piCachingStamps[dp] = iStampCnt++;
+            ++iCacheMisses;
+        }
+    }
+    return iCacheMisses;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Rasterizes one triangle with backface culling and depth test, returns the number of shaded pixels
+unsigned int RasterizeTriangle(const float* x, const float* y, const float* z,
+    std::vector<float>& depth, int iGridSize)
+{
+    const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area <= 0.f) {
+        return 0;
+    }
+
+    const int minX = std::max(0, (int)std::min(x[0], std::min(x[1], x[2])));
+    const int minY = std::max(0, (int)std::min(y[0], std::min(y[1], y[2])));
+    const int maxX = std::min(iGridSize - 1, (int)std::max(x[0], std::max(x[1], x[2])));
+    const int maxY = std::min(iGridSize - 1, (int)std::max(y[0], std::max(y[1], y[2])));
+
+    unsigned int iShaded = 0;
+    for (int py = minY; py <= maxY; ++py) {
+        for (int px = minX; px <= maxX; ++px) {
+            const float cx = px + 0.5f, cy = py + 0.5f;
+
+            // edge functions, pixel centers exactly on an edge belong to one side only
+            float w[3];
+            bool bInside = true;
+            for (unsigned int e = 0; e < 3 && bInside; ++e) {
+                const unsigned int a = (e + 1) % 3, b = (e + 2) % 3;
+                const float dx = x[b] - x[a], dy = y[b] - y[a];
+                w[e] = dx * (cy - y[a]) - dy * (cx - x[a]);
+                bInside = w[e] > 0.f || (w[e] == 0.f && (dy > 0.f || (dy == 0.f && dx < 0.f)));
+            }
+            if (!bInside) {
+                continue;
+            }
+
+            const float d = (w[0] * z[0] + w[1] * z[1] + w[2] * z[2]) / area;
+            float& stored = depth[py * iGridSize + px];
+            if (d < stored) {
+                stored = d;
+                ++iShaded;
+            }
+        }
+    }
+    return iShaded;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Rasterizes the mesh along all six axis directions and returns the ratio of shaded to
+// covered pixels. 1.0 means that every visible pixel was shaded exactly once.
+float MeasureOverdraw(const aiMesh* pMesh, const unsigned int* piIndices, size_t iIdxCnt)
+{
+    static const int iGridSize = 256;
+
+    aiVector3D vMin = pMesh->mVertices[0], vMax = vMin;
+    for (unsigned int i = 1; i < pMesh->mNumVertices; ++i) {
+        const aiVector3D& v = pMesh->mVertices[i];
+        vMin.x = std::min(vMin.x, v.x); vMax.x = std::max(vMax.x, v.x);
+        vMin.y = std::min(vMin.y, v.y); vMax.y = std::max(vMax.y, v.y);
+        vMin.z = std::min(vMin.z, v.z); vMax.z = std::max(vMax.z, v.z);
+    }
+    const aiVector3D vExtent = vMax - vMin;
+    const ai_real fExtent = std::max(vExtent.x, std::max(vExtent.y, vExtent.z));
+    if (fExtent <= 0) {
+        return 1.f;
+    }
+    const float fScale = (iGridSize - 1) / (float)fExtent;
+
+    std::vector<float> depth(iGridSize * iGridSize);
+    unsigned long long iShaded = 0, iCovered = 0;
+    for (unsigned int view = 0; view < 6; ++view) {
+        // look along -axis for the first three views, along +axis for the others
+        const unsigned int a = view % 3, b = (a + 1) % 3, c = (a + 2) % 3;
+        const bool bBack = view >= 3;
+
+        std::fill(depth.begin(), depth.end(), FLT_MAX);
+        for (size_t i = 0; i + 2 < iIdxCnt; i += 3) {
+            float x[3], y[3], z[3];
+            for (unsigned int k = 0; k < 3; ++k) {
+                const aiVector3D p = pMesh->mVertices[piIndices[i + k]] - vMin;
+                x[k] = (float)p[b] * fScale;
+                y[k] = (float)p[c] * fScale;
+                z[k] = (float)p[a] * fScale;
+                if (bBack) {
+                    x[k] = (iGridSize - 1) - x[k];
+                }
+                else {
+                    z[k] = -z[k];
+                }
+            }
+            iShaded += RasterizeTriangle(x, y, z, depth, iGridSize);
+        }
+        for (float d : depth) {
+            iCovered += d != FLT_MAX;
+        }
+    }
+    return iCovered ? (float)((double)iShaded / iCovered) : 1.f;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Moves each element of a vertex channel to its new position
+template <typename T>
+void RemapArray(T* pData, const std::vector<unsigned int>& remap)
+{
+    if (!pData) {
+        return;
+    }
+    // permute in place, the channel keeps its allocation
+    const std::vector<T> copy(pData, pData + remap.size());
+    for (size_t i = 0; i < remap.size(); ++i) {
+        pData[remap[i]] = copy[i];
+    }
+}
+
+} // namespace
+
 // ------------------------------------------------------------------------------------------------
 // Constructor to be privately used by Importer
 ImproveCacheLocalityProcess::ImproveCacheLocalityProcess() {
     configCacheDepth = PP_ICL_PTCACHE_SIZE;
+    configOverdrawThreshold = PP_ICL_OVERDRAW_THRESHOLD;
+    configLogACMR = false;
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -87,12 +228,17 @@ void ImproveCacheLocalityProcess::SetupProperties(const Importer* pImp)
 {
     // AI_CONFIG_PP_ICL_PTCACHE_SIZE controls the target cache size for the optimizer
     configCacheDepth = pImp->GetPropertyInteger(AI_CONFIG_PP_ICL_PTCACHE_SIZE,PP_ICL_PTCACHE_SIZE);
+    // AI_CONFIG_PP_ICL_OVERDRAW_THRESHOLD controls how much ACMR may be traded for less overdraw
+    configOverdrawThreshold = pImp->GetPropertyFloat(AI_CONFIG_PP_ICL_OVERDRAW_THRESHOLD,PP_ICL_OVERDRAW_THRESHOLD);
+    // AI_CONFIG_PP_ICL_LOG_ACMR reports the cache efficiency without verbose logging
+    configLogACMR = pImp->GetPropertyBool(AI_CONFIG_PP_ICL_LOG_ACMR,false);
 }
 
 // ------------------------------------------------------------------------------------------------
 // Executes the post processing step on the given imported data.
 void ImproveCacheLocalityProcess::Execute( aiScene* pScene)
 {
+    ASSIMP_TRACE_SCOPE("ImproveCacheLocality");
     if (!pScene->mNumMeshes) {
         DefaultLogger::get()->debug("ImproveCacheLocalityProcess skipped; there are no meshes");
         return;
@@ -100,109 +246,132 @@ void ImproveCacheLocalityProcess::Execute( aiScene* pScene)
 
     DefaultLogger::get()->debug("ImproveCacheLocalityProcess begin");
 
-    float out = 0.f;
-    unsigned int numf = 0, numm = 0;
+    memset(&stats, 0, sizeof(stats));
     for( unsigned int a = 0; a < pScene->mNumMeshes; a++){
-        const float res = ProcessMesh( pScene->mMeshes[a],a);
-        if (res) {
-            numf += pScene->mMeshes[a]->mNumFaces;
-            out  += res;
-            ++numm;
-        }
+        ProcessMesh( pScene->mMeshes[a],a);
     }
     if (!DefaultLogger::isNullLogger()) {
-        char szBuff[128]; // should be sufficiently large in every case
-        ai_snprintf(szBuff,128,"Cache relevant are %u meshes (%u faces). Average output ACMR is %f",
-            numm,numf,out/numf);
+        // Only gathered for verbose loggers or AI_CONFIG_PP_ICL_LOG_ACMR, see ProcessMesh()
+        if (stats.numMeshes) {
+            char szBuff[256]; // should be sufficiently large in every case
+            ai_snprintf(szBuff,256,"Cache relevant are %u meshes (%u faces). ACMR %f -> %f, ATVR %f -> %f",
+                stats.numMeshes,stats.numFaces,
+                (float)stats.missesIn / stats.numFaces,(float)stats.missesOut / stats.numFaces,
+                (float)stats.missesIn / stats.numVertices,(float)stats.missesOut / stats.numVertices);
+            std::string message = szBuff;
+            if (stats.overdrawIn > 0.0) {
+                ai_snprintf(szBuff,256,", overdraw %f -> %f",
+                    stats.overdrawIn / stats.numFaces,stats.overdrawOut / stats.numFaces);
+                message += szBuff;
+            }
 
-        DefaultLogger::get()->info(szBuff);
+            DefaultLogger::get()->info(message);
+        }
         DefaultLogger::get()->debug("ImproveCacheLocalityProcess finished. ");
     }
 }
 
 // ------------------------------------------------------------------------------------------------
 // Improves the cache coherency of a specific mesh
-float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int meshNum)
+bool ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int meshNum)
 {
-    // TODO: rewrite this to use std::vector or boost::shared_array
     ai_assert(NULL != pMesh);
 
     // Check whether the input data is valid
     // - there must be vertices and faces
     // - all faces must be triangulated or we can't operate on them
     if (!pMesh->HasFaces() || !pMesh->HasPositions())
-        return 0.f;
+        return false;
 
     if (pMesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE) {
         DefaultLogger::get()->error("This algorithm works on triangle meshes only");
-        return 0.f;
+        return false;
     }
 
     if(pMesh->mNumVertices <= configCacheDepth) {
-        return 0.f;
+        return false;
     }
 
-    float fACMR = 3.f;
+    const unsigned int iIdxCnt = pMesh->mNumFaces*3;
     const aiFace* const pcEnd = pMesh->mFaces+pMesh->mNumFaces;
+    // Input and output statistics are for logging purposes only. Measuring
+    // overdraw rasterizes the mesh twice, so only verbose loggers get it
+    const bool bVerbose = !DefaultLogger::isNullLogger() && DefaultLogger::get()->getLogSeverity() == Logger::VERBOSE;
+    const bool bLog = bVerbose || (configLogACMR && !DefaultLogger::isNullLogger());
+
+    unsigned int iMissesIn = 0;
+    float fOverdrawIn = 0.f;
+    if (bLog) {
+        std::vector<unsigned int> input;
+        input.reserve(iIdxCnt);
+        for (const aiFace* pcFace = pMesh->mFaces; pcFace != pcEnd; ++pcFace) {
+            input.insert(input.end(), pcFace->mIndices, pcFace->mIndices + 3);
+        }
+        iMissesIn = CountCacheMisses(&input[0], iIdxCnt, pMesh->mNumVertices, configCacheDepth);
+        if (bVerbose) {
+            fOverdrawIn = MeasureOverdraw(pMesh, &input[0], iIdxCnt);
+        }
+    }
 
-    // Input ACMR is for logging purposes only
-    if (!DefaultLogger::isNullLogger())     {
+    std::vector<unsigned int> indices, clusters;
+    ReorderForCache(pMesh, indices, clusters);
+    if (configOverdrawThreshold >= 1.f) {
+        ReorderForOverdraw(pMesh, indices, clusters);
+    }
+    const unsigned int iNumReferenced = ReorderForFetch(pMesh, indices);
 
-        unsigned int* piFIFOStack = new unsigned int[configCacheDepth];
-        memset(piFIFOStack,0xff,configCacheDepth*sizeof(unsigned int));
-        unsigned int* piCur = piFIFOStack;
-        const unsigned int* const piCurEnd = piFIFOStack + configCacheDepth;
+    // sort the output index buffer back to the input array. Since the number of triangles
+    // won't change the faces keep their index arrays.
+    const unsigned int* piCSIter = &indices[0];
+    for (aiFace* pcFace = pMesh->mFaces; pcFace != pcEnd;++pcFace)  {
+        pcFace->mIndices[0] = *piCSIter++;
+        pcFace->mIndices[1] = *piCSIter++;
+        pcFace->mIndices[2] = *piCSIter++;
+    }
 
-        // count the number of cache misses
-        unsigned int iCacheMisses = 0;
-        for (const aiFace* pcFace = pMesh->mFaces;pcFace != pcEnd;++pcFace) {
+    if (bLog) {
+        const unsigned int iMissesOut = CountCacheMisses(&indices[0], iIdxCnt, pMesh->mNumVertices, configCacheDepth);
+        const float fOverdrawOut = bVerbose ? MeasureOverdraw(pMesh, &indices[0], iIdxCnt) : 0.f;
 
-            for (unsigned int qq = 0; qq < 3;++qq) {
-                bool bInCache = false;
+        if (bVerbose) {
+            // very intense verbose logging ... prepare for much text if there are many meshes
+            char szBuff[256]; // should be sufficiently large in every case
 
-                for (unsigned int* pp = piFIFOStack;pp < piCurEnd;++pp) {
-                    if (*pp == pcFace->mIndices[qq])    {
-                        // the vertex is in cache
-                        bInCache = true;
-                        break;
-                    }
-                }
-                if (!bInCache)  {
-                    ++iCacheMisses;
-                    if (piCurEnd == piCur) {
-                        piCur = piFIFOStack;
-                    }
-                    *piCur++ = pcFace->mIndices[qq];
-                }
-            }
-        }
-        delete[] piFIFOStack;
-        fACMR = (float)iCacheMisses / pMesh->mNumFaces;
-        if (3.0 == fACMR)   {
-            char szBuff[128]; // should be sufficiently large in every case
-
-            // the JoinIdenticalVertices process has not been executed on this
-            // mesh, otherwise this value would normally be at least minimally
-            // smaller than 3.0 ...
-            ai_snprintf(szBuff,128,"Mesh %u: Not suitable for vcache optimization",meshNum);
-            DefaultLogger::get()->warn(szBuff);
-            return 0.f;
+            ai_snprintf(szBuff,256,"Mesh %u | ACMR in: %f out: %f | ATVR in: %f out: %f | overdraw in: %f out: %f | %u clusters",
+                meshNum,(float)iMissesIn / pMesh->mNumFaces,(float)iMissesOut / pMesh->mNumFaces,
+                (float)iMissesIn / iNumReferenced,(float)iMissesOut / iNumReferenced,
+                fOverdrawIn,fOverdrawOut,(unsigned int)clusters.size());
+            DefaultLogger::get()->debug(szBuff);
         }
+
+        ++stats.numMeshes;
+        stats.numFaces += pMesh->mNumFaces;
+        stats.numVertices += iNumReferenced;
+        stats.missesIn += iMissesIn;
+        stats.missesOut += iMissesOut;
+        stats.overdrawIn += (double)fOverdrawIn * pMesh->mNumFaces;
+        stats.overdrawOut += (double)fOverdrawOut * pMesh->mNumFaces;
     }
+    return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Reorders the faces of a mesh with tipsify
+void ImproveCacheLocalityProcess::ReorderForCache( const aiMesh* pMesh, std::vector<unsigned int>& out,
+    std::vector<unsigned int>& clusters)
+{
+    const unsigned int iNumVertices = pMesh->mNumVertices;
 
     // first we need to build a vertex-triangle adjacency list
-    VertexTriangleAdjacency adj(pMesh->mFaces,pMesh->mNumFaces, pMesh->mNumVertices,true);
+    VertexTriangleAdjacency adj(pMesh->mFaces,pMesh->mNumFaces, iNumVertices,true);
 
     // build a list to store per-vertex caching time stamps
-    unsigned int* const piCachingStamps = new unsigned int[pMesh->mNumVertices];
-    memset(piCachingStamps,0x0,pMesh->mNumVertices*sizeof(unsigned int));
+    std::vector<unsigned int> piCachingStamps(iNumVertices, 0);
 
-    // allocate an empty output index buffer. We store the output indices in one large array.
-    // Since the number of triangles won't change the input faces can be reused. This is how
-    // we save thousands of redundant mini allocations for aiFace::mIndices
-    const unsigned int iIdxCnt = pMesh->mNumFaces*3;
-    unsigned int* const piIBOutput = new unsigned int[iIdxCnt];
-    unsigned int* piCSIter = piIBOutput;
+    // allocate an empty output index buffer
+    out.clear();
+    out.reserve(pMesh->mNumFaces*3);
+    clusters.clear();
 
     // allocate the flag array to hold the information
     // whether a face has already been emitted or not
@@ -213,19 +382,10 @@ float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int mesh
 
     // create a copy of the piNumTriPtr buffer
     unsigned int* const piNumTriPtr = adj.mLiveTriangles;
-    const std::vector<unsigned int> piNumTriPtrNoModify(piNumTriPtr, piNumTriPtr + pMesh->mNumVertices);
-
-    // get the largest number of referenced triangles and allocate the "candidate buffer"
-    unsigned int iMaxRefTris = 0; {
-        const unsigned int* piCur = adj.mLiveTriangles;
-        const unsigned int* const piCurEnd = adj.mLiveTriangles+pMesh->mNumVertices;
-        for (;piCur != piCurEnd;++piCur) {
-            iMaxRefTris = std::max(iMaxRefTris,*piCur);
-        }
-    }
-    ai_assert(iMaxRefTris > 0);
-    unsigned int* piCandidates = new unsigned int[iMaxRefTris*3];
-    unsigned int iCacheMisses = 0;
+    const std::vector<unsigned int> piNumTriPtrNoModify(piNumTriPtr, piNumTriPtr + iNumVertices);
+
+    // the 1-ring of the current fanning vertex
+    std::vector<unsigned int> piCandidates;
 
     // ...................................................................................
     /** PSEUDOCODE for the algorithm
@@ -254,17 +414,22 @@ float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int mesh
             Select next fanning vertex
             f = Get-Next-Vertex(I,i,k,N,C,s,L,D)
         return O
+
+        A new cluster starts whenever Get-Next-Vertex runs out of dead-end
+        vertices and has to jump ahead in input order, the cache contents
+        are lost there anyway.
         */
     // ...................................................................................
 
     int ivdx = 0;
-    int ics = 1;
-    int iStampCnt = configCacheDepth+1;
+    unsigned int ics = 0;
+    unsigned int iStampCnt = configCacheDepth+1;
+    bool bNewCluster = true;
     while (ivdx >= 0)   {
 
         unsigned int icnt = piNumTriPtrNoModify[ivdx];
         unsigned int* piList = adj.GetAdjacentTriangles(ivdx);
-        unsigned int* piCurCandidate = piCandidates;
+        piCandidates.clear();
 
         // get all triangles in the neighborhood
         for (unsigned int tri = 0; tri < icnt;++tri)    {
@@ -273,6 +438,11 @@ float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int mesh
             const unsigned int fidx = *piList++;
             if (!abEmitted[fidx])   {
 
+                if (bNewCluster) {
+                    clusters.push_back((unsigned int)(out.size() / 3));
+                    bNewCluster = false;
+                }
+
                 // so iterate through all vertices of the current triangle
                 const aiFace* pcFace = &pMesh->mFaces[ fidx ];
                 for (unsigned int* p = pcFace->mIndices, *p2 = pcFace->mIndices+3;p != p2;++p)  {
@@ -284,19 +454,18 @@ float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int mesh
                         sDeadEndVStack.push(dp);
 
                         // register as candidate for the next step
-                        *piCurCandidate++ = dp;
+                        piCandidates.push_back(dp);
 
                         // decrease the per-vertex triangle counts
                         piNumTriPtr[dp]--;
                     }
 
                     // append the vertex to the output index buffer
-                    *piCSIter++ = dp;
+                    out.push_back(dp);
 
                     // if the vertex is not yet in cache, set its cache count
                     if (iStampCnt-piCachingStamps[dp] > configCacheDepth) {
                         piCachingStamps[dp] = iStampCnt++;
-                        ++iCacheMisses;
                     }
                 }
                 // flag triangle as emitted
@@ -310,8 +479,8 @@ float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int mesh
         // get next fanning vertex
         ivdx = -1;
         int max_priority = -1;
-        for (unsigned int* piCur = piCandidates;piCur != piCurCandidate;++piCur)    {
-            const unsigned int dp = *piCur;
+        for (std::vector<unsigned int>::const_iterator it = piCandidates.begin(); it != piCandidates.end(); ++it) {
+            const unsigned int dp = *it;
 
             // must have live triangles
             if (piNumTriPtr[dp] > 0)    {
@@ -345,9 +514,9 @@ float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int mesh
 
             if (-1 == ivdx) {
                 // well, there isn't such a vertex. Simply get the next vertex in input order and
-                // hope it is not too bad ...
-                while (ics < (int)pMesh->mNumVertices)  {
-                    ++ics;
+                // hope it is not too bad ... this flushes the cache, so start a new cluster
+                bNewCluster = true;
+                for (; ics < iNumVertices; ++ics) {
                     if (piNumTriPtr[ics] > 0)   {
                         ivdx = ics;
                         break;
@@ -356,33 +525,166 @@ float ImproveCacheLocalityProcess::ProcessMesh( aiMesh* pMesh, unsigned int mesh
             }
         }
     }
-    float fACMR2 = 0.0f;
-    if (!DefaultLogger::isNullLogger()) {
-        fACMR2 = (float)iCacheMisses / pMesh->mNumFaces;
+    ai_assert(out.size() == pMesh->mNumFaces*3);
+}
 
-        // very intense verbose logging ... prepare for much text if there are many meshes
-        if ( DefaultLogger::get()->getLogSeverity() == Logger::VERBOSE) {
-            char szBuff[128]; // should be sufficiently large in every case
+// ------------------------------------------------------------------------------------------------
+// Splits the clusters and sorts them by their view-independent occlusion potential
+void ImproveCacheLocalityProcess::ReorderForOverdraw( const aiMesh* pMesh, std::vector<unsigned int>& indices,
+    std::vector<unsigned int>& clusters)
+{
+    const unsigned int iNumFaces = (unsigned int)(indices.size() / 3);
+
+    // Split the clusters where their own ACMR, simulated with a cold cache, has dropped
+    // below the threshold. Smaller clusters sort better, but each one refills the cache.
+    const float fMaxACMR = configOverdrawThreshold *
+        CountCacheMisses(&indices[0], indices.size(), pMesh->mNumVertices, configCacheDepth) / iNumFaces;
+
+    std::vector<unsigned int> piCachingStamps(pMesh->mNumVertices, 0);
+    unsigned int iStampCnt = configCacheDepth+1;
+    std::vector<unsigned int> split;
+    split.reserve(clusters.size());
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        const unsigned int iEnd = c + 1 < clusters.size() ? clusters[c + 1] : iNumFaces;
+        unsigned int iMisses = 0, iFaces = 0;
+
+        split.push_back(clusters[c]);
+        iStampCnt += configCacheDepth+1;
+        for (unsigned int f = clusters[c]; f < iEnd; ++f) {
+            for (unsigned int k = 0; k < 3; ++k) {
+                const unsigned int dp = indices[f*3+k];
+                if (iStampCnt-piCachingStamps[dp] > configCacheDepth) {
+                    piCachingStamps[dp] = iStampCnt++;
+                    ++iMisses;
+                }
+            }
+            ++iFaces;
 
-            ai_snprintf(szBuff,128,"Mesh %u | ACMR in: %f out: %f | ~%.1f%%",meshNum,fACMR,fACMR2,
-                ((fACMR - fACMR2) / fACMR) * 100.f);
-            DefaultLogger::get()->debug(szBuff);
+            if (f + 1 < iEnd && iMisses <= fMaxACMR * iFaces) {
+                split.push_back(f + 1);
+                iStampCnt += configCacheDepth+1;
+                iMisses = iFaces = 0;
+            }
+        }
+    }
+    clusters.swap(split);
+
+    // Clusters near the outside of the mesh which face outwards are likely to occlude
+    // others, so they are drawn first. The measure is the distance of the cluster centroid
+    // to the mesh centroid along the average cluster normal, both weighted by face area.
+    const size_t iNumClusters = clusters.size();
+    std::vector<aiVector3D> vCenter(iNumClusters), vNormal(iNumClusters);
+    std::vector<ai_real> fArea(iNumClusters, 0);
+    aiVector3D vMeshCenter;
+    ai_real fMeshArea = 0;
+    for (size_t c = 0; c < iNumClusters; ++c) {
+        const unsigned int iEnd = c + 1 < iNumClusters ? clusters[c + 1] : iNumFaces;
+        for (unsigned int f = clusters[c]; f < iEnd; ++f) {
+            const aiVector3D& p0 = pMesh->mVertices[indices[f*3]];
+            const aiVector3D& p1 = pMesh->mVertices[indices[f*3+1]];
+            const aiVector3D& p2 = pMesh->mVertices[indices[f*3+2]];
+            const aiVector3D vCross = (p1 - p0) ^ (p2 - p0);
+            const ai_real fFaceArea = vCross.Length();
+
+            vCenter[c] += (p0 + p1 + p2) * (fFaceArea / 3);
+            vNormal[c] += vCross;
+            fArea[c] += fFaceArea;
         }
+        vMeshCenter += vCenter[c];
+        fMeshArea += fArea[c];
+    }
+    if (fMeshArea > 0) {
+        vMeshCenter /= fMeshArea;
+    }
 
-        fACMR2 *= pMesh->mNumFaces;
+    std::vector<float> fKey(iNumClusters, 0.f);
+    for (size_t c = 0; c < iNumClusters; ++c) {
+        if (fArea[c] > 0 && vNormal[c].SquareLength() > 0) {
+            fKey[c] = (float)((vCenter[c] / fArea[c] - vMeshCenter) * vNormal[c].Normalize());
+        }
     }
-    // sort the output index buffer back to the input array
-    piCSIter = piIBOutput;
-    for (aiFace* pcFace = pMesh->mFaces; pcFace != pcEnd;++pcFace)  {
-        pcFace->mIndices[0] = *piCSIter++;
-        pcFace->mIndices[1] = *piCSIter++;
-        pcFace->mIndices[2] = *piCSIter++;
+
+    std::vector<unsigned int> order(iNumClusters);
+    for (size_t c = 0; c < iNumClusters; ++c) {
+        order[c] = (unsigned int)c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&fKey](unsigned int a, unsigned int b) {
+        return fKey[a] > fKey[b];
+    });
+
+    std::vector<unsigned int> sorted, sortedClusters;
+    sorted.reserve(indices.size());
+    sortedClusters.reserve(iNumClusters);
+    for (size_t i = 0; i < iNumClusters; ++i) {
+        const unsigned int c = order[i];
+        const unsigned int iEnd = c + 1 < iNumClusters ? clusters[c + 1] : iNumFaces;
+        sortedClusters.push_back((unsigned int)(sorted.size() / 3));
+        sorted.insert(sorted.end(), indices.begin() + clusters[c]*3, indices.begin() + iEnd*3);
+    }
+    indices.swap(sorted);
+    clusters.swap(sortedClusters);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Renumbers the vertices in the order in which the index buffer references them
+unsigned int ImproveCacheLocalityProcess::ReorderForFetch( aiMesh* pMesh, std::vector<unsigned int>& indices)
+{
+    const unsigned int iNumVertices = pMesh->mNumVertices;
+    std::vector<unsigned int> remap(iNumVertices, UINT_MAX);
+    unsigned int iNext = 0;
+    for (std::vector<unsigned int>::iterator it = indices.begin(); it != indices.end(); ++it) {
+        if (UINT_MAX == remap[*it]) {
+            remap[*it] = iNext++;
+        }
+        *it = remap[*it];
+    }
+    const unsigned int iNumReferenced = iNext;
+
+    // unreferenced vertices keep their relative order behind all others
+    bool bIdentity = true;
+    for (unsigned int i = 0; i < iNumVertices; ++i) {
+        if (UINT_MAX == remap[i]) {
+            remap[i] = iNext++;
+        }
+        bIdentity = bIdentity && remap[i] == i;
+    }
+    if (bIdentity) {
+        return iNumReferenced;
+    }
+
+    RemapArray(pMesh->mVertices, remap);
+    RemapArray(pMesh->mNormals, remap);
+    RemapArray(pMesh->mTangents, remap);
+    RemapArray(pMesh->mBitangents, remap);
+    for (unsigned int i = 0; i < AI_MAX_NUMBER_OF_COLOR_SETS; ++i) {
+        RemapArray(pMesh->mColors[i], remap);
+    }
+    for (unsigned int i = 0; i < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++i) {
+        RemapArray(pMesh->mTextureCoords[i], remap);
     }
 
-    // delete temporary storage
-    delete[] piCachingStamps;
-    delete[] piIBOutput;
-    delete[] piCandidates;
+    for (unsigned int i = 0; i < pMesh->mNumBones; ++i) {
+        aiBone* pcBone = pMesh->mBones[i];
+        for (unsigned int w = 0; w < pcBone->mNumWeights; ++w) {
+            pcBone->mWeights[w].mVertexId = remap[pcBone->mWeights[w].mVertexId];
+        }
+    }
 
-    return fACMR2;
+    for (unsigned int i = 0; i < pMesh->mNumAnimMeshes; ++i) {
+        aiAnimMesh* pcAnim = pMesh->mAnimMeshes[i];
+        if (pcAnim->mNumVertices != iNumVertices) {
+            continue;
+        }
+        RemapArray(pcAnim->mVertices, remap);
+        RemapArray(pcAnim->mNormals, remap);
+        RemapArray(pcAnim->mTangents, remap);
+        RemapArray(pcAnim->mBitangents, remap);
+        for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c) {
+            RemapArray(pcAnim->mColors[c], remap);
+        }
+        for (unsigned int t = 0; t < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++t) {
+            RemapArray(pcAnim->mTextureCoords[t], remap);
+        }
+    }
+    return iNumReferenced;
 }
@@ -39,13 +39,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ----------------------------------------------------------------------
 */
 
-/** @file Defines a post processing step to reorder faces for
- better cache locality*/
+/** @file Defines a post processing step to reorder faces and vertices
+ for better cache locality and less overdraw*/
 #ifndef AI_IMPROVECACHELOCALITY_H_INC
 #define AI_IMPROVECACHELOCALITY_H_INC
 
 #include "BaseProcess.h"
 #include <assimp/types.h>
+#include <vector>
 
 struct aiMesh;
 
@@ -55,7 +56,9 @@ namespace Assimp
 // ---------------------------------------------------------------------------
 /** The ImproveCacheLocalityProcess reorders all faces for improved vertex
  *  cache locality. It tries to arrange all faces to fans and to render
- *  faces which share vertices directly one after the other.
+ *  faces which share vertices directly one after the other. The fans are
+ *  then grouped to clusters which are sorted to reduce overdraw, and the
+ *  vertices are renumbered in the order the faces first use them.
  *
  *  @note This step expects triagulated input data.
  */
@@ -86,12 +89,52 @@ protected:
      * @param pMesh The mesh to process.
      * @param meshNum Index of the mesh to process
      */
-    float ProcessMesh( aiMesh* pMesh, unsigned int meshNum);
+    bool ProcessMesh( aiMesh* pMesh, unsigned int meshNum);
+
+    // -------------------------------------------------------------------
+    /** Reorders the faces with tipsify
+     * @param pMesh The mesh to process.
+     * @param out Receives the new index buffer.
+     * @param clusters Receives the first face of each cluster, a new
+     *   cluster starts wherever the fan sequence had to be broken.
+     */
+    void ReorderForCache( const aiMesh* pMesh, std::vector<unsigned int>& out,
+        std::vector<unsigned int>& clusters);
+
+    // -------------------------------------------------------------------
+    /** Splits the clusters further and sorts them to reduce overdraw
+     * @param pMesh The mesh to process, only the positions are used.
+     * @param indices Index buffer, reordered in place.
+     * @param clusters First face of each cluster.
+     */
+    void ReorderForOverdraw( const aiMesh* pMesh, std::vector<unsigned int>& indices,
+        std::vector<unsigned int>& clusters);
+
+    // -------------------------------------------------------------------
+    /** Renumbers the vertices in the order they are first referenced
+     * @param pMesh The mesh to process, all vertex channels are permuted.
+     * @param indices Index buffer, remapped in place.
+     * @return Number of vertices referenced by the faces
+     */
+    unsigned int ReorderForFetch( aiMesh* pMesh, std::vector<unsigned int>& indices);
 
 private:
     //! Configuration parameter: specifies the size of the cache to
     //! optimize the vertex data for.
     unsigned int configCacheDepth;
+
+    //! Configuration parameter: ACMR factor the overdraw pass may spend
+    float configOverdrawThreshold;
+
+    //! Configuration parameter: log ACMR and ATVR for non-verbose loggers
+    bool configLogACMR;
+
+    //! Statistics collected over all meshes, for logging
+    struct Stats {
+        unsigned int numMeshes, numFaces, numVertices;
+        unsigned int missesIn, missesOut;
+        double overdrawIn, overdrawOut;
+    } stats;
 };
 
 } // end of namespace Assimp
@@ -51,6 +51,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ProcessHelper.h"
 #include "Vertex.h"
 #include "TinyFormatter.h"
+#include <assimp/Tracer.h>
 #include <stdio.h>
 
 using namespace Assimp;
@@ -78,6 +79,7 @@ bool JoinVerticesProcess::IsActive( unsigned int pFlags) const
 // Executes the post processing step on the given imported data.
 void JoinVerticesProcess::Execute( aiScene* pScene)
 {
+    ASSIMP_TRACE_SCOPE("JoinVertices");
     DefaultLogger::get()->debug("JoinVerticesProcess begin");
 
     // get the total number of vertices BEFORE the step is executed
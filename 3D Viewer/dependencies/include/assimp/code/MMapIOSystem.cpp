@@ -0,0 +1,253 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2017, assimp team
+
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+
+/** @file Implementation of IOSystem that maps files into memory for reading */
+
+#include <assimp/MMapIOSystem.h>
+#include <assimp/DefaultLogger.hpp>
+#include <assimp/ai_assert.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef _WIN32
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   include <windows.h>
+#else
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+using namespace Assimp;
+
+namespace {
+
+// ------------------------------------------------------------------------------------------------
+// Maps the whole file copy-on-write. Importers that parse in place may scribble
+// over the view (e.g. insitu JSON parsing), this must never reach the file.
+const uint8_t* MapFile(const char* pFile, size_t& length)
+{
+    length = 0;
+#ifdef _WIN32
+    HANDLE file = ::CreateFileA(pFile, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (INVALID_HANDLE_VALUE == file) {
+        return NULL;
+    }
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size) || 0 == size.QuadPart) {
+        ::CloseHandle(file);
+        return NULL;
+    }
+
+    // the view keeps the mapping object alive, both handles can go right away
+    HANDLE mapping = ::CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    ::CloseHandle(file);
+    if (NULL == mapping) {
+        return NULL;
+    }
+    void* data = ::MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    ::CloseHandle(mapping);
+    if (NULL == data) {
+        return NULL;
+    }
+    length = static_cast<size_t>(size.QuadPart);
+    return static_cast<const uint8_t*>(data);
+#else
+    const int fd = ::open(pFile, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (0 != ::fstat(fd, &st) || !S_ISREG(st.st_mode) || 0 == st.st_size) {
+        ::close(fd);
+        return NULL;
+    }
+
+    void* data = ::mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE,
+        MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == data) {
+        return NULL;
+    }
+#ifdef MADV_SEQUENTIAL
+    ::madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+#endif
+    length = static_cast<size_t>(st.st_size);
+    return static_cast<const uint8_t*>(data);
+#endif
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------------------------------
+MMapIOStream::MMapIOStream(const uint8_t* pData, size_t pLength,
+        const std::string &strFilename) :
+    mData(pData),
+    mLength(pLength),
+    mPos(0),
+    mFilename(strFilename)
+{
+    // empty
+}
+
+// ------------------------------------------------------------------------------------------------
+MMapIOStream::~MMapIOStream()
+{
+#ifdef _WIN32
+    ::UnmapViewOfFile(mData);
+#else
+    ::munmap(const_cast<uint8_t*>(mData), mLength);
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+size_t MMapIOStream::Read(void* pvBuffer,
+    size_t pSize,
+    size_t pCount)
+{
+    ai_assert(NULL != pvBuffer && 0 != pSize && 0 != pCount);
+
+    const size_t cnt = std::min(pCount, (mLength - mPos) / pSize), ofs = pSize * cnt;
+    ::memcpy(pvBuffer, mData + mPos, ofs);
+    mPos += ofs;
+
+    return cnt;
+}
+
+// ------------------------------------------------------------------------------------------------
+size_t MMapIOStream::Write(const void* /*pvBuffer*/,
+    size_t /*pSize*/,
+    size_t /*pCount*/)
+{
+    return 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+aiReturn MMapIOStream::Seek(size_t pOffset,
+     aiOrigin pOrigin)
+{
+    // same semantics as fseek: positioning right at the end is fine
+    size_t pos;
+    if (aiOrigin_SET == pOrigin) {
+        pos = pOffset;
+    }
+    else if (aiOrigin_END == pOrigin) {
+        if (pOffset > mLength) {
+            return AI_FAILURE;
+        }
+        pos = mLength - pOffset;
+    }
+    else {
+        pos = mPos + pOffset;
+    }
+
+    if (pos > mLength) {
+        return AI_FAILURE;
+    }
+    mPos = pos;
+    return AI_SUCCESS;
+}
+
+// ------------------------------------------------------------------------------------------------
+size_t MMapIOStream::Tell() const
+{
+    return mPos;
+}
+
+// ------------------------------------------------------------------------------------------------
+size_t MMapIOStream::FileSize() const
+{
+    return mLength;
+}
+
+// ------------------------------------------------------------------------------------------------
+void MMapIOStream::Flush()
+{
+    // nothing to do here
+}
+
+// ------------------------------------------------------------------------------------------------
+const uint8_t* MMapIOStream::GetMappedData() const
+{
+    return mData;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Constructor.
+MMapIOSystem::MMapIOSystem()
+{
+    // nothing to do here
+}
+
+// ------------------------------------------------------------------------------------------------
+// Destructor.
+MMapIOSystem::~MMapIOSystem()
+{
+    // nothing to do here
+}
+
+// ------------------------------------------------------------------------------------------------
+// Open a new file with a given path.
+IOStream* MMapIOSystem::Open( const char* strFile, const char* strMode)
+{
+    ai_assert(NULL != strFile);
+    ai_assert(NULL != strMode);
+
+    // only pure read modes are mapped
+    if (NULL == ::strchr(strMode, 'r') || NULL != ::strpbrk(strMode, "wa+")) {
+        return DefaultIOSystem::Open(strFile, strMode);
+    }
+
+    size_t length;
+    const uint8_t* data = MapFile(strFile, length);
+    if (NULL == data) {
+        // empty files can't be mapped, let the default stream handle them
+        return DefaultIOSystem::Open(strFile, strMode);
+    }
+    return new MMapIOStream(data, length, strFile);
+}
@@ -46,6 +46,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ObjFileParser.h"
 #include "ObjFileData.h"
 #include "IOStreamBuffer.h"
+#include "SceneArena.h"
 #include <memory>
 #include <assimp/DefaultIOSystem.h>
 #include <assimp/Importer.hpp>
@@ -352,6 +353,12 @@ aiMesh *ObjFileImporter::createTopology( const ObjFile::Model* pModel, const Obj
 
         unsigned int outIndex( 0 );
 
+        // Pure triangle meshes view their indices in one flat array
+        unsigned int* flat( NULL );
+        if ( aiPrimitiveType_TRIANGLE == pMesh->mPrimitiveTypes ) {
+            flat = NewTriangleIndices( m_arena, pMesh );
+        }
+
         // Copy all data from all stored meshes
         for (size_t index = 0; index < pObjMesh->m_Faces.size(); index++) {
             ObjFile::Face* const inp = pObjMesh->m_Faces[ index ];
@@ -359,7 +366,7 @@ aiMesh *ObjFileImporter::createTopology( const ObjFile::Model* pModel, const Obj
                 for(size_t i = 0; i < inp->m_vertices.size() - 1; ++i) {
                     aiFace& f = pMesh->mFaces[ outIndex++ ];
                     uiIdxCount += f.mNumIndices = 2;
-                    f.mIndices = new unsigned int[2];
+                    f.mIndices = NewFaceIndices(m_arena, 2);
                 }
                 continue;
             }
@@ -367,7 +374,7 @@ aiMesh *ObjFileImporter::createTopology( const ObjFile::Model* pModel, const Obj
                 for(size_t i = 0; i < inp->m_vertices.size(); ++i) {
                     aiFace& f = pMesh->mFaces[ outIndex++ ];
                     uiIdxCount += f.mNumIndices = 1;
-                    f.mIndices = new unsigned int[1];
+                    f.mIndices = NewFaceIndices(m_arena, 1);
                 }
                 continue;
             }
@@ -376,7 +383,7 @@ aiMesh *ObjFileImporter::createTopology( const ObjFile::Model* pModel, const Obj
             const unsigned int uiNumIndices = (unsigned int) pObjMesh->m_Faces[ index ]->m_vertices.size();
             uiIdxCount += pFace->mNumIndices = (unsigned int) uiNumIndices;
             if (pFace->mNumIndices > 0) {
-                pFace->mIndices = new unsigned int[ uiNumIndices ];
+                pFace->mIndices = flat ? flat + ( outIndex - 1 ) * 3 : NewFaceIndices( m_arena, uiNumIndices );
             }
         }
     }
@@ -420,12 +427,16 @@ void ObjFileImporter::createVertexArray(const ObjFile::Model* pModel,
     if ( !pModel->m_Normals.empty() && pObjMesh->m_hasNormals )
         pMesh->mNormals = new aiVector3D[ pMesh->mNumVertices ];
 
+    // Trusted input keeps positions and normals only
+    const bool hasColors = !pModel->m_VertexColors.empty() && !m_trustedInput;
+    const bool hasTextureCoords = !pModel->m_TextureCoord.empty() && !m_trustedInput;
+
     // Allocate buffer for vertex-color vectors
-    if ( !pModel->m_VertexColors.empty() )
+    if ( hasColors )
         pMesh->mColors[0] = new aiColor4D[ pMesh->mNumVertices ];
 
     // Allocate buffer for texture coordinates
-    if ( !pModel->m_TextureCoord.empty() && pObjMesh->m_uiUVCoordinates[0] )
+    if ( hasTextureCoords && pObjMesh->m_uiUVCoordinates[0] )
     {
         pMesh->mNumUVComponents[ 0 ] = 2;
         pMesh->mTextureCoords[ 0 ] = new aiVector3D[ pMesh->mNumVertices ];
@@ -456,14 +467,14 @@ void ObjFileImporter::createVertexArray(const ObjFile::Model* pModel,
             }
 
             // Copy all vertex colors
-            if ( !pModel->m_VertexColors.empty())
+            if ( hasColors )
             {
                 const aiVector3D color = pModel->m_VertexColors[ vertex ];
                 pMesh->mColors[0][ newIndex ] = aiColor4D(color.x, color.y, color.z, 1.0);
             }
 
             // Copy all texture coordinates
-            if ( !pModel->m_TextureCoord.empty() && vertexIndex < pSourceFace->m_texturCoords.size())
+            if ( hasTextureCoords && vertexIndex < pSourceFace->m_texturCoords.size())
             {
                 const unsigned int tex = pSourceFace->m_texturCoords.at( vertexIndex );
                 ai_assert( tex < pModel->m_TextureCoord.size() );
@@ -503,7 +514,7 @@ void ObjFileImporter::createVertexArray(const ObjFile::Model* pModel,
                         if ( !pSourceFace->m_normals.empty() && !pModel->m_Normals.empty()) {
                             pMesh->mNormals[ newIndex+1 ] = pMesh->mNormals[newIndex ];
                         }
-                        if ( !pModel->m_TextureCoord.empty() ) {
+                        if ( hasTextureCoords ) {
                             for ( size_t i=0; i < pMesh->GetNumUVChannels(); i++ ) {
                                 pMesh->mTextureCoords[ i ][ newIndex+1 ] = pMesh->mTextureCoords[ i ][ newIndex ];
                             }
@@ -48,8 +48,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // internal headers
 #include "PlyLoader.h"
 #include "IOStreamBuffer.h"
+#include "SceneArena.h"
 #include "Macros.h"
 #include <memory>
+#include <algorithm>
 #include <assimp/IOSystem.hpp>
 #include <assimp/scene.h>
 #include <assimp/importerdesc.h>
@@ -151,6 +153,10 @@ static bool isBigEndian(const char* szMe) {
 void PLYImporter::InternReadFile(const std::string& pFile,
   aiScene* pScene, IOSystem* pIOHandler)
 {
+  // the mesh of a previous import is owned by its scene by now, make sure
+  // it isn't filled or deleted again when the importer instance is reused
+  mGeneratedMesh = NULL;
+
   static const std::string mode = "rb";
   std::unique_ptr<IOStream> fileStream(pIOHandler->Open(pFile, mode));
   if (!fileStream.get()) {
@@ -262,11 +268,12 @@ void PLYImporter::InternReadFile(const std::string& pFile,
     const unsigned int iNum = (unsigned int)mGeneratedMesh->mNumVertices / 3;
     mGeneratedMesh->mNumFaces = iNum;
     mGeneratedMesh->mFaces = new aiFace[mGeneratedMesh->mNumFaces];
+    unsigned int* flat = NewTriangleIndices(m_arena, mGeneratedMesh);
 
     for (unsigned int i = 0; i < iNum; ++i)
     {
       mGeneratedMesh->mFaces[i].mNumIndices = 3;
-      mGeneratedMesh->mFaces[i].mIndices = new unsigned int[3];
+      mGeneratedMesh->mFaces[i].mIndices = flat ? flat + i * 3 : new unsigned int[3];
       mGeneratedMesh->mFaces[i].mIndices[0] = (i * 3);
       mGeneratedMesh->mFaces[i].mIndices[1] = (i * 3) + 1;
       mGeneratedMesh->mFaces[i].mIndices[2] = (i * 3) + 2;
@@ -379,6 +386,12 @@ void PLYImporter::LoadVertex(const PLY::Element* pcElement, const PLY::ElementIn
         }
     }
 
+    // trusted input keeps positions and normals only
+    if (m_trustedInput) {
+        std::fill(aiColors, aiColors + 4, 0xFFFFFFFF);
+        std::fill(aiTexcoord, aiTexcoord + 2, 0xFFFFFFFF);
+    }
+
     // check whether we have a valid source for the vertex data
     if (0 != cnt) {
         // Position
@@ -583,8 +596,8 @@ void PLYImporter::LoadFace(const PLY::Element* pcElement, const PLY::ElementInst
       }*/
       else if (PLY::EST_TextureCoordinates == (*a).Semantic)
       {
-        // must be a dynamic list!
-        if (!(*a).bIsList)
+        // must be a dynamic list! not needed for trusted input
+        if (!(*a).bIsList || m_trustedInput)
           continue;
         iTextureCoord = _a;
         bOne = true;
@@ -627,7 +640,7 @@ void PLYImporter::LoadFace(const PLY::Element* pcElement, const PLY::ElementInst
       {
         const unsigned int iNum = (unsigned int)GetProperty(instElement->alProperties, iProperty).avList.size();
         mGeneratedMesh->mFaces[pos].mNumIndices = iNum;
-        mGeneratedMesh->mFaces[pos].mIndices = new unsigned int[iNum];
+        mGeneratedMesh->mFaces[pos].mIndices = NewFaceIndices(m_arena, iNum);
 
         std::vector<PLY::PropertyInstance::ValueUnion>::const_iterator p =
           GetProperty(instElement->alProperties, iProperty).avList.begin();
@@ -712,7 +725,7 @@ void PLYImporter::LoadFace(const PLY::Element* pcElement, const PLY::ElementInst
         }
 
         mGeneratedMesh->mFaces[pos].mNumIndices = 3;
-        mGeneratedMesh->mFaces[pos].mIndices = new unsigned int[3];
+        mGeneratedMesh->mFaces[pos].mIndices = NewFaceIndices(m_arena, 3);
         mGeneratedMesh->mFaces[pos].mIndices[0] = aiTable[0];
         mGeneratedMesh->mFaces[pos].mIndices[1] = aiTable[1];
         mGeneratedMesh->mFaces[pos].mIndices[2] = p;
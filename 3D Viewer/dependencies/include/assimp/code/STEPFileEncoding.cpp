@@ -44,7 +44,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "STEPFileEncoding.h"
 #include "fast_atof.h"
-#include <contrib/utf8cpp/source/utf8.h>
+#include <utfcpp-master/source/utf8.h>
+//#include <contrib/utf8cpp/source/utf8.h>
 
 #include <memory>
 
@@ -47,6 +47,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 // internal headers
 #include "STLLoader.h"
+#include "SceneArena.h"
 #include "ParsingUtils.h"
 #include "fast_atof.h"
 #include <memory>
@@ -158,13 +159,15 @@ const aiImporterDesc* STLImporter::GetInfo () const {
     return &desc;
 }
 
-void addFacesToMesh(aiMesh* pMesh)
+void addFacesToMesh(aiMesh* pMesh, SceneArena* arena)
 {
     pMesh->mFaces = new aiFace[pMesh->mNumFaces];
+    unsigned int* flat = NewTriangleIndices(arena, pMesh);
     for (unsigned int i = 0, p = 0; i < pMesh->mNumFaces;++i)    {
 
         aiFace& face = pMesh->mFaces[i];
-        face.mIndices = new unsigned int[face.mNumIndices = 3];
+        face.mNumIndices = 3;
+        face.mIndices = flat ? flat + p : new unsigned int[3];
         for (unsigned int o = 0; o < 3;++o,++p) {
             face.mIndices[o] = p;
         }
@@ -184,13 +187,18 @@ void STLImporter::InternReadFile( const std::string& pFile, aiScene* pScene, IOS
 
     fileSize = (unsigned int)file->FileSize();
 
-    // allocate storage and copy the contents of the file to a memory buffer
-    // (terminate it with zero)
+    // binary files are parsed straight out of a mapped stream, everything
+    // else is copied to a memory buffer (terminated with zero)
     std::vector<char> mBuffer2;
-    TextFileToBuffer(file.get(),mBuffer2);
+    const char* mapped = reinterpret_cast<const char*>(file->GetMappedData());
+    if (mapped && IsBinarySTL(mapped, fileSize)) {
+        this->mBuffer = mapped;
+    } else {
+        TextFileToBuffer(file.get(),mBuffer2);
+        this->mBuffer = &mBuffer2[0];
+    }
 
     this->pScene = pScene;
-    this->mBuffer = &mBuffer2[0];
 
     // the default vertex color is light gray.
     clrColorDefault.r = clrColorDefault.g = clrColorDefault.b = clrColorDefault.a = (ai_real) 0.6;
@@ -371,7 +379,7 @@ void STLImporter::LoadASCIIFile( aiNode *root ) {
         normalBuffer.clear();
 
         // now copy faces
-        addFacesToMesh(pMesh);
+        addFacesToMesh(pMesh, m_arena);
 
         // assign the meshes to the current node
         pushMeshesToNode( meshIndices, node );
@@ -470,7 +478,7 @@ bool STLImporter::LoadBinaryFile()
         uint16_t color = *((uint16_t*)sz);
         sz += 2;
 
-        if (color & (1 << 15))
+        if (color & (1 << 15) && !m_trustedInput)
         {
             // seems we need to take the color
             if (!pMesh->mColors[0])
@@ -504,7 +512,7 @@ bool STLImporter::LoadBinaryFile()
     }
 
     // now copy faces
-    addFacesToMesh(pMesh);
+    addFacesToMesh(pMesh, m_arena);
 
     // add all created meshes to the single node
     pScene->mRootNode->mNumMeshes = pScene->mNumMeshes;
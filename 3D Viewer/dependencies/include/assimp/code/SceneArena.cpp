@@ -0,0 +1,191 @@
+/*
+Open Asset Import Library (assimp)
+----------------------------------------------------------------------
+
+Copyright (c) 2006-2017, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the
+following conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+----------------------------------------------------------------------
+*/
+
+/** @file  SceneArena.cpp
+ *  @brief Implementation of the SceneArena monotonic allocator
+ */
+
+#include "SceneArena.h"
+#include <assimp/scene.h>
+#include <algorithm>
+#include <functional>
+
+using namespace Assimp;
+
+namespace {
+
+// Arena of the scene this thread is importing, post-processing or freeing
+thread_local const SceneArena* s_currentArena = NULL;
+
+const size_t MaxBlockSize = 16 * 1024 * 1024;
+
+}
+
+// ------------------------------------------------------------------------------------------------
+bool Assimp::IsArenaMemory( const void* p ) {
+    return NULL != p && NULL != s_currentArena && s_currentArena->Owns( p );
+}
+
+// ------------------------------------------------------------------------------------------------
+ArenaScope::ArenaScope( const SceneArena* arena )
+: mPrevious( s_currentArena ) {
+    if ( NULL != arena ) {
+        s_currentArena = arena;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+ArenaScope::~ArenaScope() {
+    s_currentArena = mPrevious;
+}
+
+// ------------------------------------------------------------------------------------------------
+SceneArena::SceneArena( size_t initialBlockSize )
+: mBlocks()
+, mCurrent( 0 )
+, mNextBlockSize( initialBlockSize )
+, mOffset( 0 )
+, mNumAllocations( 0 )
+, mBytesUsed( 0 ) {
+    // nothing to do here
+}
+
+// ------------------------------------------------------------------------------------------------
+SceneArena::~SceneArena() {
+    for ( size_t i = 0; i < mBlocks.size(); ++i ) {
+        delete[] mBlocks[ i ].mData;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+bool SceneArena::BlockBefore( const char* p, const Block& block ) {
+    return std::less<const char*>()( p, block.mData );
+}
+
+// ------------------------------------------------------------------------------------------------
+void SceneArena::AddBlock( size_t minSize ) {
+    Block block;
+    block.mSize = std::max( minSize, mNextBlockSize );
+    block.mData = new char[ block.mSize ];
+    mNextBlockSize = std::min( mNextBlockSize * 2, MaxBlockSize );
+    std::vector<Block>::iterator it = std::upper_bound( mBlocks.begin(), mBlocks.end(), block.mData, BlockBefore );
+    it = mBlocks.insert( it, block );
+    mCurrent = it - mBlocks.begin();
+    mOffset = 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+void* SceneArena::Allocate( size_t numBytes, size_t alignment ) {
+    size_t start = 0;
+    if ( !mBlocks.empty() ) {
+        start = ( mOffset + alignment - 1 ) & ~( alignment - 1 );
+    }
+    if ( mBlocks.empty() || start + numBytes > mBlocks[ mCurrent ].mSize ) {
+        // operator new[] storage is aligned for any fundamental type
+        AddBlock( numBytes );
+        start = 0;
+    }
+    mOffset = start + numBytes;
+    mBytesUsed += numBytes;
+    ++mNumAllocations;
+    return mBlocks[ mCurrent ].mData + start;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool SceneArena::Owns( const void* p ) const {
+    const char* c = static_cast<const char*>( p );
+    std::vector<Block>::const_iterator it = std::upper_bound( mBlocks.begin(), mBlocks.end(), c, BlockBefore );
+    if ( it == mBlocks.begin() ) {
+        return false;
+    }
+    --it;
+    return std::less<const char*>()( c, it->mData + it->mSize );
+}
+
+// ------------------------------------------------------------------------------------------------
+void SceneArena::UpdateTriangleIndices( aiScene* scene ) const {
+    if ( NULL == scene || NULL == scene->mMeshes ) {
+        return;
+    }
+
+    for ( unsigned int i = 0; i < scene->mNumMeshes; ++i ) {
+        aiMesh* mesh = scene->mMeshes[ i ];
+        if ( NULL == mesh || NULL == mesh->mTriangleIndices ) {
+            continue;
+        }
+
+        bool valid = Owns( mesh->mTriangleIndices ) && NULL != mesh->mFaces;
+        for ( unsigned int f = 0; valid && f < mesh->mNumFaces; ++f ) {
+            const aiFace& face = mesh->mFaces[ f ];
+            valid = 3 == face.mNumIndices && mesh->mTriangleIndices + f * 3 == face.mIndices;
+        }
+        if ( !valid ) {
+            mesh->mTriangleIndices = NULL;
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+void SceneArena::Release() {
+    if ( mBlocks.empty() ) {
+        return;
+    }
+
+    // Keep the biggest block around, the next import is likely of similar size
+    std::vector<Block>::iterator largest = mBlocks.begin();
+    for ( std::vector<Block>::iterator it = mBlocks.begin(); it != mBlocks.end(); ++it ) {
+        if ( it->mSize > largest->mSize ) {
+            largest = it;
+        }
+    }
+    const Block keep = *largest;
+    for ( std::vector<Block>::iterator it = mBlocks.begin(); it != mBlocks.end(); ++it ) {
+        if ( it->mData != keep.mData ) {
+            delete[] it->mData;
+        }
+    }
+    mBlocks.clear();
+    mBlocks.push_back( keep );
+    mCurrent = 0;
+    mOffset = 0;
+    mNumAllocations = 0;
+    mBytesUsed = 0;
+}
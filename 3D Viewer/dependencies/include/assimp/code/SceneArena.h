@@ -0,0 +1,169 @@
+/*
+Open Asset Import Library (assimp)
+----------------------------------------------------------------------
+
+Copyright (c) 2006-2017, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the
+following conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+----------------------------------------------------------------------
+*/
+
+/** @file  SceneArena.h
+ *  @brief Monotonic allocator for scene data built during import.
+ */
+#pragma once
+#ifndef AI_SCENEARENA_H_INC
+#define AI_SCENEARENA_H_INC
+
+#include <assimp/mesh.h>
+#include <vector>
+#include <cstddef>
+
+struct aiScene;
+
+namespace Assimp    {
+
+// ---------------------------------------------------------------------------
+/** @brief Monotonic (bump-pointer) allocator for import-time scene data.
+ *
+ *  Enabled through #AI_CONFIG_IMPORT_SCENE_ARENA. The Importer owns one
+ *  arena and hands it to the loaders, which use it for the small per-face
+ *  index arrays that otherwise cost one heap allocation per face. Pure
+ *  triangle meshes get one flat array instead (aiMesh::mTriangleIndices).
+ *  All memory is released in one shot by Importer::FreeScene().
+ *
+ *  Arena memory must never reach delete[]. aiFace checks IsArenaMemory()
+ *  before freeing its indices, which only looks at the arena of the scene
+ *  the calling thread is importing, post-processing or freeing (see
+ *  ArenaScope), so the check takes no lock and the public structs keep
+ *  their layout.
+ */
+class ASSIMP_API SceneArena {
+public:
+    explicit SceneArena( size_t initialBlockSize = 64 * 1024 );
+    ~SceneArena();
+
+    // -------------------------------------------------------------------
+    /** Returns uninitialized storage of the given size and alignment. */
+    void* Allocate( size_t numBytes, size_t alignment = sizeof( void* ) );
+
+    // -------------------------------------------------------------------
+    /** Returns uninitialized storage for count objects of a POD type. */
+    template <typename T>
+    T* AllocateArray( size_t count ) {
+        return static_cast<T*>( Allocate( count * sizeof( T ), alignof( T ) ) );
+    }
+
+    // -------------------------------------------------------------------
+    /** Checks whether a pointer lies in one of the blocks of this arena,
+     *  a binary search over the blocks ordered by address. */
+    bool Owns( const void* p ) const;
+
+    // -------------------------------------------------------------------
+    /** Drops aiMesh::mTriangleIndices of all meshes whose faces no
+     *  longer view the flat array, e.g. after a post-processing step
+     *  replaced or reordered the faces. */
+    void UpdateTriangleIndices( aiScene* scene ) const;
+
+    // -------------------------------------------------------------------
+    /** Frees all allocations at once. The largest block is kept for
+     *  the next import. */
+    void Release();
+
+    size_t GetNumAllocations() const { return mNumAllocations; }
+    size_t GetBytesUsed() const { return mBytesUsed; }
+    size_t GetNumBlocks() const { return mBlocks.size(); }
+
+private:
+    SceneArena( const SceneArena& );
+    SceneArena& operator = ( const SceneArena& );
+
+    void AddBlock( size_t minSize );
+
+    struct Block {
+        char* mData;
+        size_t mSize;
+    };
+    static bool BlockBefore( const char* p, const Block& block );
+
+    // Ordered by address, allocations come from mBlocks[ mCurrent ]
+    std::vector<Block> mBlocks;
+    size_t mCurrent;
+    size_t mNextBlockSize;
+    size_t mOffset;
+    size_t mNumAllocations;
+    size_t mBytesUsed;
+};
+
+// ---------------------------------------------------------------------------
+/** Makes an arena the one IsArenaMemory() checks on this thread for the
+ *  lifetime of the scope. The Importer opens one while it builds,
+ *  post-processes or frees a scene, ~aiScene for an orphaned scene that
+ *  took the arena along. A NULL arena keeps the current one. */
+class ASSIMP_API ArenaScope {
+public:
+    explicit ArenaScope( const SceneArena* arena );
+    ~ArenaScope();
+
+private:
+    ArenaScope( const ArenaScope& );
+    ArenaScope& operator = ( const ArenaScope& );
+
+    const SceneArena* mPrevious;
+};
+
+// ---------------------------------------------------------------------------
+/** Allocates a face index array, from the arena if one is active. */
+inline unsigned int* NewFaceIndices( SceneArena* arena, unsigned int numIndices ) {
+    if ( NULL != arena ) {
+        return arena->AllocateArray<unsigned int>( numIndices );
+    }
+    return new unsigned int[ numIndices ];
+}
+
+// ---------------------------------------------------------------------------
+/** Allocates the flat index array of a mesh made of mNumFaces triangles and
+ *  publishes it as aiMesh::mTriangleIndices. Face i must then use the
+ *  storage at offset 3 * i. Returns NULL if no arena is active. */
+inline unsigned int* NewTriangleIndices( SceneArena* arena, aiMesh* mesh ) {
+    if ( NULL == arena ) {
+        return NULL;
+    }
+    mesh->mTriangleIndices = arena->AllocateArray<unsigned int>( mesh->mNumFaces * 3 );
+    return mesh->mTriangleIndices;
+}
+
+} // Namespace Assimp
+
+#endif // AI_SCENEARENA_H_INC
@@ -1072,6 +1072,9 @@ void SceneCombiner::Copy( aiMesh** _dest, const aiMesh* src ) {
     // make a deep copy of all bones
     CopyPtrArray(dest->mBones,dest->mBones,dest->mNumBones);
 
+    // the copied faces own their indices, the flat array stays with the source
+    dest->mTriangleIndices = NULL;
+
     // make a deep copy of all faces
     GetArrayCopy(dest->mFaces,dest->mNumFaces);
     for (unsigned int i = 0; i < dest->mNumFaces;++i) {
@@ -101,6 +101,10 @@ void ScenePreprocessor::ProcessMesh (aiMesh* mesh)
             if (!mesh->mNumUVComponents[i])
                 mesh->mNumUVComponents[i] = 2;
 
+            // trusted loaders already wrote clean channels
+            if (trustedInput)
+                continue;
+
             aiVector3D* p = mesh->mTextureCoords[i], *end = p+mesh->mNumVertices;
 
             // Ensure unsued components are zeroed. This will make 1D texture channels work
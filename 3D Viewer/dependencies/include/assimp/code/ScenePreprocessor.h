@@ -73,12 +73,14 @@ public:
      */
     ScenePreprocessor()
         :   scene   (NULL)
+        ,   trustedInput (false)
     {}
 
     /** Constructs the object and assigns a specific scene to it
      */
     ScenePreprocessor(aiScene* _scene)
         :   scene   (_scene)
+        ,   trustedInput (false)
     {}
 
     // ----------------------------------------------------------------
@@ -92,6 +94,17 @@ public:
         scene = sc;
     }
 
+    // ----------------------------------------------------------------
+    /** Trust the loader's data and skip the per-vertex fix-ups.
+     *
+     *  Texture coordinates are then taken as declared instead of
+     *  being scanned and zeroed, see #AI_CONFIG_IMPORT_TRUSTED_INPUT.
+     *  @param trusted True to skip the fix-ups.
+     */
+    void SetTrustedInput (bool trusted) {
+        trustedInput = trusted;
+    }
+
     // ----------------------------------------------------------------
     /** Preprocess the current scene
      */
@@ -116,6 +129,9 @@ protected:
 
     //! Scene we're currently working on
     aiScene* scene;
+
+    //! Skip the per-vertex fix-ups
+    bool trustedInput;
 };
 
 
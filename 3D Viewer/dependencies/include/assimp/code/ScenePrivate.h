@@ -45,6 +45,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define AI_SCENEPRIVATE_H_INCLUDED
 
 #include <assimp/scene.h>
+#include "SceneArena.h"
 
 namespace Assimp    {
 
@@ -56,8 +57,13 @@ struct ScenePrivateData {
         : mOrigImporter()
         , mPPStepsApplied()
         , mIsCopy()
+        , mArena()
     {}
 
+    ~ScenePrivateData() {
+        delete mArena;
+    }
+
     // Importer that originally loaded the scene though the C-API
     // If set, this object is owned by this private data instance.
     Assimp::Importer* mOrigImporter;
@@ -71,6 +77,10 @@ struct ScenePrivateData {
     // and mOrigImporter are no longer safe to rely on and only
     // serve informative purposes.
     bool mIsCopy;
+
+    // Arena holding the face indices of a scene orphaned from an Importer
+    // that had #AI_CONFIG_IMPORT_SCENE_ARENA set. Owned by this instance.
+    SceneArena* mArena;
 };
 
 // Access private data stored in the scene
@@ -0,0 +1,339 @@
+/*
+---------------------------------------------------------------------------
+Open Asset Import Library (assimp)
+---------------------------------------------------------------------------
+
+Copyright (c) 2006-2017, assimp team
+
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the following
+conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+---------------------------------------------------------------------------
+*/
+/** @file Tracer.cpp
+ *  @brief Implementation of the per-thread ring buffer tracer
+ */
+
+#include <assimp/Tracer.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <map>
+#include <string>
+#include <stdio.h>
+#include <string.h>
+
+using namespace Assimp;
+using namespace Assimp::Profiling;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// ------------------------------------------------------------------------------------------------
+// One event, written by the owning thread only. Both words are atomics so a
+// concurrent Collect() reads them without a data race.
+struct TraceSlot {
+    std::atomic<uint64_t> time;
+    std::atomic<uint64_t> word;  // name << 32 | thread << 1 | begin
+};
+
+struct TraceRing {
+    std::atomic<uint64_t> reserved;  // bumped before a slot is overwritten
+    std::atomic<uint64_t> head;      // bumped once the slot is complete
+    std::atomic<uint64_t> start;     // first event not dropped by Clear()
+    std::atomic<bool> inUse;
+    TraceSlot slots[Tracer::RingSize];
+};
+
+// ------------------------------------------------------------------------------------------------
+// Rings outlive their threads: threads spawned per import would otherwise
+// allocate a new ring each time, so a finished thread's ring is handed to the
+// next one. The registry is never destroyed, threads may still be running at exit.
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<const char*> names;
+    std::vector<TraceRing*> rings;
+    std::map<unsigned int, std::string> threadNames;
+    unsigned int nextThread;
+    Clock::time_point epoch;
+
+    TraceRegistry()
+    : names(1, (const char*)NULL)
+    , nextThread(1)
+    , epoch(Clock::now()) {
+    }
+};
+
+TraceRegistry& GetRegistry() {
+    static TraceRegistry* registry = new TraceRegistry();
+    return *registry;
+}
+
+std::atomic<bool> gEnabled(false);
+
+// ------------------------------------------------------------------------------------------------
+struct ThreadState {
+    TraceRing* ring;
+    unsigned int thread;
+
+    ThreadState()
+    : ring(NULL)
+    , thread(0) {
+    }
+
+    ~ThreadState() {
+        if (ring) {
+            ring->inUse.store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadState gThread;
+
+unsigned int GetThreadId(TraceRegistry& registry) {
+    if (!gThread.thread) {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        gThread.thread = registry.nextThread++;
+    }
+    return gThread.thread;
+}
+
+TraceRing& GetRing() {
+    if (!gThread.ring) {
+        TraceRegistry& registry = GetRegistry();
+        GetThreadId(registry);
+
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (TraceRing* ring : registry.rings) {
+            if (!ring->inUse.load(std::memory_order_acquire)) {
+                gThread.ring = ring;
+                break;
+            }
+        }
+        if (!gThread.ring) {
+            gThread.ring = new TraceRing();
+            registry.rings.push_back(gThread.ring);
+        }
+        gThread.ring->inUse.store(true, std::memory_order_relaxed);
+    }
+    return *gThread.ring;
+}
+
+// ------------------------------------------------------------------------------------------------
+void Record(unsigned int name, bool begin) {
+    const uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - GetRegistry().epoch).count();
+    TraceRing& ring = GetRing();
+
+    const uint64_t index = ring.head.load(std::memory_order_relaxed);
+    ring.reserved.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    TraceSlot& slot = ring.slots[index & (Tracer::RingSize - 1)];
+    slot.time.store(time, std::memory_order_relaxed);
+    slot.word.store((uint64_t)name << 32 | (uint64_t)gThread.thread << 1 | (begin ? 1 : 0), std::memory_order_relaxed);
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+// ------------------------------------------------------------------------------------------------
+void WriteJSONString(FILE* file, const char* str) {
+    fputc('"', file);
+    for (; *str; ++str) {
+        if (*str == '"' || *str == '\\') {
+            fputc('\\', file);
+        }
+        if ((unsigned char)*str >= 0x20) {
+            fputc(*str, file);
+        }
+    }
+    fputc('"', file);
+}
+
+} // ! anon namespace
+
+// ------------------------------------------------------------------------------------------------
+TraceName::TraceName(const char* pName)
+{
+    TraceRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    // The same name at several sites is the same region
+    for (size_t i = 1; i < registry.names.size(); ++i) {
+        if (!strcmp(registry.names[i], pName)) {
+            mId = static_cast<unsigned int>(i);
+            return;
+        }
+    }
+    mId = static_cast<unsigned int>(registry.names.size());
+    registry.names.push_back(pName);
+}
+
+// ------------------------------------------------------------------------------------------------
+void Tracer::SetEnabled(bool pEnabled)
+{
+    gEnabled.store(pEnabled, std::memory_order_relaxed);
+}
+
+// ------------------------------------------------------------------------------------------------
+bool Tracer::IsEnabled()
+{
+    return gEnabled.load(std::memory_order_relaxed);
+}
+
+// ------------------------------------------------------------------------------------------------
+void Tracer::Begin(unsigned int pName)
+{
+    Record(pName, true);
+}
+
+// ------------------------------------------------------------------------------------------------
+void Tracer::End(unsigned int pName)
+{
+    Record(pName, false);
+}
+
+// ------------------------------------------------------------------------------------------------
+void Tracer::SetThreadName(const char* pName)
+{
+    TraceRegistry& registry = GetRegistry();
+    const unsigned int thread = GetThreadId(registry);
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.threadNames[thread] = pName;
+}
+
+// ------------------------------------------------------------------------------------------------
+void Tracer::Collect(std::vector<TraceEvent>& pEvents)
+{
+    TraceRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    for (TraceRing* ring : registry.rings) {
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t first = ring->start.load(std::memory_order_relaxed);
+        if (head - first > RingSize) {
+            first = head - RingSize;
+        }
+
+        const size_t offset = pEvents.size();
+        for (uint64_t i = first; i < head; ++i) {
+            const TraceSlot& slot = ring->slots[i & (RingSize - 1)];
+            const uint64_t word = slot.word.load(std::memory_order_relaxed);
+
+            TraceEvent event;
+            event.mTime = slot.time.load(std::memory_order_relaxed);
+            event.mName = static_cast<unsigned int>(word >> 32);
+            event.mThread = static_cast<unsigned int>(word & 0xffffffff) >> 1;
+            event.mBegin = (word & 1) != 0;
+            pEvents.push_back(event);
+        }
+
+        // Drop what the owning thread overwrote while we were copying
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t reserved = ring->reserved.load(std::memory_order_relaxed);
+        if (reserved > first + RingSize) {
+            const size_t torn = static_cast<size_t>(std::min(reserved - RingSize - first, head - first));
+            pEvents.erase(pEvents.begin() + offset, pEvents.begin() + offset + torn);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+void Tracer::Clear()
+{
+    TraceRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    for (TraceRing* ring : registry.rings) {
+        ring->start.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+const char* Tracer::GetName(unsigned int pName)
+{
+    TraceRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    return pName < registry.names.size() ? registry.names[pName] : NULL;
+}
+
+// ------------------------------------------------------------------------------------------------
+bool Tracer::WriteChromeTrace(const char* pFile)
+{
+    std::vector<TraceEvent> events;
+    Collect(events);
+
+    FILE* file = fopen(pFile, "w");
+    if (!file) {
+        return false;
+    }
+
+    TraceRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    // A wrapped ring may start in the middle of a region, skip ends without a begin
+    std::map<unsigned int, unsigned int> depth;
+    bool first = true;
+    fputs("{\"traceEvents\":[", file);
+    for (const TraceEvent& event : events) {
+        unsigned int& open = depth[event.mThread];
+        if (!event.mBegin) {
+            if (!open) {
+                continue;
+            }
+            --open;
+        }
+        else {
+            ++open;
+        }
+
+        fputs(first ? "\n{\"name\":" : ",\n{\"name\":", file);
+        first = false;
+        WriteJSONString(file, event.mName < registry.names.size() ? registry.names[event.mName] : "?");
+        fprintf(file, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}", event.mBegin ? 'B' : 'E',
+            event.mThread, event.mTime / 1000.0);
+    }
+    for (std::map<unsigned int, std::string>::const_iterator it = registry.threadNames.begin();
+            it != registry.threadNames.end(); ++it) {
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+            first ? "" : ",", it->first);
+        first = false;
+        WriteJSONString(file, it->second.c_str());
+        fputs("}}", file);
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+
+    return fclose(file) == 0;
+}
@@ -62,6 +62,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "TriangulateProcess.h"
 #include "ProcessHelper.h"
 #include "PolyTools.h"
+#include <assimp/Tracer.h>
 #include <memory>
 
 //#define AI_BUILD_TRIANGULATE_COLOR_FACE_WINDING
@@ -99,6 +100,7 @@ bool TriangulateProcess::IsActive( unsigned int pFlags) const
 // Executes the post processing step on the given imported data.
 void TriangulateProcess::Execute( aiScene* pScene)
 {
+    ASSIMP_TRACE_SCOPE("Triangulate");
     DefaultLogger::get()->debug("TriangulateProcess begin");
 
     bool bHas = false;
@@ -490,7 +492,9 @@ bool TriangulateProcess::TriangulateMesh( aiMesh* pMesh)
                 DefaultLogger::get()->debug("Dropping triangle with area 0");
                 --curOut;
 
-                delete[] f->mIndices;
+                if (!IsArenaMemory(f->mIndices)) {
+                    delete[] f->mIndices;
+                }
                 f->mIndices = NULL;
 
                 for(aiFace* ff = f; ff != curOut; ++ff) {
@@ -507,7 +511,9 @@ bool TriangulateProcess::TriangulateMesh( aiMesh* pMesh)
             ++f;
         }
 
-        delete[] face.mIndices;
+        if (!IsArenaMemory(face.mIndices)) {
+            delete[] face.mIndices;
+        }
         face.mIndices = NULL;
     }
 
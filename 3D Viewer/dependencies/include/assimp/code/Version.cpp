@@ -133,6 +133,10 @@ ASSIMP_API aiScene::aiScene()
 
 // ------------------------------------------------------------------------------------------------
 ASSIMP_API aiScene::~aiScene() {
+    // arena memory is freed with the private data, not by the faces
+    Assimp::ScenePrivateData* priv = static_cast<Assimp::ScenePrivateData*>( mPrivate );
+    Assimp::ArenaScope arenaScope( priv ? priv->mArena : NULL );
+
     // delete all sub-objects recursively
     delete mRootNode;
 
@@ -378,10 +378,9 @@ inline void Buffer::Read(Value& obj, Asset& r)
         if (byteLength > 0) {
             std::string dir = !r.mCurrentAssetDir.empty() ? (r.mCurrentAssetDir + "/") : "";
 
-            IOStream* file = r.OpenFile(dir + uri, "rb");
+            shared_ptr<IOStream> file(r.OpenFile(dir + uri, "rb"));
             if (file) {
-                bool ok = LoadFromStream(*file, byteLength);
-                delete file;
+                bool ok = MapFromStream(file, byteLength);
 
                 if (!ok)
                     throw DeadlyImportError("GLTF: error while reading referenced file \"" + std::string(uri) + "\"" );
@@ -409,6 +408,23 @@ inline bool Buffer::LoadFromStream(IOStream& stream, size_t length, size_t baseO
     return true;
 }
 
+inline bool Buffer::MapFromStream(shared_ptr<IOStream> stream, size_t length, size_t baseOffset)
+{
+    const uint8_t* mapped = stream->GetMappedData();
+    if (!mapped) {
+        return LoadFromStream(*stream, length, baseOffset);
+    }
+
+    byteLength = length ? length : stream->FileSize();
+    if (baseOffset > stream->FileSize() || byteLength > stream->FileSize() - baseOffset) {
+        return false;
+    }
+
+    // alias the mapping, the deleter only drops our reference to the stream
+    mData.reset(const_cast<uint8_t*>(mapped) + baseOffset, [stream](uint8_t*) {});
+    return true;
+}
+
 inline void Buffer::EncodedRegion_Mark(const size_t pOffset, const size_t pEncodedData_Length, uint8_t* pDecodedData, const size_t pDecodedData_Length, const std::string& pID)
 {
 	// Check pointer to data
@@ -1156,7 +1172,7 @@ inline void Asset::Load(const std::string& pFile, bool isBinary)
 
     // Fill the buffer instance for the current file embedded contents
     if (mBodyLength > 0) {
-        if (!mBodyBuffer->LoadFromStream(*stream, mBodyLength, mBodyOffset)) {
+        if (!mBodyBuffer->MapFromStream(stream, mBodyLength, mBodyOffset)) {
             throw DeadlyImportError("GLTF: Unable to read gltf file");
         }
     }
@@ -44,14 +44,23 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "glTF2Importer.h"
 #include "StringComparison.h"
 #include "StringUtils.h"
+#include "SceneArena.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/ai_assert.h>
 #include <assimp/DefaultLogger.hpp>
 #include <assimp/importerdesc.h>
+#include <assimp/Tracer.h>
 
 #include <memory>
+#include <algorithm>
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+#   include <thread>
+#   include <mutex>
+#   include <atomic>
+#   include <exception>
+#endif
 
 #include "MakeVerboseFormat.h"
 
@@ -214,6 +223,10 @@ inline void SetMaterialTextureProperty(std::vector<int>& embeddedTexIdxs, Asset&
 void glTF2Importer::ImportMaterials(glTF2::Asset& r)
 {
     mScene->mNumMaterials = unsigned(r.materials.Size());
+    if (!mScene->mNumMaterials) {
+        // the ScenePreprocessor adds the default material
+        return;
+    }
     mScene->mMaterials = new aiMaterial*[mScene->mNumMaterials];
 
     for (unsigned int i = 0; i < mScene->mNumMaterials; ++i) {
@@ -272,25 +285,25 @@ void glTF2Importer::ImportMaterials(glTF2::Asset& r)
 }
 
 
-static inline void SetFace(aiFace& face, int a)
+static inline void SetFace(SceneArena* arena, aiFace& face, int a)
 {
     face.mNumIndices = 1;
-    face.mIndices = new unsigned int[1];
+    face.mIndices = NewFaceIndices(arena, 1);
     face.mIndices[0] = a;
 }
 
-static inline void SetFace(aiFace& face, int a, int b)
+static inline void SetFace(SceneArena* arena, aiFace& face, int a, int b)
 {
     face.mNumIndices = 2;
-    face.mIndices = new unsigned int[2];
+    face.mIndices = NewFaceIndices(arena, 2);
     face.mIndices[0] = a;
     face.mIndices[1] = b;
 }
 
-static inline void SetFace(aiFace& face, int a, int b, int c)
+static inline void SetFace(SceneArena* arena, aiFace& face, int a, int b, int c)
 {
     face.mNumIndices = 3;
-    face.mIndices = new unsigned int[3];
+    face.mIndices = NewFaceIndices(arena, 3);
     face.mIndices[0] = a;
     face.mIndices[1] = b;
     face.mIndices[2] = c;
@@ -310,9 +323,83 @@ static inline bool CheckValidFacesIndices(aiFace* faces, unsigned nFaces, unsign
 }
 #endif // ASSIMP_BUILD_DEBUG
 
+// Decodes the vertex attributes of a primitive, plus its indices if it is a triangle list.
+// Only touches the given mesh, so primitives can be decoded concurrently. The flat index
+// array of a triangle list must have been allocated beforehand, the arena is not thread-safe.
+static void ImportPrimitiveData(Mesh::Primitive& prim, aiMesh* aim, bool trustedInput)
+{
+    ASSIMP_TRACE_SCOPE("glTF2 primitive");
+    Mesh::Primitive::Attributes& attr = prim.attributes;
+
+    if (attr.position.size() > 0 && attr.position[0]) {
+        attr.position[0]->ExtractData(aim->mVertices);
+    }
+
+    if (attr.normal.size() > 0 && attr.normal[0]) {
+        attr.normal[0]->ExtractData(aim->mNormals);
+
+        // only extract tangents if normals are present
+        if (attr.tangent.size() > 0 && attr.tangent[0] && !trustedInput) {
+            // generate bitangents from normals and tangents according to spec
+            struct Tangent
+            {
+                aiVector3D xyz;
+                ai_real w;
+            } *tangents = nullptr;
+
+            attr.tangent[0]->ExtractData(tangents);
+
+            aim->mTangents = new aiVector3D[aim->mNumVertices];
+            aim->mBitangents = new aiVector3D[aim->mNumVertices];
+
+            for (unsigned int i = 0; i < aim->mNumVertices; ++i) {
+                aim->mTangents[i] = tangents[i].xyz;
+                aim->mBitangents[i] = (aim->mNormals[i] ^ tangents[i].xyz) * tangents[i].w;
+            }
+
+            delete tangents;
+        }
+    }
+
+    const size_t numTexcoords = trustedInput ? 0 : attr.texcoord.size();
+    for (size_t tc = 0; tc < numTexcoords && tc < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++tc) {
+        attr.texcoord[tc]->ExtractData(aim->mTextureCoords[tc]);
+        aim->mNumUVComponents[tc] = attr.texcoord[tc]->GetNumComponents();
+
+        aiVector3D* values = aim->mTextureCoords[tc];
+        for (unsigned int i = 0; i < aim->mNumVertices; ++i) {
+            values[i].y = 1 - values[i].y; // Flip Y coords
+        }
+    }
+
+    if (prim.indices && prim.mode == PrimitiveMode_TRIANGLES) {
+        Accessor::Indexer data = prim.indices->GetIndexer();
+        ai_assert(data.IsValid());
+
+        const unsigned int nFaces = aim->mNumFaces;
+        aiFace* faces = aim->mFaces;
+        if (unsigned int* flat = aim->mTriangleIndices) {
+            for (unsigned int i = 0; i < nFaces * 3; ++i) {
+                flat[i] = data.GetUInt(i);
+            }
+            for (unsigned int i = 0; i < nFaces; ++i) {
+                faces[i].mNumIndices = 3;
+                faces[i].mIndices = flat + i * 3;
+            }
+        }
+        else {
+            for (unsigned int i = 0; i < nFaces; ++i) {
+                SetFace(NULL, faces[i], data.GetUInt(i * 3), data.GetUInt(i * 3 + 1), data.GetUInt(i * 3 + 2));
+            }
+        }
+        ai_assert(CheckValidFacesIndices(faces, nFaces, aim->mNumVertices));
+    }
+}
+
 void glTF2Importer::ImportMeshes(glTF2::Asset& r)
 {
     std::vector<aiMesh*> meshes;
+    std::vector<Mesh::Primitive*> primitives;
 
     unsigned int k = 0;
 
@@ -327,6 +414,7 @@ void glTF2Importer::ImportMeshes(glTF2::Asset& r)
 
             aiMesh* aim = new aiMesh();
             meshes.push_back(aim);
+            primitives.push_back(&prim);
 
             aim->mName = mesh.name.empty() ? mesh.id : mesh.name;
 
@@ -359,131 +447,158 @@ void glTF2Importer::ImportMeshes(glTF2::Asset& r)
 
             if (attr.position.size() > 0 && attr.position[0]) {
                 aim->mNumVertices = attr.position[0]->count;
-                attr.position[0]->ExtractData(aim->mVertices);
             }
 
-            if (attr.normal.size() > 0 && attr.normal[0]) {
-                attr.normal[0]->ExtractData(aim->mNormals);
-
-                // only extract tangents if normals are present
-                if (attr.tangent.size() > 0 && attr.tangent[0]) {
-                    // generate bitangents from normals and tangents according to spec
-                    struct Tangent
-                    {
-                        aiVector3D xyz;
-                        ai_real w;
-                    } *tangents = nullptr;
-
-                    attr.tangent[0]->ExtractData(tangents);
+            // triangle lists are decoded along with the attributes below, allocate
+            // their faces here so the arena is only used from this thread
+            if (prim.indices && prim.mode == PrimitiveMode_TRIANGLES) {
+                aim->mNumFaces = prim.indices->count / 3;
+                aim->mFaces = new aiFace[aim->mNumFaces];
+                NewTriangleIndices(m_arena, aim);
+            }
 
-                    aim->mTangents = new aiVector3D[aim->mNumVertices];
-                    aim->mBitangents = new aiVector3D[aim->mNumVertices];
+            if (prim.material) {
+                aim->mMaterialIndex = prim.material.GetIndex();
+            }
+        }
+    }
 
-                    for (unsigned int i = 0; i < aim->mNumVertices; ++i) {
-                        aim->mTangents[i] = tangents[i].xyz;
-                        aim->mBitangents[i] = (aim->mNormals[i] ^ tangents[i].xyz) * tangents[i].w;
-                    }
+    meshOffsets.push_back(k);
 
-                    delete tangents;
+    // Copying the accessors is the bulk of the work, and each primitive only
+    // writes to its own mesh. Large files spread the primitives over threads.
+#ifndef ASSIMP_BUILD_SINGLETHREADED
+    size_t numVertices = 0, numThreads = 1;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        numVertices += meshes[i]->mNumVertices;
+    }
+    if (numVertices >= 65536) {
+        numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), primitives.size());
+    }
+    if (numThreads > 1) {
+        std::atomic<size_t> next(0);
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        auto worker = [&]() {
+            try {
+                for (size_t i = next++; i < primitives.size(); i = next++) {
+                    ImportPrimitiveData(*primitives[i], meshes[i], m_trustedInput);
                 }
             }
-
-            for (size_t tc = 0; tc < attr.texcoord.size() && tc < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++tc) {
-                attr.texcoord[tc]->ExtractData(aim->mTextureCoords[tc]);
-                aim->mNumUVComponents[tc] = attr.texcoord[tc]->GetNumComponents();
-
-                aiVector3D* values = aim->mTextureCoords[tc];
-                for (unsigned int i = 0; i < aim->mNumVertices; ++i) {
-                    values[i].y = 1 - values[i].y; // Flip Y coords
+            catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
                 }
             }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < numThreads; ++t) {
+            threads.push_back(std::thread([&]() {
+                Profiling::Tracer::SetThreadName("glTF2 primitives");
+                worker();
+            }));
+        }
+        worker();
+        for (size_t t = 0; t < threads.size(); ++t) {
+            threads[t].join();
+        }
+        if (error) {
+            CopyVector(meshes, mScene->mMeshes, mScene->mNumMeshes);
+            std::rethrow_exception(error);
+        }
+    }
+    else
+#endif
+    {
+        for (size_t i = 0; i < primitives.size(); ++i) {
+            ImportPrimitiveData(*primitives[i], meshes[i], m_trustedInput);
+        }
+    }
 
+    // Strips, fans, lines and points build their faces one by one from the arena
+    for (size_t i = 0; i < primitives.size(); ++i) {
+        Mesh::Primitive& prim = *primitives[i];
+        aiMesh* aim = meshes[i];
 
-            if (prim.indices) {
-                aiFace* faces = 0;
-                unsigned int nFaces = 0;
+        if (prim.indices && prim.mode != PrimitiveMode_TRIANGLES) {
+            aiFace* faces = 0;
+            unsigned int nFaces = 0;
 
-                unsigned int count = prim.indices->count;
+            unsigned int count = prim.indices->count;
 
-                Accessor::Indexer data = prim.indices->GetIndexer();
-                ai_assert(data.IsValid());
+            Accessor::Indexer data = prim.indices->GetIndexer();
+            ai_assert(data.IsValid());
 
-                switch (prim.mode) {
-                    case PrimitiveMode_POINTS: {
-                        nFaces = count;
-                        faces = new aiFace[nFaces];
-                        for (unsigned int i = 0; i < count; ++i) {
-                            SetFace(faces[i], data.GetUInt(i));
-                        }
-                        break;
+            switch (prim.mode) {
+                case PrimitiveMode_POINTS: {
+                    nFaces = count;
+                    faces = new aiFace[nFaces];
+                    for (unsigned int i = 0; i < count; ++i) {
+                        SetFace(m_arena, faces[i], data.GetUInt(i));
                     }
+                    break;
+                }
 
-                    case PrimitiveMode_LINES: {
-                        nFaces = count / 2;
-                        faces = new aiFace[nFaces];
-                        for (unsigned int i = 0; i < count; i += 2) {
-                            SetFace(faces[i / 2], data.GetUInt(i), data.GetUInt(i + 1));
-                        }
-                        break;
+                case PrimitiveMode_LINES: {
+                    nFaces = count / 2;
+                    faces = new aiFace[nFaces];
+                    for (unsigned int i = 0; i < count; i += 2) {
+                        SetFace(m_arena, faces[i / 2], data.GetUInt(i), data.GetUInt(i + 1));
                     }
+                    break;
+                }
 
-                    case PrimitiveMode_LINE_LOOP:
-                    case PrimitiveMode_LINE_STRIP: {
-                        nFaces = count - ((prim.mode == PrimitiveMode_LINE_STRIP) ? 1 : 0);
-                        faces = new aiFace[nFaces];
-                        SetFace(faces[0], data.GetUInt(0), data.GetUInt(1));
-                        for (unsigned int i = 2; i < count; ++i) {
-                            SetFace(faces[i - 1], faces[i - 2].mIndices[1], data.GetUInt(i));
-                        }
-                        if (prim.mode == PrimitiveMode_LINE_LOOP) { // close the loop
-                            SetFace(faces[count - 1], faces[count - 2].mIndices[1], faces[0].mIndices[0]);
-                        }
-                        break;
+                case PrimitiveMode_LINE_LOOP:
+                case PrimitiveMode_LINE_STRIP: {
+                    nFaces = count - ((prim.mode == PrimitiveMode_LINE_STRIP) ? 1 : 0);
+                    faces = new aiFace[nFaces];
+                    SetFace(m_arena, faces[0], data.GetUInt(0), data.GetUInt(1));
+                    for (unsigned int i = 2; i < count; ++i) {
+                        SetFace(m_arena, faces[i - 1], faces[i - 2].mIndices[1], data.GetUInt(i));
+                    }
+                    if (prim.mode == PrimitiveMode_LINE_LOOP) { // close the loop
+                        SetFace(m_arena, faces[count - 1], faces[count - 2].mIndices[1], faces[0].mIndices[0]);
                     }
+                    break;
+                }
 
-                    case PrimitiveMode_TRIANGLES: {
-                        nFaces = count / 3;
-                        faces = new aiFace[nFaces];
-                        for (unsigned int i = 0; i < count; i += 3) {
-                            SetFace(faces[i / 3], data.GetUInt(i), data.GetUInt(i + 1), data.GetUInt(i + 2));
+                case PrimitiveMode_TRIANGLE_STRIP: {
+                    nFaces = count - 2;
+                    faces = new aiFace[nFaces];
+                    for (unsigned int i = 0; i < nFaces; ++i) {
+                        // every second triangle is flipped to keep the orientation
+                        if (i % 2) {
+                            SetFace(m_arena, faces[i], data.GetUInt(i + 1), data.GetUInt(i), data.GetUInt(i + 2));
                         }
-                        break;
-                    }
-                    case PrimitiveMode_TRIANGLE_STRIP: {
-                        nFaces = count - 2;
-                        faces = new aiFace[nFaces];
-                        SetFace(faces[0], data.GetUInt(0), data.GetUInt(1), data.GetUInt(2));
-                        for (unsigned int i = 3; i < count; ++i) {
-                            SetFace(faces[i - 2], faces[i - 1].mIndices[1], faces[i - 1].mIndices[2], data.GetUInt(i));
+                        else {
+                            SetFace(m_arena, faces[i], data.GetUInt(i), data.GetUInt(i + 1), data.GetUInt(i + 2));
                         }
-                        break;
                     }
-                    case PrimitiveMode_TRIANGLE_FAN:
-                        nFaces = count - 2;
-                        faces = new aiFace[nFaces];
-                        SetFace(faces[0], data.GetUInt(0), data.GetUInt(1), data.GetUInt(2));
-                        for (unsigned int i = 3; i < count; ++i) {
-                            SetFace(faces[i - 2], faces[0].mIndices[0], faces[i - 1].mIndices[2], data.GetUInt(i));
-                        }
-                        break;
+                    break;
                 }
+                case PrimitiveMode_TRIANGLE_FAN:
+                    nFaces = count - 2;
+                    faces = new aiFace[nFaces];
+                    SetFace(m_arena, faces[0], data.GetUInt(0), data.GetUInt(1), data.GetUInt(2));
+                    for (unsigned int i = 1; i < nFaces; ++i) {
+                        SetFace(m_arena, faces[i], faces[0].mIndices[0], faces[i - 1].mIndices[2], data.GetUInt(i + 2));
+                    }
+                    break;
 
-                if (faces) {
-                    aim->mFaces = faces;
-                    aim->mNumFaces = nFaces;
-                    ai_assert(CheckValidFacesIndices(faces, nFaces, aim->mNumVertices));
-                }
+                default:
+                    break;
             }
 
-
-            if (prim.material) {
-                aim->mMaterialIndex = prim.material.GetIndex();
+            if (faces) {
+                aim->mFaces = faces;
+                aim->mNumFaces = nFaces;
+                ai_assert(CheckValidFacesIndices(faces, nFaces, aim->mNumVertices));
             }
         }
     }
 
-    meshOffsets.push_back(k);
-
     CopyVector(meshes, mScene->mMeshes, mScene->mNumMeshes);
 }
 
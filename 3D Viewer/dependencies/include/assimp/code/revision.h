@@ -0,0 +1,8 @@
+#ifndef ASSIMP_REVISION_H_INC
+#define ASSIMP_REVISION_H_INC
+
+// Normally generated by assimp's own build, which the viewer does not use
+#define GitVersion 0x0
+#define GitBranch "master"
+
+#endif // ASSIMP_REVISION_H_INC
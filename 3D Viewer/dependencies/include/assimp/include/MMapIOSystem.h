@@ -0,0 +1,138 @@
+/*
+Open Asset Import Library (assimp)
+----------------------------------------------------------------------
+
+Copyright (c) 2006-2017, assimp team
+
+All rights reserved.
+
+Redistribution and use of this software in source and binary forms,
+with or without modification, are permitted provided that the
+following conditions are met:
+
+* Redistributions of source code must retain the above
+  copyright notice, this list of conditions and the
+  following disclaimer.
+
+* Redistributions in binary form must reproduce the above
+  copyright notice, this list of conditions and the
+  following disclaimer in the documentation and/or other
+  materials provided with the distribution.
+
+* Neither the name of the assimp team, nor the names of its
+  contributors may be used to endorse or promote products
+  derived from this software without specific prior
+  written permission of the assimp team.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+----------------------------------------------------------------------
+*/
+
+/** @file Implementation of IOSystem that maps files into memory for reading */
+#ifndef AI_MMAPIOSYSTEM_H_INC
+#define AI_MMAPIOSYSTEM_H_INC
+
+#include <assimp/DefaultIOSystem.h>
+#include <assimp/IOStream.hpp>
+#include <string>
+
+namespace Assimp    {
+
+// ----------------------------------------------------------------------------------
+//! @class  MMapIOStream
+//! @brief  Read-only IO implementation on top of a memory-mapped file.
+//!
+//! The whole file is mapped copy-on-write when the stream is opened, Read()
+//! is a plain memcpy out of the mapping and GetMappedData() hands out the
+//! mapping itself so importers can parse in place.
+class ASSIMP_API MMapIOStream : public IOStream
+{
+    friend class MMapIOSystem;
+
+protected:
+    MMapIOStream(const uint8_t* pData, size_t pLength,
+        const std::string &strFilename);
+
+public:
+    /** Destructor public to allow simple deletion to unmap the file. */
+    ~MMapIOStream();
+
+    // -------------------------------------------------------------------
+    /// Read from stream
+    size_t Read(void* pvBuffer,
+        size_t pSize,
+        size_t pCount);
+
+    // -------------------------------------------------------------------
+    /// Write to stream, always fails
+    size_t Write(const void* pvBuffer,
+        size_t pSize,
+        size_t pCount);
+
+    // -------------------------------------------------------------------
+    /// Seek specific position
+    aiReturn Seek(size_t pOffset,
+        aiOrigin pOrigin);
+
+    // -------------------------------------------------------------------
+    /// Get current seek position
+    size_t Tell() const;
+
+    // -------------------------------------------------------------------
+    /// Get size of file
+    size_t FileSize() const;
+
+    // -------------------------------------------------------------------
+    /// Flush file contents, no-op
+    void Flush();
+
+    // -------------------------------------------------------------------
+    /// Get the mapped file contents
+    const uint8_t* GetMappedData() const;
+
+private:
+    //  Start of the mapping
+    const uint8_t* mData;
+    //  Size of the mapping (== file size)
+    size_t mLength;
+    //  Current read position
+    size_t mPos;
+    //  Filename
+    std::string mFilename;
+};
+
+// ---------------------------------------------------------------------------
+/** Implementation of IOSystem that memory-maps files opened for reading.
+ *
+ *  Files opened in a read mode are mapped as a whole and returned as
+ *  MMapIOStream, everything else (write modes, empty files, mapping
+ *  failures) falls back to the DefaultIOSystem behaviour. Install it with
+ *  Importer::SetIOHandler(). */
+class ASSIMP_API MMapIOSystem : public DefaultIOSystem
+{
+public:
+    /** Constructor. */
+    MMapIOSystem();
+
+    /** Destructor. */
+    ~MMapIOSystem();
+
+    // -------------------------------------------------------------------
+    /** Open a new file with a given path. */
+    IOStream* Open( const char* pFile, const char* pMode = "rb");
+};
+
+} //!ns Assimp
+
+#endif //AI_MMAPIOSYSTEM_H_INC
@@ -68,10 +68,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // ---------------------------------------------------------------------------
 /** @brief Enables time measurements.
  *
- *  If enabled, measures the time needed for each part of the loading
- *  process (i.e. IO time, importing, postprocessing, ..) and dumps
- *  these timings to the DefaultLogger. See the @link perf Performance
- *  Page@endlink for more information on this topic.
+ *  If enabled, turns on the process-wide Profiling::Tracer (see Tracer.h),
+ *  which records each part of the loading process (importing, validation,
+ *  preprocessing, the individual post-processing steps, ..) per thread.
+ *  Use Tracer::WriteChromeTrace() to save the timings for a trace viewer.
  *
  * Property type: bool. Default value: false.
  */
@@ -79,6 +79,34 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     "GLOB_MEASURE_TIME"
 
 
+// ---------------------------------------------------------------------------
+/** @brief Allocates per-face index arrays from a monotonic arena.
+ *
+ * Instead of one heap allocation per face, loaders that support it (STL,
+ * OBJ, PLY, glTF2) carve the index arrays out of a few large blocks owned
+ * by the Importer. The blocks are released in one go by
+ * Importer::FreeScene(), which makes importing and freeing large meshes
+ * much cheaper. Pure triangle meshes additionally get a flat index array,
+ * see aiMesh::mTriangleIndices.
+ * Property type: bool. Default value: false.
+ */
+#define AI_CONFIG_IMPORT_SCENE_ARENA \
+    "IMPORT_SCENE_ARENA"
+
+// ---------------------------------------------------------------------------
+/** @brief Treats the input as trusted and imports only the bare geometry.
+ *
+ * Meant for files from a known-good pipeline where the consumer only
+ * reads positions, normals and faces. Full validation is skipped even if
+ * #aiProcess_ValidateDataStructure is requested, the ScenePreprocessor
+ * no longer rewrites texture coordinates and the STL, OBJ, PLY and glTF2
+ * loaders drop vertex colors, texture coordinates and tangents.
+ * Malformed files are not caught and may crash the importer.
+ * Property type: bool. Default value: false.
+ */
+#define AI_CONFIG_IMPORT_TRUSTED_INPUT \
+    "IMPORT_TRUSTED_INPUT"
+
 // ---------------------------------------------------------------------------
 /** @brief Global setting to disable generation of skeleton dummy meshes
  *
@@ -384,6 +412,39 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #define AI_CONFIG_PP_ICL_PTCACHE_SIZE   "PP_ICL_PTCACHE_SIZE"
 
+/** @brief Default value for the #AI_CONFIG_PP_ICL_OVERDRAW_THRESHOLD property
+ */
+#ifndef PP_ICL_OVERDRAW_THRESHOLD
+#   define PP_ICL_OVERDRAW_THRESHOLD 1.05f
+#endif
+
+// ---------------------------------------------------------------------------
+/** @brief Set how much ACMR the #aiProcess_ImproveCacheLocality step may
+ *    give up to reduce overdraw.
+ *
+ * After the vertex cache pass the triangles are split into clusters, which
+ * are then sorted so that clusters likely to occlude others are drawn first.
+ * Smaller clusters sort better but start with a cold cache. A cluster is
+ * closed as soon as its own ACMR drops below this factor times the ACMR of
+ * the whole mesh. Values below 1 disable the overdraw pass.
+ * @note The default value is #PP_ICL_OVERDRAW_THRESHOLD.
+ * Property type: float.
+ */
+#define AI_CONFIG_PP_ICL_OVERDRAW_THRESHOLD   "PP_ICL_OVERDRAW_THRESHOLD"
+
+// ---------------------------------------------------------------------------
+/** @brief Log the ACMR and ATVR of the #aiProcess_ImproveCacheLocality step
+ *    at info level.
+ *
+ * The step then simulates the vertex cache before and after reordering each
+ * mesh, two extra passes over its indices. Verbose loggers always get these
+ * numbers, and the overdraw as well, which rasterizes every mesh twice from
+ * six directions.
+ * @note The default value is false.
+ * Property type: bool.
+ */
+#define AI_CONFIG_PP_ICL_LOG_ACMR   "PP_ICL_LOG_ACMR"
+
 // ---------------------------------------------------------------------------
 /** @brief Enumerates components of the aiScene and aiMesh data structures
  *  that can be excluded from the import using the #aiProcess_RemoveComponent step.
@@ -50,6 +50,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "types.h"
 
 #ifdef __cplusplus
+namespace Assimp {
+    // Returns true if p was allocated from the SceneArena of the scene this
+    // thread is importing, post-processing or freeing, and therefore must
+    // not be passed to delete[]. Defined in SceneArena.cpp.
+    ASSIMP_API bool IsArenaMemory( const void* p );
+}
+
 extern "C" {
 #endif
 
@@ -141,10 +148,12 @@ struct aiFace
     {
     }
 
-    //! Default destructor. Delete the index array
+    //! Default destructor. Delete the index array, unless it is
+    //! owned by the scene arena of the importer
     ~aiFace()
     {
-        delete [] mIndices;
+        if (!Assimp::IsArenaMemory(mIndices))
+            delete [] mIndices;
     }
 
     //! Copy constructor. Copy the index array
@@ -160,7 +169,8 @@ struct aiFace
         if (&o == this)
             return *this;
 
-        delete[] mIndices;
+        if (!Assimp::IsArenaMemory(mIndices))
+            delete[] mIndices;
         mNumIndices = o.mNumIndices;
         if (mNumIndices) {
             mIndices = new unsigned int[mNumIndices];
@@ -640,6 +650,14 @@ struct aiMesh
      *  Method of morphing when animeshes are specified. 
      */
     unsigned int mMethod;
+
+    /** Optional flat index array of a pure triangle mesh, 3 * mNumFaces
+    * in size. If present, every face views its indices in this array,
+    * i.e. mFaces[i].mIndices == mTriangleIndices + 3 * i, so the array can
+    * be uploaded as index buffer in one go. The storage belongs to the
+    * scene arena (see #AI_CONFIG_IMPORT_SCENE_ARENA). NULL if not present.
+    */
+    unsigned int* mTriangleIndices;
 	
 #ifdef __cplusplus
 
@@ -659,6 +677,7 @@ struct aiMesh
         , mNumAnimMeshes( 0 )
         , mAnimMeshes( NULL )
         , mMethod( 0 )
+        , mTriangleIndices( NULL )
     {
         for( unsigned int a = 0; a < AI_MAX_NUMBER_OF_TEXTURECOORDS; a++)
         {
@@ -763,6 +782,10 @@ struct aiMesh
     inline bool HasBones() const
         { return mBones != NULL && mNumBones > 0; }
 
+    //! Check whether the mesh provides a flat triangle index array
+    bool HasTriangleIndices() const
+        { return mTriangleIndices != NULL && mNumFaces > 0; }
+
 #endif // __cplusplus
 };
 
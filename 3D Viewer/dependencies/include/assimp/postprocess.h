@@ -266,17 +266,22 @@ enum aiPostProcessSteps
     aiProcess_ValidateDataStructure = 0x400,
 
     // -------------------------------------------------------------------------
-    /** <hr>Reorders triangles for better vertex cache locality.
+    /** <hr>Reorders triangles and vertices for faster rendering.
      *
      * The step tries to improve the ACMR (average post-transform vertex cache
      * miss ratio) for all meshes. The implementation runs in O(n) and is
      * roughly based on the 'tipsify' algorithm (see <a href="
      * http://www.cs.princeton.edu/gfx/pubs/Sander_2007_%3ETR/tipsy.pdf">this
-     * paper</a>).
+     * paper</a>). The resulting triangle clusters are then sorted to reduce
+     * overdraw, using the view-independent occlusion estimate from the same
+     * paper. At last the vertices are renumbered in the order they are
+     * first referenced, so vertex fetches walk the buffers linearly.
      *
      * If you intend to render huge models in hardware, this step might
      * be of interest to you. The <tt>#AI_CONFIG_PP_ICL_PTCACHE_SIZE</tt>
-     * importer property can be used to fine-tune the cache optimization.
+     * and <tt>#AI_CONFIG_PP_ICL_OVERDRAW_THRESHOLD</tt> importer properties
+     * can be used to fine-tune the optimization. ACMR, ATVR and overdraw
+     * before and after are written to the log.
      */
     aiProcess_ImproveCacheLocality = 0x800,
 
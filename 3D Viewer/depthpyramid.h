@@ -0,0 +1,276 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "glm/glm.hpp"
+#include "shader.h"
+
+// Hierarchical depth (Hi-Z) of a drawn frame, to skip instances hidden behind
+// other geometry. build() reduces the opaque depth of a frame on the GPU,
+// each level keeping the farthest depth under its texels, down to at most
+// READBACK_SIZE, and reads that level back without waiting for it. Once
+// collect() finds it arrived, a frame or two later, the rest of the levels
+// are reduced on the CPU, where isOccluded() tests an instance's nearest
+// depth against the farthest depth over its screen rectangle.
+//
+// The pyramid is as old as the frame it was built from, so what came into
+// view since then is culled until a newer one arrives. isCurrent() tells
+// whether it matches a view: a frame culled against an older one should be
+// followed by another. A multisampled depth buffer is resolved by a blit,
+// which keeps one sample per pixel, so a part seen only through a gap
+// narrower than a pixel can be dropped from the anti-aliased edge
+class DepthPyramid
+{
+public:
+    // Largest size of the level read back
+    static const int READBACK_SIZE = 256;
+
+    DepthPyramid() : m_reduce("shaders/fullscreen.glsl", "shaders/hiz.glsl") {
+        GLint program = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        m_reduce.use();
+        m_reduce.setInt("depth", 0);
+        glUseProgram(program);
+
+        glGenVertexArrays(1, &m_vao);
+        glGenFramebuffers(2, m_framebuffers);
+        glGenTextures(1, &m_depth);
+        glGenBuffers(1, &m_pixelBuffer);
+    }
+    ~DepthPyramid() {
+        glDeleteProgram(m_reduce.get_id());
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteFramebuffers(2, m_framebuffers);
+        glDeleteTextures(1, &m_depth);
+        glDeleteTextures((GLsizei)m_levels.size(), m_levels.data());
+        glDeleteBuffers(1, &m_pixelBuffer);
+        if (m_fence)
+            glDeleteSync(m_fence);
+    }
+    DepthPyramid(const DepthPyramid&) = delete;
+    DepthPyramid& operator=(const DepthPyramid&) = delete;
+
+    // Reduce the depth of source, a width x height framebuffer with a 24 bit
+    // depth buffer, drawn with viewProjection. Does nothing while the last
+    // readback is still on its way. The framebuffer and viewport bound
+    // before are bound again after
+    void build(unsigned int source, int width, int height, const glm::mat4& viewProjection) {
+        if (m_fence)
+            return;
+        GLint framebuffer = 0, viewport[4] = { 0, 0, 0, 0 };
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        if (width != m_width || height != m_height)
+            allocate(width, height);
+
+        // The blit resolves a multisampled depth buffer
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffers[0]);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+        GLint program = 0, polygonMode[2] = { GL_FILL, GL_FILL };
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        glGetIntegerv(GL_POLYGON_MODE, polygonMode);
+        glDisable(GL_DEPTH_TEST);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        m_reduce.use();
+        glBindVertexArray(m_vao);
+        glActiveTexture(GL_TEXTURE0);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[1]);
+        int levelWidth = width, levelHeight = height;
+        for (size_t level = 0; level < m_levels.size(); level++) {
+            levelWidth = std::max(1, levelWidth / 2);
+            levelHeight = std::max(1, levelHeight / 2);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_levels[level], 0);
+            glBindTexture(GL_TEXTURE_2D, level ? m_levels[level - 1] : m_depth);
+            glViewport(0, 0, levelWidth, levelHeight);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // Last level into the pixel buffer, mapped once the fence signals
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBuffer);
+        glReadPixels(0, 0, levelWidth, levelHeight, GL_RED, GL_FLOAT, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_pendingViewProjection = viewProjection;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glUseProgram(program);
+        glPolygonMode(GL_FRONT_AND_BACK, polygonMode[0]);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    // Take the last readback if it arrived, true if the pyramid changed
+    bool collect() {
+        if (!m_fence)
+            return false;
+        const GLenum status = glClientWaitSync(m_fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            return false;
+        glDeleteSync(m_fence);
+        m_fence = nullptr;
+
+        m_cpuLevels.clear();
+        Level& first = m_cpuLevels.emplace_back();
+        first.width = m_readWidth;
+        first.height = m_readHeight;
+        first.depth.resize((size_t)m_readWidth * m_readHeight);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBuffer);
+        const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, first.depth.size() * sizeof(float), GL_MAP_READ_BIT);
+        if (pixels) {
+            std::copy((const float*)pixels, (const float*)pixels + first.depth.size(), first.depth.begin());
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (!pixels) {
+            m_cpuLevels.clear();
+            return false;
+        }
+
+        // Same reduction as hiz.glsl, down to a single texel
+        while (m_cpuLevels.back().width > 1 || m_cpuLevels.back().height > 1) {
+            const Level& below = m_cpuLevels.back();
+            Level level;
+            level.width = std::max(1, below.width / 2);
+            level.height = std::max(1, below.height / 2);
+            level.depth.assign((size_t)level.width * level.height, 0.0f);
+            for (int y = 0; y < below.height; y++) {
+                const int row = std::min(y / 2, level.height - 1) * level.width;
+                for (int x = 0; x < below.width; x++) {
+                    float& farthest = level.depth[row + std::min(x / 2, level.width - 1)];
+                    farthest = std::max(farthest, below.depth[(size_t)y * below.width + x]);
+                }
+            }
+            m_cpuLevels.push_back(std::move(level));
+        }
+        m_viewProjection = m_pendingViewProjection;
+        m_builtWidth = m_width;
+        m_builtHeight = m_height;
+        return true;
+    }
+
+    // Whether there is a pyramid to test against, and whether it was built
+    // with this view
+    bool isReady() const { return !m_cpuLevels.empty(); }
+    bool isCurrent(const glm::mat4& viewProjection) const { return isReady() && viewProjection == m_viewProjection; }
+    // View the pyramid was built with, for the model view projection of isOccluded()
+    const glm::mat4& getViewProjection() const { return m_viewProjection; }
+
+    // Whether the box center +- extent, transformed to clip space by
+    // modelViewProjection built with getViewProjection(), is behind the
+    // depth in the pyramid everywhere it covers. Boxes crossing the near
+    // plane or the screen border count as visible
+    bool isOccluded(const glm::mat4& modelViewProjection, const glm::vec3& center, const glm::vec3& extent) const {
+        if (m_cpuLevels.empty())
+            return false;
+        glm::vec3 low(1.0f), high(-1.0f);
+        for (int corner = 0; corner < 8; corner++) {
+            const glm::vec3 sign((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+            const glm::vec4 clip = modelViewProjection * glm::vec4(center + extent * sign, 1.0f);
+            if (clip.w <= 1e-5f)
+                return false;
+            const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            low = corner ? glm::min(low, ndc) : ndc;
+            high = corner ? glm::max(high, ndc) : ndc;
+        }
+        if (low.z < -1.0f || low.x < -1.0f || low.y < -1.0f || high.x > 1.0f || high.y > 1.0f)
+            return false;
+
+        // Rectangle in pixels, taken down the levels the way texels were
+        // reduced, until it spans at most 2 texels of a level read back. So
+        // at most 3 x 3 texels are read
+        int width = m_builtWidth, height = m_builtHeight;
+        int x0 = std::min((int)((low.x * 0.5f + 0.5f) * width), width - 1);
+        int y0 = std::min((int)((low.y * 0.5f + 0.5f) * height), height - 1);
+        int x1 = std::min((int)((high.x * 0.5f + 0.5f) * width), width - 1);
+        int y1 = std::min((int)((high.y * 0.5f + 0.5f) * height), height - 1);
+        size_t index = 0;
+        for (bool onCpu = false; !onCpu || (index + 1 < m_cpuLevels.size() && std::max(x1 - x0, y1 - y0) > 2);) {
+            if (onCpu)
+                index++;
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+            x0 = std::min(x0 / 2, width - 1);
+            y0 = std::min(y0 / 2, height - 1);
+            x1 = std::min(x1 / 2, width - 1);
+            y1 = std::min(y1 / 2, height - 1);
+            onCpu = onCpu || (width == m_cpuLevels[0].width && height == m_cpuLevels[0].height);
+        }
+        const Level& level = m_cpuLevels[index];
+        float farthest = 0.0f;
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++)
+                farthest = std::max(farthest, level.depth[(size_t)y * level.width + x]);
+        }
+        return low.z * 0.5f + 0.5f > farthest;
+    }
+
+private:
+    struct Level {
+        int width = 0, height = 0;
+        std::vector<float> depth;
+    };
+
+    Shader m_reduce;
+    unsigned int m_vao;
+    // Resolved depth, and the level being drawn
+    unsigned int m_framebuffers[2];
+    unsigned int m_depth;
+    // GPU levels, the first at half the size of the depth
+    std::vector<unsigned int> m_levels;
+    unsigned int m_pixelBuffer;
+    GLsync m_fence = nullptr;
+    int m_width = 0, m_height = 0;
+    // Size of the depth the CPU levels were reduced from
+    int m_builtWidth = 0, m_builtHeight = 0;
+    int m_readWidth = 0, m_readHeight = 0;
+    glm::mat4 m_viewProjection = glm::mat4(1.0f), m_pendingViewProjection = glm::mat4(1.0f);
+    // CPU levels, from the one read back to a single texel
+    std::vector<Level> m_cpuLevels;
+
+    void allocate(int width, int height) {
+        m_width = width;
+        m_height = height;
+
+        glBindTexture(GL_TEXTURE_2D, m_depth);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+        setNearest();
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[0]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+
+        // Halve until the level fits the readback size
+        glDeleteTextures((GLsizei)m_levels.size(), m_levels.data());
+        m_levels.clear();
+        int levelWidth = width, levelHeight = height;
+        do {
+            levelWidth = std::max(1, levelWidth / 2);
+            levelHeight = std::max(1, levelHeight / 2);
+            unsigned int texture;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, levelWidth, levelHeight, 0, GL_RED, GL_FLOAT, NULL);
+            setNearest();
+            m_levels.push_back(texture);
+        } while (std::max(levelWidth, levelHeight) > READBACK_SIZE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        m_readWidth = levelWidth;
+        m_readHeight = levelHeight;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (size_t)levelWidth * levelHeight * sizeof(float), NULL, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    static void setNearest() {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    }
+};
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstring>
+#include <iostream>
+#include <GLFW/glfw3.h>
+#include "glm/glm.hpp"
+
+// Not in the 4.1 loader, GL 4.4 / ARB_buffer_storage
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+// Geometry that is replaced while it is shown, e.g. deforming simulation
+// output or a scan that is updated as it comes in. A producer thread hands
+// over complete frames with push(), the GL thread calls update() and Draw()
+// once per frame.
+//
+// Frames go to a ring of slots. With GL 4.4 or ARB_buffer_storage each slot
+// is a region of persistently mapped buffers that push() writes straight into,
+// and a fence set after drawing a slot keeps it from being reused while the
+// GPU may still read it. Otherwise slots are plain memory and update() uploads
+// the newest frame into orphaned buffers. Neither side waits for the other:
+// if the producer is faster than the display, frames not shown yet are
+// replaced by newer ones
+class DynamicMesh
+{
+public:
+    // Capacity of one frame, push() rejects larger ones
+    DynamicMesh(unsigned int maxVertices, unsigned int maxIndices) : m_maxVertices(maxVertices), m_maxIndices(maxIndices) {
+        glGenVertexArrays(1, &m_vao);
+        glGenBuffers(1, &m_vbo);
+        glGenBuffers(1, &m_ibo);
+        glGenBuffers(1, &m_instanceVbo);
+
+        // Positions of all slots first, then their normals, so slot i is
+        // drawn with base vertex i * maxVertices from one vertex array
+        BufferStorageProc bufferStorage = bufferStorageProc();
+        m_persistent = bufferStorage != nullptr;
+        const unsigned int regions = m_persistent ? numSlots : 1;
+        const GLsizeiptr vertexBytes = (GLsizeiptr)regions * maxVertices * 2 * sizeof(glm::vec3);
+        const GLsizeiptr indexBytes = (GLsizeiptr)regions * maxIndices * sizeof(unsigned int);
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+        if (m_persistent) {
+            bufferStorage(GL_ARRAY_BUFFER, vertexBytes, NULL, flags);
+            bufferStorage(GL_ELEMENT_ARRAY_BUFFER, indexBytes, NULL, flags);
+            glm::vec3* vertices = (glm::vec3*)glMapBufferRange(GL_ARRAY_BUFFER, 0, vertexBytes, flags);
+            unsigned int* indices = (unsigned int*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indexBytes, flags);
+            for (unsigned int i = 0; i < numSlots; i++) {
+                m_slots[i].positions = vertices + (size_t)i * maxVertices;
+                m_slots[i].normals = vertices + (size_t)(numSlots + i) * maxVertices;
+                m_slots[i].indices = indices + (size_t)i * maxIndices;
+            }
+        }
+        else {
+            glBufferData(GL_ARRAY_BUFFER, vertexBytes, NULL, GL_STREAM_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, NULL, GL_STREAM_DRAW);
+            for (Slot& slot : m_slots) {
+                slot.memory.resize((size_t)maxVertices * 2 * sizeof(glm::vec3) + (size_t)maxIndices * sizeof(unsigned int));
+                slot.positions = (glm::vec3*)slot.memory.data();
+                slot.normals = slot.positions + maxVertices;
+                slot.indices = (unsigned int*)(slot.normals + maxVertices);
+            }
+        }
+        // Vertex positions
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        // Vertex normals
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)((size_t)regions * maxVertices * sizeof(glm::vec3)));
+
+        // A single untransformed, opaque instance, the shaders expect a
+        // matrix and an opacity per instance
+        const struct { glm::mat4 transform; float opacity; } instance = { glm::mat4(1.0f), 1.0f };
+        glBindBuffer(GL_ARRAY_BUFFER, m_instanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(instance), &instance, GL_STATIC_DRAW);
+        for (unsigned int column = 0; column < 4; column++) {
+            glEnableVertexAttribArray(2 + column);
+            glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(instance), (void*)(column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(2 + column, 1);
+        }
+        glEnableVertexAttribArray(6);
+        glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, sizeof(instance), (void*)sizeof(glm::mat4));
+        glVertexAttribDivisor(6, 1);
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    // Stop the producer first
+    ~DynamicMesh() {
+        for (Slot& slot : m_slots) {
+            if (slot.fence)
+                glDeleteSync(slot.fence);
+        }
+        if (m_persistent) {
+            glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, m_ibo);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteBuffers(1, &m_vbo);
+        glDeleteBuffers(1, &m_ibo);
+        glDeleteBuffers(1, &m_instanceVbo);
+    }
+    DynamicMesh(const DynamicMesh&) = delete;
+    DynamicMesh& operator=(const DynamicMesh&) = delete;
+
+    // Producer side, any thread but one at a time. Copies a frame of
+    // triangles into a free slot. False if it is larger than the capacity,
+    // or dropped because the GPU is several frames behind. Normals may be
+    // null, they are zero then
+    bool push(const glm::vec3* positions, const glm::vec3* normals, unsigned int numVertices,
+        const unsigned int* indices, unsigned int numIndices) {
+        if (numVertices > m_maxVertices || numIndices > m_maxIndices)
+            return false;
+
+        Slot* slot = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // A free slot, or else the oldest frame still waiting to be shown
+            for (Slot& candidate : m_slots) {
+                if (candidate.state == SlotState::Free) {
+                    slot = &candidate;
+                    break;
+                }
+                if (candidate.state == SlotState::Ready && (!slot || candidate.frame < slot->frame))
+                    slot = &candidate;
+            }
+            // Every other slot is still read by the GPU, drop this frame
+            if (!slot) {
+                m_numDropped++;
+                return false;
+            }
+            if (slot->state == SlotState::Ready)
+                m_numDropped++;
+            slot->state = SlotState::Writing;
+        }
+
+        // No lock while copying, the GL thread leaves Writing slots alone
+        memcpy(slot->positions, positions, numVertices * sizeof(glm::vec3));
+        if (normals)
+            memcpy(slot->normals, normals, numVertices * sizeof(glm::vec3));
+        else
+            memset(slot->normals, 0, numVertices * sizeof(glm::vec3));
+        memcpy(slot->indices, indices, numIndices * sizeof(unsigned int));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        slot->numVertices = numVertices;
+        slot->numIndices = numIndices;
+        slot->frame = ++m_numPushed;
+        slot->state = SlotState::Ready;
+        return true;
+    }
+
+    // GL thread, before Draw(). Switches to the newest complete frame and
+    // frees the slots the GPU has finished reading
+    void update() {
+        Slot* shown = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (Slot& slot : m_slots) {
+                if (slot.state != SlotState::InFlight)
+                    continue;
+                GLenum status = glClientWaitSync(slot.fence, 0, 0);
+                if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+                    glDeleteSync(slot.fence);
+                    slot.fence = 0;
+                    slot.state = SlotState::Free;
+                }
+            }
+
+            Slot* newest = nullptr;
+            for (Slot& slot : m_slots) {
+                if (slot.state == SlotState::Ready && (!newest || slot.frame > newest->frame))
+                    newest = &slot;
+            }
+            if (!newest)
+                return;
+            for (Slot& slot : m_slots) {
+                if (&slot == newest)
+                    continue;
+                // Drawn before, the GPU may still read it until its fence
+                if (slot.state == SlotState::Shown)
+                    slot.state = slot.fence ? SlotState::InFlight : SlotState::Free;
+                // Superseded before it was shown
+                else if (slot.state == SlotState::Ready) {
+                    slot.state = SlotState::Free;
+                    m_numDropped++;
+                }
+            }
+            newest->state = SlotState::Shown;
+            m_shown = shown = newest;
+            m_numShown++;
+        }
+
+        // The producer does not touch the shown slot, upload without the lock
+        if (!m_persistent) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_vbo);
+            const GLsizeiptr vertexBytes = (GLsizeiptr)m_maxVertices * 2 * sizeof(glm::vec3);
+            glBufferData(GL_COPY_WRITE_BUFFER, vertexBytes, NULL, GL_STREAM_DRAW);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, 0, shown->numVertices * sizeof(glm::vec3), shown->positions);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, m_maxVertices * sizeof(glm::vec3), shown->numVertices * sizeof(glm::vec3), shown->normals);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_ibo);
+            glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)m_maxIndices * sizeof(unsigned int), NULL, GL_STREAM_DRAW);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, 0, shown->numIndices * sizeof(unsigned int), shown->indices);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+    }
+
+    // Draw the frame picked by the last update(), nothing before the first push()
+    void Draw() {
+        Slot* slot = m_shown;
+        if (!slot || !slot->numIndices)
+            return;
+        GLenum error = glGetError();
+        const unsigned int index = (unsigned int)(slot - m_slots);
+        const GLint baseVertex = m_persistent ? (GLint)(index * m_maxVertices) : 0;
+        const size_t firstIndex = m_persistent ? (size_t)index * m_maxIndices : 0;
+
+        glBindVertexArray(m_vao);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, slot->numIndices, GL_UNSIGNED_INT,
+            (void*)(firstIndex * sizeof(unsigned int)), 1, baseVertex);
+        glBindVertexArray(0);  // Unbind vao
+
+        // Keeps the slot from being written again until this draw is done
+        if (m_persistent) {
+            if (slot->fence)
+                glDeleteSync(slot->fence);
+            slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+        if (error != GL_NO_ERROR) {
+            std::cerr << "OpenGL Error: " << error << std::endl;
+        }
+    }
+
+    // Persistent mapping, or uploads by orphaning
+    bool isPersistent() const { return m_persistent; }
+    // Frames pushed, shown, and replaced before they were shown
+    unsigned long long getNumPushed() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_numPushed;
+    }
+    unsigned long long getNumShown() const { return m_numShown; }
+    unsigned long long getNumDropped() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_numDropped;
+    }
+
+private:
+    // Free: may be written. Writing: owned by the producer. Ready: complete,
+    // not shown yet. Shown: drawn each frame. InFlight: replaced, but the GPU
+    // may still read it until its fence signals
+    enum class SlotState { Free, Writing, Ready, Shown, InFlight };
+
+    struct Slot {
+        SlotState state = SlotState::Free;
+        unsigned long long frame = 0;
+        unsigned int numVertices = 0, numIndices = 0;
+        GLsync fence = 0;
+        // Into the mapped buffers, or into memory without buffer storage
+        glm::vec3* positions = nullptr;
+        glm::vec3* normals = nullptr;
+        unsigned int* indices = nullptr;
+        std::vector<unsigned char> memory;
+    };
+
+    // One shown, one in flight and one for the producer. A second slot in
+    // flight makes push() drop frames rather than wait
+    static const unsigned int numSlots = 3;
+
+    unsigned int m_maxVertices, m_maxIndices;
+    unsigned int m_vao, m_vbo, m_ibo, m_instanceVbo;
+    bool m_persistent = false;
+    Slot m_slots[numSlots];
+    Slot* m_shown = nullptr;
+    // Guards the slot states and the frame counters
+    std::mutex m_mutex;
+    unsigned long long m_numPushed = 0, m_numShown = 0, m_numDropped = 0;
+
+    // Loaded once a context is current. Null on GL 4.1 without the
+    // extension, the mesh then streams by orphaning
+    static BufferStorageProc bufferStorageProc() {
+        static BufferStorageProc proc =
+            (GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4) || glfwExtensionSupported("GL_ARB_buffer_storage"))
+            ? (BufferStorageProc)glfwGetProcAddress("glBufferStorage") : nullptr;
+        return proc;
+    }
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+// GPU time of the commands between begin() and end(), once per frame. Results
+// are read a few frames later, when the driver has them, so reading never
+// stalls. Time elapsed queries cannot nest, time one range at a time
+class GpuTimer
+{
+public:
+    GpuTimer() { glGenQueries(numQueries, m_queries); }
+    ~GpuTimer() { glDeleteQueries(numQueries, m_queries); }
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin() {
+        glBeginQuery(GL_TIME_ELAPSED, m_queries[m_next]);
+    }
+    void end() {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_pending[m_next] = true;
+        m_next = (m_next + 1) % numQueries;
+
+        // The oldest query, reused by the next begin()
+        if (m_pending[m_next]) {
+            read(m_next);
+            m_pending[m_next] = false;
+        }
+    }
+    // Take the results that arrived, oldest first, for ranges that are not
+    // timed every frame and would otherwise wait for numQueries more
+    void poll() {
+        for (unsigned int i = 0; i < numQueries; i++) {
+            const unsigned int query = (m_next + i) % numQueries;
+            if (m_pending[query] && read(query))
+                m_pending[query] = false;
+        }
+    }
+
+    // Latest result, a few frames old
+    double getMilliseconds() const { return m_milliseconds; }
+
+private:
+    // Frames in flight before a result is needed
+    static const unsigned int numQueries = 4;
+
+    unsigned int m_queries[numQueries];
+    bool m_pending[numQueries] = {};
+    unsigned int m_next = 0;
+    double m_milliseconds = 0.0;
+
+    bool read(unsigned int query) {
+        GLint available = 0;
+        glGetQueryObjectiv(m_queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(m_queries[query], GL_QUERY_RESULT, &nanoseconds);
+            m_milliseconds = nanoseconds / 1e6;
+        }
+        return available != 0;
+    }
+};
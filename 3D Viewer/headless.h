@@ -0,0 +1,415 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+#include <GLFW/glfw3.h>
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "camera.h"
+#include "menu.h"
+#include "shadervariants.h"
+#include "model.h"
+#include "transparency.h"
+#include <assimp/include/Tracer.h>
+
+// Multisampled color and depth target, resolved into a plain one for
+// reading back. Create and destroy it with its context current
+class OffscreenFramebuffer
+{
+public:
+    OffscreenFramebuffer(unsigned int width, unsigned int height) : m_width(width), m_height(height) {
+        glGenFramebuffers(2, m_framebuffers);
+        glGenRenderbuffers(3, m_renderbuffers);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[1]);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_renderbuffers[2]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_renderbuffers[2]);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[0]);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_renderbuffers[0]);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_renderbuffers[0]);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_renderbuffers[1]);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_DEPTH_COMPONENT24, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_renderbuffers[1]);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    }
+    ~OffscreenFramebuffer() {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(2, m_framebuffers);
+        glDeleteRenderbuffers(3, m_renderbuffers);
+    }
+    OffscreenFramebuffer(const OffscreenFramebuffer&) = delete;
+    OffscreenFramebuffer& operator=(const OffscreenFramebuffer&) = delete;
+
+    // Render into the multisampled target
+    void bind() {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[0]);
+        glViewport(0, 0, m_width, m_height);
+    }
+    // The multisampled target, for passes that bind their own
+    unsigned int getFramebuffer() const { return m_framebuffers[0]; }
+    // Resolve and read bottom-up RGBA rows, width * height * 4 bytes
+    void readPixels(unsigned char* rgba) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffers[0]);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffers[1]);
+        glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffers[1]);
+        glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    }
+
+private:
+    unsigned int m_width, m_height;
+    unsigned int m_framebuffers[2], m_renderbuffers[3];
+};
+
+// Renders thumbnails of a list of models without a display:
+//
+//   "3D Viewer" --headless [--views N] [--size WxH] [--out folder] [--workers N]
+//               [--trusted] [--list file] [--trace file] [--no-shader-cache] model...
+//
+// Models may be files, folders or ';'-separated lists as in the Load box,
+// --list reads one more per line. Every model is fitted into the view and
+// rendered from N directions around it with the viewer's shaders, each view
+// is written as <out>/<name>_<view>.png. --trace records the imports and
+// renders of all workers as a Chrome trace. --no-shader-cache compiles the
+// shaders instead of loading them from ProgramCache. GLFW runs on its null platform with
+// an EGL surfaceless context, or OSMesa if EGL is missing, so Mesa's llvmpipe
+// is enough. Workers each own a context and take the next model when done
+class HeadlessRenderer
+{
+public:
+    struct Options {
+        unsigned int views = 8;
+        unsigned int width = 256, height = 256;
+        // One per core when 0
+        unsigned int workers = 0;
+        std::string outputFolder = "thumbnails";
+        bool trustedInput = false;
+        // Chrome trace file, not written when empty
+        std::string traceFile;
+        std::vector<std::string> files;
+    };
+
+    // Entry point for --headless, returns the process exit code
+    static int main(int argc, char** argv) {
+        Options options;
+        if (!parseOptions(argc, argv, options))
+            return 1;
+        return run(options);
+    }
+
+    static int run(const Options& options) {
+        if (options.files.empty()) {
+            std::cout << "Headless: no models to render" << std::endl;
+            return 1;
+        }
+        std::error_code error;
+        std::filesystem::create_directories(options.outputFolder, error);
+
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        if (!glfwInit()) {
+            std::cout << "Headless: GLFW null platform unavailable" << std::endl;
+            return 1;
+        }
+
+        // Contexts are created on the main thread, as GLFW requires, and
+        // handed to the workers afterwards
+        unsigned int numWorkers = options.workers ? options.workers : std::max(1u, std::thread::hardware_concurrency());
+        numWorkers = std::min(numWorkers, (unsigned int)options.files.size());
+        std::vector<GLFWwindow*> contexts;
+        for (unsigned int i = 0; i < numWorkers; i++) {
+            GLFWwindow* context = createContext();
+            if (!context)
+                break;
+            contexts.push_back(context);
+        }
+        if (contexts.empty()) {
+            std::cout << "Headless: could not create an EGL or OSMesa context" << std::endl;
+            glfwTerminate();
+            return 1;
+        }
+
+        // The function pointers are the same for every context of the driver
+        glfwMakeContextCurrent(contexts[0]);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            glfwTerminate();
+            return 1;
+        }
+        std::cout << "Headless: " << glGetString(GL_RENDERER) << ", " << contexts.size() << " workers" << std::endl;
+        glfwMakeContextCurrent(NULL);
+
+        Assimp::Profiling::Tracer::SetEnabled(!options.traceFile.empty());
+        Progress progress;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (GLFWwindow* context : contexts)
+            workers.emplace_back(renderFiles, context, std::cref(options), std::ref(progress));
+        for (std::thread& worker : workers)
+            worker.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (GLFWwindow* context : contexts)
+            glfwDestroyWindow(context);
+        glfwTerminate();
+
+        if (!options.traceFile.empty() && !Assimp::Profiling::Tracer::WriteChromeTrace(options.traceFile.c_str()))
+            std::cout << "Headless: could not write " << options.traceFile << std::endl;
+
+        std::cout << "Headless: " << progress.images << " images of " << progress.models << " models in " << seconds << " s, "
+            << (seconds > 0.0 ? progress.images / seconds : 0.0) << " images/s";
+        if (progress.failed)
+            std::cout << ", " << progress.failed << " models failed";
+        std::cout << std::endl;
+        return progress.failed ? 2 : 0;
+    }
+
+    // Hidden window of the null platform, only its context is used.
+    // Call glfwInit() with GLFW_PLATFORM_NULL first
+    static GLFWwindow* createContext() {
+        glfwDefaultWindowHints();
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        for (int api : { GLFW_EGL_CONTEXT_API, GLFW_OSMESA_CONTEXT_API }) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, api);
+            if (GLFWwindow* window = glfwCreateWindow(1, 1, "", NULL, NULL))
+                return window;
+        }
+        return nullptr;
+    }
+
+private:
+    // Shared by the workers
+    struct Progress {
+        std::atomic<size_t> next{ 0 };
+        std::atomic<unsigned int> models{ 0 }, images{ 0 }, failed{ 0 };
+        std::mutex log;
+    };
+
+    static bool parseOptions(int argc, char** argv, Options& options) {
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--views" && hasValue) {
+                options.views = std::max(1, atoi(argv[++i]));
+            }
+            else if (arg == "--size" && hasValue) {
+                unsigned int width = 0, height = 0;
+                if (sscanf(argv[++i], "%ux%u", &width, &height) == 2 && width && height) {
+                    options.width = width;
+                    options.height = height;
+                }
+            }
+            else if (arg == "--out" && hasValue) {
+                options.outputFolder = argv[++i];
+            }
+            else if (arg == "--workers" && hasValue) {
+                options.workers = std::max(0, atoi(argv[++i]));
+            }
+            else if (arg == "--trace" && hasValue) {
+                options.traceFile = argv[++i];
+            }
+            else if (arg == "--trusted") {
+                options.trustedInput = true;
+            }
+            else if (arg == "--no-shader-cache") {
+                ProgramCache::folder().clear();
+            }
+            else if (arg == "--list" && hasValue) {
+                std::ifstream list(argv[++i]);
+                std::string line;
+                while (std::getline(list, line)) {
+                    std::vector<std::string> files = Model::collectModelFiles(line);
+                    options.files.insert(options.files.end(), files.begin(), files.end());
+                }
+            }
+            else if (arg.rfind("--", 0) == 0) {
+                std::cout << "Headless: unknown option " << arg << std::endl;
+                return false;
+            }
+            else {
+                std::vector<std::string> files = Model::collectModelFiles(arg);
+                options.files.insert(options.files.end(), files.begin(), files.end());
+            }
+        }
+        return true;
+    }
+
+    // Worker loop: import, upload and render models until the list is done
+    static void renderFiles(GLFWwindow* context, const Options& options, Progress& progress) {
+        Assimp::Profiling::Tracer::SetThreadName("headless worker");
+        glfwMakeContextCurrent(context);
+
+        const unsigned int width = options.width, height = options.height;
+        OffscreenFramebuffer* framebuffer = new OffscreenFramebuffer(width, height);
+
+        glEnable(GL_DEPTH_TEST);   // Depth testing
+        glEnable(GL_CULL_FACE);    // Rear face culling
+
+        // Same shaders and default material and lighting as the viewer, the
+        // plain variant and the one accumulating transparency
+        ShaderVariants* variants = new ShaderVariants(
+            "shaders/vertex.glsl",
+            "shaders/fragment.glsl",
+            "shaders/geometry.glsl"
+        );
+        Shader* passes[] = { &variants->select(0), &variants->select(ShaderVariants::OIT_ACCUMULATE) };
+        Shader& shader = *passes[0];
+        Shader& accumulate = *passes[1];
+        Camera defaultCamera;
+        Menu menu(defaultCamera);
+        for (Shader* pass : passes) {
+            pass->use();
+            pass->reloadValues(&menu);
+        }
+        const glm::vec3& background = menu.getBackgroundColor();
+        glClearColor(background.x, background.y, background.z, 1.0f);
+        WeightedBlendedOIT* oit = new WeightedBlendedOIT();
+
+        std::vector<unsigned char> pixels(width * height * 4);
+        for (size_t index = progress.next++; index < options.files.size(); index = progress.next++) {
+            const std::string& file = options.files[index];
+            Model model(file, options.trustedInput);
+            if (!model.getNumParts()) {
+                std::lock_guard<std::mutex> lock(progress.log);
+                std::cout << "Headless: nothing to render in " << file << std::endl;
+                progress.failed++;
+                continue;
+            }
+
+            for (Shader* pass : passes) {
+                pass->use();
+                pass->setMat4("model", model.getFitTransform());
+            }
+
+            Camera camera;
+            camera.setScreenDimensions(width, height);
+            camera.setSensitivities(1.0f, 1.0f, 1.0f);
+            std::string name = std::filesystem::path(file).stem().string();
+            for (unsigned int view = 0; view < options.views; view++) {
+                if (view > 0)
+                    camera.orbit(360.0f / options.views, 0.0f);
+                for (Shader* pass : passes) {
+                    pass->use();
+                    pass->setMat4("view", camera.getViewMatrix());
+                    pass->setMat4("projection", camera.getProjectionMatrix());
+                    pass->setVec3("light.position", camera.getPosition());
+                    pass->setVec3("view_pos", camera.getPosition());
+                }
+
+                {
+                    ASSIMP_TRACE_SCOPE("render");
+                    framebuffer->bind();
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                    shader.use();
+                    model.Draw(MeshBatch::Pass::Opaque);
+                    if (model.hasTransparency()) {
+                        oit->begin(framebuffer->getFramebuffer(), width, height);
+                        accumulate.use();
+                        model.Draw(MeshBatch::Pass::Transparent);
+                        oit->composite(framebuffer->getFramebuffer());
+                    }
+                    framebuffer->readPixels(pixels.data());
+                }
+
+                ASSIMP_TRACE_SCOPE("writePNG");
+                std::filesystem::path path = std::filesystem::path(options.outputFolder) / (name + "_" + std::to_string(view) + ".png");
+                if (writePNG(path.string(), width, height, pixels.data()))
+                    progress.images++;
+            }
+            progress.models++;
+        }
+
+        // The model's buffers are gone, free the rest while still current
+        delete framebuffer;
+        delete oit;
+        delete variants;
+        glfwMakeContextCurrent(NULL);
+    }
+
+    // Write bottom-up RGBA rows as a PNG. The image data uses stored deflate
+    // blocks, so no compression library is needed
+    static bool writePNG(const std::string& path, unsigned int width, unsigned int height, const unsigned char* rgba) {
+        // Filter byte 0 in front of every row, top row first
+        const size_t stride = width * 4;
+        std::vector<unsigned char> raw;
+        raw.reserve((stride + 1) * height);
+        for (unsigned int y = 0; y < height; y++) {
+            raw.push_back(0);
+            const unsigned char* row = rgba + (height - 1 - y) * stride;
+            raw.insert(raw.end(), row, row + stride);
+        }
+
+        // zlib stream of stored blocks with an Adler-32 trailer
+        std::vector<unsigned char> zlib = { 0x78, 0x01 };
+        unsigned int a = 1, b = 0;
+        size_t offset = 0;
+        do {
+            size_t size = std::min<size_t>(raw.size() - offset, 65535);
+            bool last = offset + size == raw.size();
+            zlib.push_back(last ? 1 : 0);
+            zlib.push_back(size & 0xff);
+            zlib.push_back((size >> 8) & 0xff);
+            zlib.push_back(~size & 0xff);
+            zlib.push_back((~size >> 8) & 0xff);
+            for (size_t i = offset; i < offset + size; i++) {
+                a = (a + raw[i]) % 65521;
+                b = (b + a) % 65521;
+            }
+            zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+            offset += size;
+        } while (offset < raw.size());
+        appendBigEndian(zlib, (b << 16) | a);
+
+        std::ofstream out(path, std::ios::binary);
+        if (!out)
+            return false;
+        static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+        out.write((const char*)signature, sizeof(signature));
+        std::vector<unsigned char> header;
+        appendBigEndian(header, width);
+        appendBigEndian(header, height);
+        header.insert(header.end(), { 8, 6, 0, 0, 0 });  // 8 bit RGBA, no interlace
+        writeChunk(out, "IHDR", header);
+        writeChunk(out, "IDAT", zlib);
+        writeChunk(out, "IEND", {});
+        return (bool)out;
+    }
+
+    static void appendBigEndian(std::vector<unsigned char>& data, unsigned int value) {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            data.push_back((value >> shift) & 0xff);
+    }
+
+    // Length, type, data and CRC-32 of type and data
+    static void writeChunk(std::ofstream& out, const char* type, const std::vector<unsigned char>& data) {
+        static const std::vector<unsigned int> table = [] {
+            std::vector<unsigned int> crcs(256);
+            for (unsigned int n = 0; n < 256; n++) {
+                unsigned int c = n;
+                for (int k = 0; k < 8; k++)
+                    c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                crcs[n] = c;
+            }
+            return crcs;
+        }();
+        std::vector<unsigned char> chunk;
+        appendBigEndian(chunk, (unsigned int)data.size());
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+        unsigned int crc = 0xffffffffu;
+        for (size_t i = 4; i < chunk.size(); i++)
+            crc = table[(crc ^ chunk[i]) & 0xff] ^ (crc >> 8);
+        appendBigEndian(chunk, crc ^ 0xffffffffu);
+        out.write((const char*)chunk.data(), chunk.size());
+    }
+};
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <climits>
+#include <cfloat>
+#include <algorithm>
+#include <random>
+#include "glm/glm.hpp"
+#include "shader.h"
+#include "workerpool.h"
+#include <assimp/include/Tracer.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VIEWER_LIGHTS_SSE2
+#endif
+
+// A light placed by the user. Point and spot lights reach range world units,
+// directional lights shine along direction everywhere
+struct Light {
+    enum Type { Point, Spot, Directional };
+    Type type = Point;
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 1.0f;
+    float range = 5.0f;
+    // Spot cone half angles in degrees, full intensity inside the inner one
+    float innerAngle = 20.0f, outerAngle = 30.0f;
+};
+
+// Clustered forward lighting. The view frustum is split into a grid of
+// clusters, screen tiles by exponential depth slices, and every frame each
+// point and spot light is binned into the clusters its bounding sphere
+// touches. The fragment shader then only shades the lights of its own
+// cluster, plus the directional lights, so its cost follows the lights per
+// cluster rather than the total.
+//
+// Binning runs on a WorkerPool, one depth slice per job, with SSE2 picking
+// the lights of a slice four at a time. Lights, cluster ranges and light
+// indices reach the shader through texture buffers, which GLSL 3.30 and
+// every GL 3.3 driver support, unlike storage buffers
+class ClusteredLights
+{
+public:
+    // Cluster grid, screen tiles across and up and depth slices
+    static const int gridX = 16, gridY = 9, gridZ = 24;
+
+    ClusteredLights() {
+        glGenBuffers(3, m_buffers);
+        glGenTextures(3, m_textures);
+        GLint maxTexels = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        m_maxTexels = (unsigned int)std::max(maxTexels, 65536);
+
+        // One texel each until there is something to upload
+        const GLenum formats[3] = { GL_RGBA32UI, GL_RG32UI, GL_R32UI };
+        const unsigned int zero[4] = { 0, 0, 0, 0 };
+        for (int i = 0; i < 3; i++) {
+            glBindBuffer(GL_TEXTURE_BUFFER, m_buffers[i]);
+            glBufferData(GL_TEXTURE_BUFFER, sizeof(zero), zero, GL_DYNAMIC_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, m_textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], m_buffers[i]);
+        }
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+    ~ClusteredLights() {
+        glDeleteTextures(3, m_textures);
+        glDeleteBuffers(3, m_buffers);
+    }
+    ClusteredLights(const ClusteredLights&) = delete;
+    ClusteredLights& operator=(const ClusteredLights&) = delete;
+
+    // Call invalidate() after editing the returned lights
+    std::vector<Light>& getLights() { return m_lights; }
+    void invalidate() { m_dirty = true; }
+    void addLight(const Light& light) {
+        m_lights.push_back(light);
+        m_dirty = true;
+    }
+    void removeLight(size_t index) {
+        m_lights.erase(m_lights.begin() + index);
+        m_dirty = true;
+    }
+    void clear() {
+        m_lights.clear();
+        m_dirty = true;
+    }
+    // Point lights of random colors scattered through a world space box,
+    // each reaching a fifth of its size. Repeatable for one seed
+    void addRandomLights(unsigned int count, const glm::vec3& boundsMin, const glm::vec3& boundsMax, unsigned int seed = 1) {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        const float range = std::max(glm::length(boundsMax - boundsMin) * 0.2f, 1e-3f);
+        for (unsigned int i = 0; i < count; i++) {
+            Light light;
+            light.position = boundsMin + (boundsMax - boundsMin) * glm::vec3(unit(random), unit(random), unit(random));
+            light.color = glm::vec3(unit(random), unit(random), unit(random));
+            light.range = range;
+            m_lights.push_back(light);
+        }
+        m_dirty = true;
+    }
+
+    // Bin the lights for this camera and viewport. projection must be a
+    // perspective projection, its near and far planes bound the slices
+    void update(const glm::mat4& view, const glm::mat4& projection, int width, int height) {
+        ASSIMP_TRACE_SCOPE("bin lights");
+        auto start = std::chrono::steady_clock::now();
+        if (m_dirty)
+            uploadLights();
+
+        const float zNear = projection[3][2] / (projection[2][2] - 1.0f);
+        const float zFar = projection[3][2] / (projection[2][2] + 1.0f);
+        m_depthScale = gridZ / std::log(zFar / zNear);
+        m_depthBias = -std::log(zNear) * m_depthScale;
+        m_tileSize = glm::vec2(std::max(width, 1) / (float)gridX, std::max(height, 1) / (float)gridY);
+
+        // Cluster bounds of every point and spot light, four-aligned for SSE2
+        const size_t count = m_binned.size();
+        const size_t padded = (count + 3) & ~(size_t)3;
+        for (std::vector<int>* bounds : { &m_minX, &m_maxX, &m_minY, &m_maxY, &m_minZ, &m_maxZ })
+            bounds->resize(padded);
+        std::fill(m_minZ.begin() + count, m_minZ.end(), INT_MAX);
+        std::fill(m_maxZ.begin() + count, m_maxZ.end(), INT_MIN);
+        m_pool.parallelFor(count, 512, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                computeBounds(i, view, projection, zNear, zFar);
+        });
+
+        // Each slice sorts its lights into its clusters
+        m_pool.parallelFor(gridZ, 1, [&](size_t begin, size_t end) {
+            for (size_t z = begin; z < end; z++)
+                binSlice((int)z);
+        });
+
+        // Concatenate the slices into one index list
+        m_grid.resize(2 * gridX * gridY * gridZ);
+        m_indices.clear();
+        m_maxPerCluster = 0;
+        unsigned int occupied = 0;
+        for (int z = 0; z < gridZ; z++) {
+            const Slice& slice = m_slices[z];
+            const unsigned int base = (unsigned int)m_indices.size();
+            for (int tile = 0; tile < gridX * gridY; tile++) {
+                const unsigned int cluster = z * gridX * gridY + tile;
+                unsigned int first = base + slice.offsets[tile], lights = slice.offsets[tile + 1] - slice.offsets[tile];
+                // Past the texture buffer size the cluster loses lights
+                lights = std::min(lights, m_maxTexels - std::min(first, m_maxTexels));
+                m_grid[2 * cluster] = first;
+                m_grid[2 * cluster + 1] = lights;
+                m_maxPerCluster = std::max(m_maxPerCluster, lights);
+                occupied += lights ? 1 : 0;
+            }
+            m_indices.insert(m_indices.end(), slice.indices.begin(), slice.indices.end());
+        }
+        m_indices.resize(std::min<size_t>(m_indices.size(), m_maxTexels));
+        m_averagePerCluster = occupied ? (float)m_indices.size() / occupied : 0.0f;
+        m_binningTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        upload(1, m_grid.data(), m_grid.size() * sizeof(unsigned int));
+        if (!m_indices.empty())
+            upload(2, m_indices.data(), m_indices.size() * sizeof(unsigned int));
+    }
+
+    // Bind the buffers to texture units 2 to 4 and set the lighting uniforms.
+    // Expects shader to be in use
+    void apply(Shader& shader) {
+        for (int i = 0; i < 3; i++) {
+            glActiveTexture(GL_TEXTURE2 + i);
+            glBindTexture(GL_TEXTURE_BUFFER, m_textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+        shader.setInt("light_data", 2);
+        shader.setInt("light_grid", 3);
+        shader.setInt("light_indices", 4);
+        shader.setInt("directional_light_count", (int)m_numDirectional);
+        shader.setInt("clustered_light_count", (int)m_binned.size());
+        shader.setIVec3("cluster_grid", glm::ivec3(gridX, gridY, gridZ));
+        shader.setVec2("cluster_tile_size", m_tileSize);
+        shader.setVec2("cluster_depth_scale_bias", glm::vec2(m_depthScale, m_depthBias));
+    }
+
+    // Statistics of the last update(), the binning time leaves out uploads
+    unsigned int getMaxLightsPerCluster() const { return m_maxPerCluster; }
+    float getAverageLightsPerCluster() const { return m_averagePerCluster; }
+    double getBinningTime() const { return m_binningTime; }
+
+private:
+    // Lights, cluster offset and count pairs, light indices
+    unsigned int m_buffers[3], m_textures[3];
+    unsigned int m_maxTexels;
+
+    std::vector<Light> m_lights;
+    bool m_dirty = true;
+    // Directional lights come first in the light buffer, the point and spot
+    // lights after them are binned. Bounding spheres are in world space
+    unsigned int m_numDirectional = 0;
+    std::vector<glm::vec4> m_binned;
+
+    // Cluster range of each binned light, empty ranges for culled ones
+    std::vector<int> m_minX, m_maxX, m_minY, m_maxY, m_minZ, m_maxZ;
+    // Lights of one depth slice, counting sorted by tile
+    struct Slice {
+        std::vector<unsigned int> lights, indices;
+        unsigned int offsets[gridX * gridY + 1];
+    };
+    Slice m_slices[gridZ];
+    std::vector<unsigned int> m_grid, m_indices;
+
+    float m_depthScale = 0.0f, m_depthBias = 0.0f;
+    glm::vec2 m_tileSize = glm::vec2(1.0f);
+    unsigned int m_maxPerCluster = 0;
+    float m_averagePerCluster = 0.0f;
+    double m_binningTime = 0.0;
+    WorkerPool m_pool;
+
+    static void upload(unsigned int buffer, const void* data, size_t bytes) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, bytes, data, GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+    void upload(int index, const void* data, size_t bytes) { upload(m_buffers[index], data, bytes); }
+
+    // Four texels per light, float bits in unsigned texels so all light
+    // samplers have one type: position and range, color and type, direction
+    // and the cosine of the outer angle, cosine of the inner angle
+    void uploadLights() {
+        m_dirty = false;
+        std::vector<const Light*> order;
+        for (const Light& light : m_lights) {
+            if (light.type == Light::Directional)
+                order.push_back(&light);
+        }
+        m_numDirectional = (unsigned int)order.size();
+        for (const Light& light : m_lights) {
+            if (light.type != Light::Directional)
+                order.push_back(&light);
+        }
+        order.resize(std::min<size_t>(order.size(), m_maxTexels / 4));
+
+        std::vector<glm::vec4> texels;
+        texels.reserve(order.size() * 4);
+        m_binned.clear();
+        for (const Light* light : order) {
+            const glm::vec3 direction = glm::length(light->direction) > 0.0f ? glm::normalize(light->direction) : glm::vec3(0.0f, -1.0f, 0.0f);
+            const float outer = glm::radians(glm::clamp(light->outerAngle, 0.1f, 89.9f));
+            const float inner = glm::radians(glm::clamp(light->innerAngle, 0.0f, glm::degrees(outer)));
+            texels.push_back(glm::vec4(light->position, std::max(light->range, 1e-4f)));
+            texels.push_back(glm::vec4(light->color * light->intensity, (float)light->type));
+            texels.push_back(glm::vec4(direction, std::cos(outer)));
+            texels.push_back(glm::vec4(std::cos(inner), 0.0f, 0.0f, 0.0f));
+            if (light->type == Light::Point) {
+                m_binned.push_back(glm::vec4(light->position, light->range));
+            }
+            else if (light->type == Light::Spot) {
+                // Smallest sphere around the cone
+                const float cosine = std::cos(outer), length = light->range;
+                if (cosine < 0.70710678f)
+                    m_binned.push_back(glm::vec4(light->position + direction * cosine * length, std::sin(outer) * length));
+                else
+                    m_binned.push_back(glm::vec4(light->position + direction * (length / (2.0f * cosine)), length / (2.0f * cosine)));
+            }
+        }
+        if (!texels.empty())
+            upload(0, texels.data(), texels.size() * sizeof(glm::vec4));
+    }
+
+    int sliceOf(float depth) const {
+        return glm::clamp((int)std::floor(std::log(depth) * m_depthScale + m_depthBias), 0, gridZ - 1);
+    }
+
+    // Tiles and slices touched by the bounding box of the light's sphere
+    void computeBounds(size_t i, const glm::mat4& view, const glm::mat4& projection, float zNear, float zFar) {
+        const glm::vec3 center = glm::vec3(view * glm::vec4(glm::vec3(m_binned[i]), 1.0f));
+        const float radius = m_binned[i].w;
+        const float closest = -center.z - radius, farthest = -center.z + radius;
+        // An empty range keeps the light out of every slice
+        m_minZ[i] = INT_MAX;
+        m_maxZ[i] = INT_MIN;
+        if (farthest < zNear || closest > zFar)
+            return;
+
+        glm::vec2 ndcMin(-1.0f), ndcMax(1.0f);
+        if (closest > zNear) {
+            ndcMin = glm::vec2(FLT_MAX);
+            ndcMax = glm::vec2(-FLT_MAX);
+            for (int corner = 0; corner < 8; corner++) {
+                const glm::vec3 offset(corner & 1 ? radius : -radius, corner & 2 ? radius : -radius, corner & 4 ? radius : -radius);
+                const glm::vec4 clip = projection * glm::vec4(center + offset, 1.0f);
+                const glm::vec2 ndc = glm::vec2(clip) / clip.w;
+                ndcMin = glm::min(ndcMin, ndc);
+                ndcMax = glm::max(ndcMax, ndc);
+            }
+            if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f)
+                return;
+        }
+        m_minX[i] = glm::clamp((int)std::floor((ndcMin.x * 0.5f + 0.5f) * gridX), 0, gridX - 1);
+        m_maxX[i] = glm::clamp((int)std::floor((ndcMax.x * 0.5f + 0.5f) * gridX), 0, gridX - 1);
+        m_minY[i] = glm::clamp((int)std::floor((ndcMin.y * 0.5f + 0.5f) * gridY), 0, gridY - 1);
+        m_maxY[i] = glm::clamp((int)std::floor((ndcMax.y * 0.5f + 0.5f) * gridY), 0, gridY - 1);
+        m_minZ[i] = sliceOf(std::max(closest, zNear));
+        m_maxZ[i] = sliceOf(std::min(farthest, zFar));
+    }
+
+    // Pick the lights whose slice range holds z, then counting sort their
+    // light buffer indices by tile
+    void binSlice(int z) {
+        Slice& slice = m_slices[z];
+        slice.lights.clear();
+        const size_t padded = m_minZ.size();
+#ifdef VIEWER_LIGHTS_SSE2
+        const __m128i depth = _mm_set1_epi32(z);
+        for (size_t i = 0; i < padded; i += 4) {
+            const __m128i outside = _mm_or_si128(
+                _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)&m_minZ[i]), depth),
+                _mm_cmpgt_epi32(depth, _mm_loadu_si128((const __m128i*)&m_maxZ[i])));
+            const int inside = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF;
+            for (int lane = 0; lane < 4; lane++) {
+                if (inside >> lane & 1)
+                    slice.lights.push_back((unsigned int)(i + lane));
+            }
+        }
+#else
+        for (size_t i = 0; i < padded; i++) {
+            if (m_minZ[i] <= z && z <= m_maxZ[i])
+                slice.lights.push_back((unsigned int)i);
+        }
+#endif
+
+        std::fill(slice.offsets, slice.offsets + gridX * gridY + 1, 0u);
+        for (unsigned int light : slice.lights) {
+            for (int y = m_minY[light]; y <= m_maxY[light]; y++) {
+                for (int x = m_minX[light]; x <= m_maxX[light]; x++)
+                    slice.offsets[y * gridX + x + 1]++;
+            }
+        }
+        for (int tile = 0; tile < gridX * gridY; tile++)
+            slice.offsets[tile + 1] += slice.offsets[tile];
+        slice.indices.resize(slice.offsets[gridX * gridY]);
+        // Next free index of each tile
+        unsigned int cursor[gridX * gridY];
+        std::copy(slice.offsets, slice.offsets + gridX * gridY, cursor);
+        for (unsigned int light : slice.lights) {
+            for (int y = m_minY[light]; y <= m_maxY[light]; y++) {
+                for (int x = m_minX[light]; x <= m_maxX[light]; x++)
+                    slice.indices[cursor[y * gridX + x]++] = m_numDirectional + light;
+            }
+        }
+    }
+};
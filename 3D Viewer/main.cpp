@@ -1,3 +1,11 @@
+// Process CPU time, before glad so APIENTRY is defined once
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <GL/gl.h>
@@ -6,12 +14,30 @@
 #include "menu.h"
 #include "model.h"
 #include "mesh.h"
+#include "dynamicmesh.h"
+#include "transparency.h"
+#include "gputimer.h"
+#include "lights.h"
+#include "shadervariants.h"
+#include "adaptivequality.h"
+#include "scenetarget.h"
+#include "depthpyramid.h"
+#include "shadowmap.h"
+#include "ambientocclusion.h"
+#include "headless.h"
 #include <GL/glut.h>
 #include <stdio.h>
 #include <imgui.h>
 #include <fstream>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <cmath>
+#include <chrono>
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
+#include <assimp/include/DefaultLogger.hpp>
+#include <assimp/include/Tracer.h>
 
 #define GL_SILENCE_DEPRECATION
 
@@ -19,26 +45,58 @@ GLFWwindow* window;
 
 const unsigned int SCR_WIDTH = 1280;
 const unsigned int SCR_HEIGHT = 800;
+// On-demand rendering: frames drawn after a change, so ImGui settles, and
+// the longest wait for events before checking background work again
+const unsigned int REDRAW_FRAMES = 3;
+const double IDLE_TIMEOUT = 0.5;
 
 // Global values
 float last_x, last_y;
 bool first_mouse = true;
 float cameraSpeed = 5.f;
+unsigned int redraw_frames = REDRAW_FRAMES;
 
 Camera camera;
 Menu menu(camera);
 Model model;
 
 //Controls
-void process_keypresses(GLFWwindow* window, float deltaTime);
+bool process_keypresses(GLFWwindow* window, float deltaTime);
 void mouse_callback(GLFWwindow* window, double x_pos, double y_pos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 
+//Streaming demo
+const unsigned int WAVE_SIZE = 256;
+void stream_wave(DynamicMesh* mesh, std::atomic<bool>* running);
+
+//Lights
+void lights_window(ClusteredLights& lights);
+
+//Uniforms of a shader variant that change between frames
+void set_frame_uniforms(Shader& shader, ClusteredLights& lights, const glm::mat4& projection, const CascadedShadowMap* shadows);
+
+//On-demand rendering
+void request_redraw();
+double process_cpu_seconds();
+
 //Check file
 inline bool file_exists(const std::string& name);
 
-int main(int* argc, char** argv)
+int main(int argc, char** argv)
 {
+    // Render thumbnails without a window, see headless.h
+    if (argc > 1 && std::string(argv[1]) == "--headless")
+        return HeadlessRenderer::main(argc, argv);
+
+    auto launch = std::chrono::steady_clock::now();
+    // Always compile shaders or build meshlets, to compare startup with the caches
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--no-shader-cache")
+            ProgramCache::folder().clear();
+        if (std::string(argv[i]) == "--no-meshlet-cache")
+            Meshlets::folder().clear();
+    }
+
     try {
         std::string ModelPath = "./models/rat.stl";
 
@@ -46,10 +104,16 @@ int main(int* argc, char** argv)
             std::cout << "Default file not found" << std::endl;
             return 0;
         }
+        // Print importer warnings and errors. A VERBOSE logger would also
+        // measure vertex cache and overdraw ratios, which slows every load
+        Assimp::DefaultLogger::create("", Assimp::Logger::NORMAL, aiDefaultLogStream_STDOUT);
+
         if (!glfwInit())
             return -1;
 
-        glfwWindowHint(GLFW_SAMPLES, 4);
+        // The scene is anti-aliased offscreen (see SceneTarget), the window
+        // only receives the finished image and the menu
+        glfwWindowHint(GLFW_SAMPLES, 0);
         // We need to explicitly ask for a 4.1, core profile context on OS X
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
@@ -63,12 +127,23 @@ int main(int* argc, char** argv)
         window_height = SCR_HEIGHT;
         GLFWwindow* window = glfwCreateWindow(window_width, window_height, "STL Model Viewer", NULL, NULL);
         camera.setScreenDimensions(window_width, window_height);
+        // Hidden context sharing the window's objects, shader variants compile on it
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        GLFWwindow* compileContext = glfwCreateWindow(1, 1, "Shader compiler", NULL, window);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
 
         // Make the window's context current
         glfwMakeContextCurrent(window);
         // Set input callbacks
         glfwSetCursorPosCallback(window, mouse_callback);
         glfwSetScrollCallback(window, scroll_callback);
+        // Anything else that can change the image asks for a redraw too
+        glfwSetKeyCallback(window, [](GLFWwindow*, int, int, int, int) { request_redraw(); });
+        glfwSetCharCallback(window, [](GLFWwindow*, unsigned int) { request_redraw(); });
+        glfwSetMouseButtonCallback(window, [](GLFWwindow*, int, int, int) { request_redraw(); });
+        glfwSetFramebufferSizeCallback(window, [](GLFWwindow*, int, int) { request_redraw(); });
+        glfwSetWindowRefreshCallback(window, [](GLFWwindow*) { request_redraw(); });
+        glfwSetWindowFocusCallback(window, [](GLFWwindow*, int) { request_redraw(); });
         // Set vsync
         glfwSwapInterval(1);
 
@@ -98,7 +173,7 @@ int main(int* argc, char** argv)
 
         glEnable(GL_DEPTH_TEST);   // Depth testing
         glEnable(GL_CULL_FACE);    // Rear face culling
-        glEnable(GL_MULTISAMPLE);  // MSAA
+        glEnable(GL_MULTISAMPLE);  // MSAA of the scene target
 
         // Set up input sensitivities
         float* mouse_sensitivity = &menu.getMouseSensitivity();
@@ -106,16 +181,54 @@ int main(int* argc, char** argv)
         float* fov_sensitivity = &menu.getFovSensitivity();
         camera.setSensitivities(*mouse_sensitivity, *zoom_sensitivity, *fov_sensitivity);
 
-        // Instantiate, compile and link shader
-        Shader shader(
+        // Instantiate, compile and link the plain shader, or load it from the
+        // program cache. Variants with more features compile in the background
+        auto shadersStart = std::chrono::steady_clock::now();
+        std::unique_ptr<ShaderVariants> variants(new ShaderVariants(
             "shaders/vertex.glsl",
             "shaders/fragment.glsl",
-            "shaders/geometry.glsl"
-        );
-        shader.use(); // There is only have one shader so this one can remain attached
+            "shaders/geometry.glsl",
+            ShaderVariants::EXPLODE | ShaderVariants::SCENE_LIGHTS | ShaderVariants::SHADOWS,
+            compileContext
+        ));
+        Shader* shader = &variants->select(0);
+        shader->use();
+        //Transparent pass targets and its cost, compared between the modes
+        std::unique_ptr<WeightedBlendedOIT> oit(new WeightedBlendedOIT());
+        std::unique_ptr<GpuTimer> transparencyTimer(new GpuTimer());
+        //Offscreen scene at an adaptive scale of the window, see adaptivequality.h
+        std::unique_ptr<SceneTarget> sceneTarget(new SceneTarget());
+        std::unique_ptr<GpuTimer> sceneTimer(new GpuTimer());
+        std::unique_ptr<GpuTimer> presentTimer(new GpuTimer());
+        //Occluded ambient light, a pass between the opaque and transparent ones
+        std::unique_ptr<AmbientOcclusion> ambientOcclusion(new AmbientOcclusion());
+        std::unique_ptr<GpuTimer> ambientOcclusionTimer(new GpuTimer());
+        auto sceneGpuMilliseconds = [&]() {
+            return sceneTimer->getMilliseconds() + (model.hasTransparency() ? transparencyTimer->getMilliseconds() : 0.0) +
+                (menu.isAmbientOcclusion() ? ambientOcclusionTimer->getMilliseconds() : 0.0);
+        };
+        AdaptiveQuality quality;
+        glm::mat4 lastViewProjection(0.0f);
+        //Depth of an earlier frame for occlusion culling, and whether the last
+        //frame was culled against one built with another view
+        std::unique_ptr<DepthPyramid> depthPyramid(new DepthPyramid());
+        bool staleOcclusion = false;
+        //Shadow maps of the scene light, the cost of drawing them and how
+        //often they were, they are kept while only the camera turns
+        std::unique_ptr<CascadedShadowMap> shadowMap(new CascadedShadowMap());
+        std::unique_ptr<GpuTimer> shadowTimer(new GpuTimer());
+        double shadowCpuTime = 0.0;
+        unsigned int shadowRenders = 0;
+        double sceneCpuTime = 0.0;
+        const double shaderTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - shadersStart).count();
+        const char* shaderSource = shader->is_from_cache() ? "program cache" : ProgramCache::isEnabled() ? "compiled, now cached" : "compiled";
+        bool firstFrame = true;
+        double cullTime = 0.0;
+        //Lights placed in the scene, binned into clusters every frame
+        std::unique_ptr<ClusteredLights> lights(new ClusteredLights());
 
         //Load a default 3DModel from the default path
-        model = model.load3DModel(ModelPath, shader, &menu);
+        model = model.load3DModel(ModelPath, *shader, &menu);
         //Time and Frame Animation
         float deltaTime, currentFrame, lastFrame = 0;
         bool show_demo_window = true;
@@ -135,11 +248,39 @@ int main(int* argc, char** argv)
         float* diffuseLightingColorTmp = glm::value_ptr(menu.getDiffuseLightingColor());
         float* specularLightingColorTmp = glm::value_ptr(menu.getSpecularLightingColor());
 
-        //Path Temporary value
-        char* modelPathTmp = ModelPath.data();
-        shader.reloadValues(&menu);
+        //Path Temporary value, room for folders and ';'-separated lists
+        char modelPathTmp[512];
+        snprintf(modelPathTmp, sizeof(modelPathTmp), "%s", ModelPath.c_str());
+        //Streaming demo surface and its producer thread
+        std::unique_ptr<DynamicMesh> streamMesh;
+        std::atomic<bool> streaming(false);
+        std::thread producer;
+        auto stopStreaming = [&]() {
+            streaming = false;
+            if (producer.joinable())
+                producer.join();
+            streamMesh.reset();
+        };
+        shader->reloadValues(&menu);
+        //Process CPU time over about a second, idle time included
+        double cpuStart = process_cpu_seconds(), cpuWallStart = glfwGetTime(), cpuUsage = 0.0, framesPerSecond = 0.0;
+        unsigned int cpuFrames = 0;
+        Assimp::Profiling::Tracer::SetThreadName("render");
         while (!glfwWindowShouldClose(window))
         {
+            //Wait for events while nothing changes, the window keeps showing
+            //the last frame. Background work is checked at least every timeout
+            bool changed = streamMesh || model.isBatchLoading() || variants->isCompiling() || staleOcclusion;
+            bool animating = changed || quality.isRefining();
+            if (menu.isOnDemandRendering() && redraw_frames == 0 && !animating) {
+                glfwWaitEventsTimeout(IDLE_TIMEOUT);
+                if (redraw_frames == 0)
+                    continue;
+            }
+            changed |= redraw_frames > 0;
+            if (redraw_frames > 0)
+                redraw_frames--;
+            ASSIMP_TRACE_SCOPE("frame");
             //Create ImGui Frames
             ImGui_ImplOpenGL3_NewFrame();
             ImGui_ImplGlfw_NewFrame();
@@ -171,9 +312,10 @@ int main(int* argc, char** argv)
                 ImGui::EndMainMenuBar();
             }
             //Model Path and name
-            ImGui::InputText("Model", modelPathTmp, 50, 0, NULL, NULL);
+            ImGui::InputText("Model", modelPathTmp, sizeof(modelPathTmp), 0, NULL, NULL);
             if (ImGui::Button("Load")) {
-                if (file_exists(modelPathTmp) == false) {
+                std::vector<std::string> modelPaths = Model::collectModelFiles(modelPathTmp);
+                if (modelPaths.empty()) {
                     //ImGui::BeginPopupModal("Error", NULL, ImGuiWindowFlags_AlwaysAutoResize);
                     ImGui::OpenPopup("Message Box", ImGuiPopupFlags_NoReopen);
                     ImGui::Text("STL Model not found. Make sure the file is in the models folder");
@@ -184,8 +326,118 @@ int main(int* argc, char** argv)
                         ImGui::EndPopup();
                     }
                 }
+                else if (modelPaths.size() == 1) {
+                    model = model.load3DModel(modelPaths[0], *shader, &menu);
+                }
+                else {
+                    // Folders and lists load in parallel, parts show up as they finish
+                    model = model.load3DModels(modelPaths, *shader, &menu);
+                }
+                request_redraw();
+            }
+            if (model.isBatchLoading()) {
+                ImGui::Text("Loading parts %u / %u", model.getBatchLoaded(), model.getBatchTotal());
+            }
+            //Instancing statistics
+            ImGui::Text("Draw calls: %u for %u parts (%u visible)", model.getNumDrawCalls(), model.getNumParts(),
+                model.getNumVisibleParts());
+            ImGui::Text("Mesh memory: %.1f MB (%.1f MB without instancing)", model.getMeshMemory() / 1048576.0,
+                model.getMeshMemoryWithoutInstancing() / 1048576.0);
+            ImGui::Text("Import %.0f ms, upload %.0f ms", model.getImportTime() * 1000.0, model.getUploadTime() * 1000.0);
+            ImGui::Text("Shaders %.1f ms (%s)", shaderTime * 1000.0, shaderSource);
+            ImGui::Text("Shader variants: %u built, %u from cache%s", variants->getNumBuilt(), variants->getNumFromCache(),
+                variants->isCompiling() ? ", compiling" : "");
+            //Skip import validation for files known to be well-formed
+            ImGui::Checkbox("Trusted input", &menu.isTrustedInput());
+            //Skip parts outside the view
+            ImGui::Checkbox("Frustum culling", &menu.isFrustumCulling());
+            //Skip parts hidden behind others
+            ImGui::Checkbox("Occlusion culling", &menu.isOcclusionCulling());
+            if (menu.isOcclusionCulling()) {
+                ImGui::Text("Occluded: %u of %u parts (%.0f%%)", model.getNumOccludedParts(), model.getNumParts(),
+                    model.getNumParts() ? 100.0 * model.getNumOccludedParts() / model.getNumParts() : 0.0);
+            }
+            //Skip clusters of large meshes outside the view or facing away
+            ImGui::Checkbox("Meshlet culling", &menu.isMeshletCulling());
+            if (menu.isMeshletCulling() && model.getNumMeshlets()) {
+                ImGui::Text("Meshlets: %u of %u drawn (%.0f%%)", model.getNumMeshletsDrawn(), model.getNumMeshlets(),
+                    100.0 * model.getNumMeshletsDrawn() / model.getNumMeshlets());
+            }
+            //Draw only when something changed, instead of at the refresh rate
+            ImGui::Checkbox("On-demand rendering", &menu.isOnDemandRendering());
+            ImGui::Text("CPU %.0f%% of a core, %.0f frames/s", cpuUsage, framesPerSecond);
+            //Lower resolution and detail while the camera moves, refined when it stops
+            ImGui::Checkbox("Adaptive quality", &menu.isAdaptiveQuality());
+            //Resolution following the frame budget whenever the image changes
+            ImGui::Checkbox("Dynamic resolution", &menu.isDynamicResolution());
+            if (menu.isAdaptiveQuality() || menu.isDynamicResolution()) {
+                ImGui::SliderInt("Target FPS", &menu.getTargetFps(), 10, 120);
+                ImGui::SliderFloat("Upscale sharpness", &menu.getSharpness(), 0.0f, 1.0f);
+            }
+            ImGui::Combo("Anti-aliasing", &menu.getAntiAliasing(), "MSAA 4x\0FXAA\0");
+            ImGui::Text("Scale %.0f%% (%dx%d)%s, refined %u / %u", quality.getScale() * 100.0f, sceneTarget->getWidth(),
+                sceneTarget->getHeight(), quality.isCoarse() ? " coarse" : "", quality.getSample() + 1, AdaptiveQuality::REFINEMENT_FRAMES);
+            ImGui::Text("Scene %.1f ms (CPU %.1f ms, GPU %.1f ms), upscale %.2f ms, budget %.1f ms",
+                std::max(sceneCpuTime * 1000.0, sceneGpuMilliseconds()), sceneCpuTime * 1000.0, sceneGpuMilliseconds(),
+                presentTimer->getMilliseconds(), 1000.0 / menu.getTargetFps());
+            //Geometry replaced by another thread while it is drawn
+            if (ImGui::Checkbox("Streaming demo", &menu.isStreamingDemo())) {
+                if (menu.isStreamingDemo()) {
+                    streamMesh.reset(new DynamicMesh(WAVE_SIZE * WAVE_SIZE, (WAVE_SIZE - 1) * (WAVE_SIZE - 1) * 6));
+                    streaming = true;
+                    producer = std::thread(stream_wave, streamMesh.get(), &streaming);
+                }
+                else {
+                    stopStreaming();
+                }
+            }
+            if (streamMesh) {
+                ImGui::Text("Streamed frames: %llu shown, %llu dropped (%s)", streamMesh->getNumShown(), streamMesh->getNumDropped(),
+                    streamMesh->isPersistent() ? "persistent mapping" : "orphaning");
+            }
+            //Transparent materials, blended without sorting or sorted back to front
+            ImGui::Combo("Transparency", &menu.getTransparencyMode(), "Weighted blended\0Sorted\0");
+            if (model.hasTransparency()) {
+                ImGui::Text("Transparent pass %.2f ms GPU, culling and sorting %.2f ms CPU",
+                    transparencyTimer->getMilliseconds(), cullTime * 1000.0);
+            }
+            if (!model.getMaterials().empty() && ImGui::TreeNode("Material opacity")) {
+                for (unsigned int i = 0; i < model.getMaterials().size(); i++) {
+                    float opacity = model.getMaterials()[i].opacity;
+                    ImGui::PushID(i);
+                    if (ImGui::SliderFloat(model.getMaterials()[i].name.c_str(), &opacity, 0.0f, 1.0f))
+                        model.setMaterialOpacity(i, opacity);
+                    ImGui::PopID();
+                }
+                ImGui::TreePop();
+            }
+            //Scene light from a fixed direction, casting shadows
+            ImGui::Checkbox("Shadows", &menu.isShadows());
+            if (menu.isShadows()) {
+                ImGui::SliderFloat("Light azimuth", &menu.getLightAzimuth(), 0.0f, 360.0f);
+                ImGui::SliderFloat("Light elevation", &menu.getLightElevation(), 5.0f, 90.0f);
+                ImGui::Text("Shadow pass %.2f ms GPU, %.2f ms CPU, drawn %u times", shadowTimer->getMilliseconds(),
+                    shadowCpuTime * 1000.0, shadowRenders);
+            }
+            //Ambient light darkened in creases and corners, fewer samples for speed
+            ImGui::Checkbox("Ambient occlusion", &menu.isAmbientOcclusion());
+            if (menu.isAmbientOcclusion()) {
+                ImGui::SliderInt("Occlusion quality", &menu.getAmbientOcclusionSamples(), AmbientOcclusion::MIN_SAMPLES,
+                    AmbientOcclusion::MAX_SAMPLES, "%d samples");
+                ImGui::Text("Ambient occlusion %.2f ms GPU, %.0f%% of the scene", ambientOcclusionTimer->getMilliseconds(),
+                    100.0 * ambientOcclusionTimer->getMilliseconds() / std::max(sceneGpuMilliseconds(), 1e-3));
+            }
+            lights_window(*lights);
+            //Chrome trace of frames and imports, written when recording stops
+            if (ImGui::Checkbox("Record trace", &menu.isRecordingTrace())) {
+                if (menu.isRecordingTrace()) {
+                    Assimp::Profiling::Tracer::Clear();
+                    Assimp::Profiling::Tracer::SetEnabled(true);
+                }
                 else {
-                    model = model.load3DModel(modelPathTmp, shader, &menu);
+                    Assimp::Profiling::Tracer::SetEnabled(false);
+                    if (Assimp::Profiling::Tracer::WriteChromeTrace("trace.json"))
+                        std::cout << "Trace written to trace.json" << std::endl;
                 }
             }
             //WireFrame display
@@ -212,6 +464,8 @@ int main(int* argc, char** argv)
 
             //Shininess
             ImGui::SliderFloat("Shininess", &menu.getShininess(), 0.0f, 100.0f);
+            //Explode, through the geometry stage of the EXPLODE variant
+            ImGui::SliderFloat("Explode", &menu.getExplodeDistance(), 0.0f, 1.0f);
             //Scene
             ImGui::Text("Scene");
             ImGui::ColorEdit4("Ambient Scene", ambientLightingColorTmp, ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_DisplayRGB |
@@ -232,32 +486,175 @@ int main(int* argc, char** argv)
             ImGui::Render();
             int display_w, display_h;
             glfwGetFramebufferSize(window, &display_w, &display_h);
-            glViewport(0, 0, display_w, display_h);
-            //glClearColor(menu.backgroundColor.x, menu.backgroundColor.y, menu.backgroundColor.z, 1.0f);
-            glClearColor(backGroundColorTmp[0], backGroundColorTmp[1], backGroundColorTmp[2], 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-            //shader.setFloat("distance", explode_distance);
-            shader.setMat4("view", camera.getViewMatrix());
-            shader.setMat4("projection", camera.getProjectionMatrix());
-            shader.setVec3("light.position", camera.getPosition());
-            shader.setVec3("view_pos", camera.getPosition());
-
-            //Draw Model
-            model.Draw(shader);
-            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-            //Reload shader values
-            shader.reloadValues(&menu);
-            glfwSwapBuffers(window);
+
+            //Scale and refinement of this frame, from the cost of recent ones
+            const glm::mat4 viewProjection = camera.getProjectionMatrix() * camera.getViewMatrix();
+            const bool moving = viewProjection != lastViewProjection;
+            lastViewProjection = viewProjection;
+            const double frameTime = std::max(sceneCpuTime * 1000.0, sceneGpuMilliseconds());
+            quality.update(menu.isAdaptiveQuality(), menu.isDynamicResolution(), menu.getTargetFps(), moving, changed, frameTime);
+            //Draw Model, adding any parts that finished loading
+            model.updateBatch();
+            if (quality.shouldDraw()) {
+                ASSIMP_TRACE_SCOPE("scene");
+                auto sceneStart = std::chrono::steady_clock::now();
+                sceneTarget->setSamples(menu.getAntiAliasing() == Menu::MultisampleAntiAliasing ? 4 : 0);
+                sceneTarget->resize(display_w, display_h, quality.getScale());
+                const int scene_w = sceneTarget->getWidth(), scene_h = sceneTarget->getHeight();
+                const glm::mat4 projection = quality.jitter(camera.getProjectionMatrix(), scene_w, scene_h);
+                sceneTarget->bind();
+                //glClearColor(menu.backgroundColor.x, menu.backgroundColor.y, menu.backgroundColor.z, 1.0f);
+                glClearColor(backGroundColorTmp[0], backGroundColorTmp[1], backGroundColorTmp[2], 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+                //Shadow maps, drawn again only when the light, the model or
+                //the zoom level changed
+                const CascadedShadowMap* shadows = nullptr;
+                glm::vec3 boundsMin, boundsMax;
+                if (menu.isShadows() && model.getBounds(boundsMin, boundsMax)) {
+                    const glm::mat4 modelMatrix = Model::getModelMatrix(&menu);
+                    const float viewExtent = glm::length(camera.getPosition()) / camera.getProjectionMatrix()[1][1];
+                    if (shadowMap->fit(CascadedShadowMap::direction(menu.getLightAzimuth(), menu.getLightElevation()),
+                            boundsMin, boundsMax, modelMatrix, model.getGeometryVersion(), glm::vec3(0.0f), viewExtent)) {
+                        ASSIMP_TRACE_SCOPE("shadows");
+                        auto shadowStart = std::chrono::steady_clock::now();
+                        shadowTimer->begin();
+                        shadowMap->render([&](const glm::mat4& lightViewProjection, Shader& depth) {
+                            depth.setMat4("model", modelMatrix);
+                            // No meshlet culling, clusters facing away from the light still cast shadows
+                            model.cull(lightViewProjection * modelMatrix, true, false);
+                            model.Draw(MeshBatch::Pass::Opaque);
+                        });
+                        shadowTimer->end();
+                        shadowCpuTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - shadowStart).count();
+                        shadowRenders++;
+                    }
+                    shadows = shadowMap.get();
+                }
+                shadowTimer->poll();
+
+                //Shader variant for this frame, chosen once for all draws
+                unsigned int features = 0;
+                if (shadows)
+                    features |= ShaderVariants::SHADOWS;
+                if (!lights->getLights().empty())
+                    features |= ShaderVariants::SCENE_LIGHTS;
+                if (menu.getExplodeDistance() > 0.0f)
+                    features |= ShaderVariants::EXPLODE;
+                shader = &variants->select(features);
+                shader->use();
+                lights->update(camera.getViewMatrix(), projection, scene_w, scene_h);
+                set_frame_uniforms(*shader, *lights, projection, shadows);
+
+                sceneTimer->begin();
+                auto cullStart = std::chrono::steady_clock::now();
+                const DepthPyramid* occluders = nullptr;
+                if (menu.isOcclusionCulling()) {
+                    depthPyramid->collect();
+                    occluders = depthPyramid.get();
+                }
+                model.cull(viewProjection, &menu, quality.isCoarse(), occluders);
+                staleOcclusion = occluders && occluders->isReady() && !occluders->isCurrent(viewProjection);
+                cullTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - cullStart).count();
+                model.Draw(MeshBatch::Pass::Opaque);
+                if (streamMesh) {
+                    ASSIMP_TRACE_SCOPE("stream");
+                    streamMesh->update();
+                    streamMesh->Draw();
+                }
+                //Occluders for the next frames, from the opaque depth
+                if (occluders)
+                    depthPyramid->build(sceneTarget->getFramebuffer(), scene_w, scene_h, viewProjection);
+                sceneTimer->end();
+                //Ambient occlusion of the opaque image, over a radius scaled
+                //to the model. Wireframes have no surfaces to occlude
+                if (menu.isAmbientOcclusion() && !menu.isWireFrame() && model.getBounds(boundsMin, boundsMax)) {
+                    ASSIMP_TRACE_SCOPE("ambient occlusion");
+                    const glm::vec3 extent = glm::vec3(Model::getModelMatrix(&menu) * glm::vec4(boundsMax - boundsMin, 0.0f));
+                    ambientOcclusionTimer->begin();
+                    ambientOcclusion->apply(sceneTarget->getFramebuffer(), scene_w, scene_h, projection, glm::length(extent) * 0.04f,
+                        menu.getAmbientOcclusionSamples(), menu.getAmbientLightingColor() * menu.getAmbientMaterialColor());
+                    ambientOcclusionTimer->end();
+                }
+                //Transparent parts over the opaque image
+                if (model.hasTransparency()) {
+                    ASSIMP_TRACE_SCOPE("transparency");
+                    transparencyTimer->begin();
+                    if (menu.getTransparencyMode() == Menu::WeightedBlendedTransparency) {
+                        oit->begin(sceneTarget->getFramebuffer(), scene_w, scene_h);
+                        Shader& accumulate = variants->select(features | ShaderVariants::OIT_ACCUMULATE);
+                        accumulate.use();
+                        set_frame_uniforms(accumulate, *lights, projection, shadows);
+                        model.Draw(MeshBatch::Pass::Transparent);
+                        oit->composite(sceneTarget->getFramebuffer());
+                        shader->use();
+                    }
+                    else {
+                        glEnable(GL_BLEND);
+                        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                        glDepthMask(GL_FALSE);
+                        model.Draw(MeshBatch::Pass::Transparent);
+                        glDepthMask(GL_TRUE);
+                        glDisable(GL_BLEND);
+                    }
+                    transparencyTimer->end();
+                }
+                sceneTarget->resolve(quality.getSample());
+                sceneCpuTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - sceneStart).count();
+            }
+            //The latest image over the whole window, the menu on top
+            presentTimer->begin();
+            sceneTarget->present(0, display_w, display_h, menu.getSharpness());
+            presentTimer->end();
+            {
+                ASSIMP_TRACE_SCOPE("imgui");
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            }
+            {
+                ASSIMP_TRACE_SCOPE("swap");
+                glfwSwapBuffers(window);
+            }
+            if (firstFrame) {
+                firstFrame = false;
+                std::cout << "Startup: shaders " << shaderTime * 1000.0 << " ms (" << shaderSource << "), first frame after "
+                    << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launch).count() << " ms" << std::endl;
+            }
+            cpuFrames++;
+            if (glfwGetTime() - cpuWallStart >= 1.0) {
+                double cpuNow = process_cpu_seconds(), wallNow = glfwGetTime();
+                cpuUsage = (cpuNow - cpuStart) / (wallNow - cpuWallStart) * 100.0;
+                framesPerSecond = cpuFrames / (wallNow - cpuWallStart);
+                cpuStart = cpuNow;
+                cpuWallStart = wallNow;
+                cpuFrames = 0;
+            }
             glfwPollEvents();
 
-            process_keypresses(window, deltaTime);
+            //Held keys keep moving the camera, so keep drawing
+            if (process_keypresses(window, deltaTime))
+                request_redraw();
         }
-        glDeleteProgram(shader.get_id());
+        // Free the model's buffers while the context is still alive
+        stopStreaming();
+        model = Model();
+        oit.reset();
+        transparencyTimer.reset();
+        sceneTarget.reset();
+        sceneTimer.reset();
+        presentTimer.reset();
+        depthPyramid.reset();
+        shadowMap.reset();
+        shadowTimer.reset();
+        ambientOcclusion.reset();
+        ambientOcclusionTimer.reset();
+        lights.reset();
+        variants.reset();
+        glfwDestroyWindow(compileContext);
         ImGui_ImplOpenGL3_Shutdown();
         ImGui_ImplGlfw_Shutdown();
         ImGui::DestroyContext();
         glfwTerminate();
+        Assimp::DefaultLogger::kill();
     }
     catch (...) {
         std::cerr << "Caught an exception!" << std::endl;
@@ -266,39 +663,49 @@ int main(int* argc, char** argv)
 }
 
 
-void process_keypresses(GLFWwindow* window, float delta_time)
+// Whether the camera moved
+bool process_keypresses(GLFWwindow* window, float delta_time)
 {
+    bool moved = false;
     //Arrow Keys Camera Movement
     if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
     {
         camera.orbit(cameraSpeed, 0.f);
+        moved = true;
     }
     if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
     {
         camera.orbit(-cameraSpeed, 0.f);
+        moved = true;
     }
     if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
     {
         camera.orbit(0.f, cameraSpeed);
+        moved = true;
     }
     if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
     {
         camera.orbit(0.f, -cameraSpeed);
+        moved = true;
     }
 
     //Fov controls
     if (glfwGetKey(window, GLFW_KEY_LEFT_BRACKET) == GLFW_PRESS)
     {
         camera.narrowFov();
+        moved = true;
     }
     if (glfwGetKey(window, GLFW_KEY_RIGHT_BRACKET) == GLFW_PRESS)
     {
         camera.widenFov();
+        moved = true;
     }
+    return moved;
 }
 
 void mouse_callback(GLFWwindow* window, double x_pos, double y_pos)
 {
+    request_redraw();
     if (first_mouse)
     {
         last_x = x_pos;
@@ -320,9 +727,153 @@ void mouse_callback(GLFWwindow* window, double x_pos, double y_pos)
 
 void scroll_callback(GLFWwindow* window, double x_offset, double y_offset)
 {
+    request_redraw();
     camera.zoom(y_offset);
 }
 
+// Draw the next few frames, see REDRAW_FRAMES
+void request_redraw()
+{
+    redraw_frames = REDRAW_FRAMES;
+}
+
+// User and system CPU time of the process, all threads
+double process_cpu_seconds()
+{
+#ifdef _WIN32
+    FILETIME creation, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exited, &kernel, &user))
+        return 0.0;
+    auto seconds = [](const FILETIME& time) { return (double(time.dwHighDateTime) * 4294967296.0 + time.dwLowDateTime) * 1e-7; };
+    return seconds(kernel) + seconds(user);
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+// Lights section of the menu: add, edit and remove scene lights
+void lights_window(ClusteredLights& lights)
+{
+    if (!ImGui::TreeNode("Lights"))
+        return;
+    ImGui::Checkbox("Camera light", &menu.isCameraLight());
+    const glm::vec3 eye = camera.getPosition();
+    Light light;
+    if (ImGui::Button("Add point")) {
+        light.position = eye * 0.5f;
+        lights.addLight(light);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Add spot")) {
+        light.type = Light::Spot;
+        light.position = eye;
+        light.direction = -eye;
+        light.range = glm::length(eye) * 2.0f;
+        lights.addLight(light);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Add directional")) {
+        light.type = Light::Directional;
+        light.direction = glm::vec3(-1.0f, -1.0f, -1.0f);
+        light.intensity = 0.5f;
+        lights.addLight(light);
+    }
+    // Scatter lights through the model to see how clustering scales
+    if (ImGui::Button("Add 100 random")) {
+        glm::vec3 boundsMin, boundsMax;
+        if (model.getBounds(boundsMin, boundsMax)) {
+            const glm::mat4 transform = Model::getModelMatrix(&menu);
+            glm::vec3 worldMin(FLT_MAX), worldMax(-FLT_MAX);
+            for (int corner = 0; corner < 8; corner++) {
+                glm::vec3 world = glm::vec3(transform * glm::vec4(corner & 1 ? boundsMax.x : boundsMin.x,
+                    corner & 2 ? boundsMax.y : boundsMin.y, corner & 4 ? boundsMax.z : boundsMin.z, 1.0f));
+                worldMin = glm::min(worldMin, world);
+                worldMax = glm::max(worldMax, world);
+            }
+            lights.addRandomLights(100, worldMin, worldMax, (unsigned int)lights.getLights().size() + 1);
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Remove all"))
+        lights.clear();
+    ImGui::Text("%zu lights, %.1f per lit cluster (max %u), binned in %.2f ms", lights.getLights().size(),
+        lights.getAverageLightsPerCluster(), lights.getMaxLightsPerCluster(), lights.getBinningTime() * 1000.0);
+
+    bool changed = false;
+    int removed = -1;
+    std::vector<Light>& list = lights.getLights();
+    for (size_t i = 0; i < list.size(); i++) {
+        Light& edited = list[i];
+        ImGui::PushID((int)i);
+        static const char* types[] = { "Point", "Spot", "Directional" };
+        if (ImGui::TreeNode("light", "%s light %zu", types[edited.type], i)) {
+            int type = edited.type;
+            if (ImGui::Combo("Type", &type, "Point\0Spot\0Directional\0")) {
+                edited.type = (Light::Type)type;
+                changed = true;
+            }
+            if (edited.type != Light::Directional)
+                changed |= ImGui::DragFloat3("Position", glm::value_ptr(edited.position), 0.05f);
+            if (edited.type != Light::Point)
+                changed |= ImGui::DragFloat3("Direction", glm::value_ptr(edited.direction), 0.02f);
+            changed |= ImGui::ColorEdit3("Color", glm::value_ptr(edited.color), ImGuiColorEditFlags_NoInputs);
+            changed |= ImGui::SliderFloat("Intensity", &edited.intensity, 0.0f, 10.0f);
+            if (edited.type != Light::Directional)
+                changed |= ImGui::SliderFloat("Range", &edited.range, 0.01f, 50.0f);
+            if (edited.type == Light::Spot) {
+                changed |= ImGui::SliderFloat("Inner angle", &edited.innerAngle, 0.0f, edited.outerAngle);
+                changed |= ImGui::SliderFloat("Outer angle", &edited.outerAngle, 1.0f, 89.0f);
+            }
+            if (ImGui::Button("Remove"))
+                removed = (int)i;
+            ImGui::TreePop();
+        }
+        ImGui::PopID();
+    }
+    if (removed >= 0)
+        lights.removeLight(removed);
+    if (changed)
+        lights.invalidate();
+    ImGui::TreePop();
+}
+
+// Producer of the streaming demo: a rippling surface, recomputed and pushed
+// at about 120 Hz until running is cleared
+void stream_wave(DynamicMesh* mesh, std::atomic<bool>* running)
+{
+    Assimp::Profiling::Tracer::SetThreadName("stream producer");
+    std::vector<glm::vec3> positions(WAVE_SIZE * WAVE_SIZE), normals(WAVE_SIZE * WAVE_SIZE);
+    std::vector<unsigned int> indices;
+    indices.reserve((WAVE_SIZE - 1) * (WAVE_SIZE - 1) * 6);
+    for (unsigned int z = 0; z + 1 < WAVE_SIZE; z++) {
+        for (unsigned int x = 0; x + 1 < WAVE_SIZE; x++) {
+            unsigned int i = z * WAVE_SIZE + x;
+            indices.insert(indices.end(), { i, i + WAVE_SIZE, i + 1, i + 1, i + WAVE_SIZE, i + WAVE_SIZE + 1 });
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (*running) {
+        ASSIMP_TRACE_SCOPE("wave");
+        float time = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+        for (unsigned int z = 0; z < WAVE_SIZE; z++) {
+            for (unsigned int x = 0; x < WAVE_SIZE; x++) {
+                float u = 2.0f * x / (WAVE_SIZE - 1) - 1.0f, v = 2.0f * z / (WAVE_SIZE - 1) - 1.0f;
+                float r = std::sqrt(u * u + v * v) + 1e-6f;
+                // Height and its derivative along r
+                float height = 0.1f * std::sin(12.0f * r - 3.0f * time);
+                float slope = 1.2f * std::cos(12.0f * r - 3.0f * time);
+                positions[z * WAVE_SIZE + x] = glm::vec3(u, height, v);
+                normals[z * WAVE_SIZE + x] = glm::normalize(glm::vec3(-slope * u / r, 1.0f, -slope * v / r));
+            }
+        }
+        mesh->push(positions.data(), normals.data(), WAVE_SIZE * WAVE_SIZE, indices.data(), (unsigned int)indices.size());
+        std::this_thread::sleep_for(std::chrono::milliseconds(8));
+    }
+}
+
 inline bool file_exists(const std::string& name) {
     if (FILE* file = fopen(name.c_str(), "r")) {
         fclose(file);
@@ -331,4 +882,18 @@ inline bool file_exists(const std::string& name) {
     else {
         return false;
     }
-}
\ No newline at end of file
+}
+// Every variant keeps its own uniforms, so each one drawn with is set up
+void set_frame_uniforms(Shader& shader, ClusteredLights& lights, const glm::mat4& projection, const CascadedShadowMap* shadows)
+{
+    shader.setMat4("model", Model::getModelMatrix(&menu));
+    shader.setMat4("view", camera.getViewMatrix());
+    shader.setMat4("projection", projection);
+    shader.setVec3("light.position", camera.getPosition());
+    shader.setVec3("view_pos", camera.getPosition());
+    shader.setFloat("distance", menu.getExplodeDistance());
+    shader.reloadValues(&menu);
+    lights.apply(shader);
+    if (shadows)
+        shadows->apply(shader);
+}
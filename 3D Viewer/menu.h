@@ -28,6 +28,9 @@ private:
 
 	float shininess;
 
+	//Explode distance along the face normals, 0 skips the geometry stage
+	float explodeDistance;
+
 	//Input
 	float mouseSensitivity, zoomSensitivity, fovSensitivity;
 
@@ -36,7 +39,44 @@ private:
 
 	bool wireFrame;
 
+	//Import
+	bool trustedInput;
+
+	//Rendering
+	bool frustumCulling;
+	bool occlusionCulling;
+	bool meshletCulling;
+	bool onDemandRendering;
+	bool adaptiveQuality;
+	bool dynamicResolution;
+	int targetFps;
+	float sharpness;
+	int antiAliasing;
+
+	//Profiling
+	bool recordTrace;
+
+	//Streaming
+	bool streamingDemo;
+
+	//Transparency
+	int transparencyMode;
+
+	//Lights
+	bool cameraLight;
+	bool shadows;
+	float lightAzimuth, lightElevation;
+
+	//Ambient occlusion
+	bool ambientOcclusion;
+	int ambientOcclusionSamples;
+
 public:
+	// How transparent materials are blended
+	enum TransparencyMode { WeightedBlendedTransparency, SortedTransparency };
+	// How the scene is anti-aliased, see SceneTarget
+	enum AntiAliasing { MultisampleAntiAliasing, FastApproximateAntiAliasing };
+
 	// Model Path
 	std::string& getObjectpath()  { return Objectpath; }
 	void setObjectpath( std::string& path) { Objectpath = path; }
@@ -78,6 +118,10 @@ public:
 	float& getShininess()  { return shininess; }
 	void setShininess(float value) { shininess = value; }
 
+	// Explode
+	float& getExplodeDistance()  { return explodeDistance; }
+	void setExplodeDistance(float distance) { explodeDistance = distance; }
+
 	// Input Sensitivity
 	float& getMouseSensitivity() { return mouseSensitivity; }
 	void setMouseSensitivity(float sensitivity) { mouseSensitivity = sensitivity; }
@@ -95,6 +139,76 @@ public:
 	// Wireframe
 	bool& isWireFrame()  { return wireFrame; }
 	void setWireFrame(bool state) { wireFrame = state; }
+
+	// Trusted input, skips validation on import
+	bool& isTrustedInput()  { return trustedInput; }
+	void setTrustedInput(bool state) { trustedInput = state; }
+
+	// Frustum culling, skips parts outside the view
+	bool& isFrustumCulling()  { return frustumCulling; }
+	void setFrustumCulling(bool state) { frustumCulling = state; }
+
+	// Occlusion culling, skips parts hidden behind the depth of an earlier frame
+	bool& isOcclusionCulling()  { return occlusionCulling; }
+	void setOcclusionCulling(bool state) { occlusionCulling = state; }
+
+	// Meshlet culling, skips clusters of large meshes that are outside the
+	// view or face away
+	bool& isMeshletCulling()  { return meshletCulling; }
+	void setMeshletCulling(bool state) { meshletCulling = state; }
+
+	// On-demand rendering, draws only after input, loads and resizes
+	bool& isOnDemandRendering()  { return onDemandRendering; }
+	void setOnDemandRendering(bool state) { onDemandRendering = state; }
+
+	// Adaptive quality, lower resolution while moving and refinement when still
+	bool& isAdaptiveQuality()  { return adaptiveQuality; }
+	void setAdaptiveQuality(bool state) { adaptiveQuality = state; }
+	int& getTargetFps()  { return targetFps; }
+	void setTargetFps(int fps) { targetFps = fps; }
+
+	// Resolution following the target FPS whenever frames change, upscaled
+	// with sharpening
+	bool& isDynamicResolution()  { return dynamicResolution; }
+	void setDynamicResolution(bool state) { dynamicResolution = state; }
+	float& getSharpness()  { return sharpness; }
+	void setSharpness(float amount) { sharpness = amount; }
+
+	// Multisampling or FXAA
+	int& getAntiAliasing()  { return antiAliasing; }
+	void setAntiAliasing(int mode) { antiAliasing = mode; }
+
+	// Trace recording, see Assimp::Profiling::Tracer
+	bool& isRecordingTrace()  { return recordTrace; }
+	void setRecordingTrace(bool state) { recordTrace = state; }
+
+	// Animated surface streamed from a producer thread, see DynamicMesh
+	bool& isStreamingDemo()  { return streamingDemo; }
+	void setStreamingDemo(bool state) { streamingDemo = state; }
+
+	// Weighted blended order-independent or sorted back to front
+	int& getTransparencyMode()  { return transparencyMode; }
+	void setTransparencyMode(int mode) { transparencyMode = mode; }
+
+	// Light following the camera, on top of the lights placed in the scene
+	bool& isCameraLight()  { return cameraLight; }
+	void setCameraLight(bool state) { cameraLight = state; }
+
+	// Shadows of the scene light, which then shines from a fixed direction
+	// instead of the camera. Azimuth and elevation in degrees
+	bool& isShadows()  { return shadows; }
+	void setShadows(bool state) { shadows = state; }
+	float& getLightAzimuth()  { return lightAzimuth; }
+	void setLightAzimuth(float degrees) { lightAzimuth = degrees; }
+	float& getLightElevation()  { return lightElevation; }
+	void setLightElevation(float degrees) { lightElevation = degrees; }
+
+	// Screen-space ambient occlusion, see AmbientOcclusion. Samples per
+	// half resolution pixel trade its quality against its cost
+	bool& isAmbientOcclusion()  { return ambientOcclusion; }
+	void setAmbientOcclusion(bool state) { ambientOcclusion = state; }
+	int& getAmbientOcclusionSamples()  { return ambientOcclusionSamples; }
+	void setAmbientOcclusionSamples(int samples) { ambientOcclusionSamples = samples; }
 	
 
 	Menu(Camera _camera) {
@@ -118,6 +232,8 @@ public:
 
 		shininess = 32.f;
 
+		explodeDistance = 0.f;
+
 		mouseSensitivity = .3f;
 		zoomSensitivity = .5f;
 		fovSensitivity = .4f;
@@ -125,5 +241,31 @@ public:
 		backgroundColor = glm::vec3(.2f, .2f, .2f);
 
 		wireFrame = false;
+
+		trustedInput = false;
+
+		frustumCulling = true;
+		occlusionCulling = true;
+		meshletCulling = false;
+		onDemandRendering = true;
+		adaptiveQuality = true;
+		dynamicResolution = true;
+		targetFps = 30;
+		sharpness = .5f;
+		antiAliasing = MultisampleAntiAliasing;
+
+		recordTrace = false;
+
+		streamingDemo = false;
+
+		transparencyMode = WeightedBlendedTransparency;
+
+		cameraLight = true;
+		shadows = false;
+		lightAzimuth = 60.f;
+		lightElevation = 50.f;
+
+		ambientOcclusion = false;
+		ambientOcclusionSamples = 8;
 	}
 };
\ No newline at end of file
@@ -2,62 +2,67 @@
 
 #include <vector>
 #include "glm/glm.hpp"
-#include "shader.h"
-
-struct Vertex
-{
-    glm::vec3 Position;
-    glm::vec3 Normal;
-};
+#include "meshlets.h"
 
+// A mesh stored in one of MeshBatch's shared pages. Its vertices start at
+// baseVertex and its indices at firstIndex of the page buffers, so every
+// mesh of a page draws from the same vertex array
 class Mesh
 {
 public:
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices)
-        : m_vertices(vertices), m_indices(indices) {
-        setupMesh();
-    }
-
-    void Draw(Shader shader) {
-        GLenum error = glGetError();
-        glBindVertexArray(m_vao);
-        glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);  // Unbind vao
-        if (error != GL_NO_ERROR) {
-            std::cerr << "OpenGL Error: " << error << std::endl;
-        }
+    Mesh(unsigned int page, unsigned int baseVertex, unsigned int firstIndex, unsigned int numVertices,
+        unsigned int numIndices, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+        : m_page(page), m_baseVertex(baseVertex), m_firstIndex(firstIndex), m_numVertices(numVertices),
+        m_numIndices(numIndices), m_boundsMin(boundsMin), m_boundsMax(boundsMax),
+        // Drawn once and untransformed until instances are set
+        m_instances(1, glm::mat4(1.0f)) {
     }
 
-private:
-    void setupMesh() {
-        GLenum error = glGetError();
-        glGenVertexArrays(1, &m_vao);
-        glGenBuffers(1, &m_vbo);
-        glGenBuffers(1, &m_ibo);
-
-        glBindVertexArray(m_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    // Per-instance model matrices, one draw command renders all of them
+    void setInstances(const std::vector<glm::mat4>& transforms) { m_instances = transforms; }
+    const std::vector<glm::mat4>& getInstances() const { return m_instances; }
 
-        glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(Vertex),
-            &m_vertices[0], GL_STATIC_DRAW);
+    // Index into the model's materials, and that material's opacity.
+    // Meshes below 1 are drawn in the transparent pass
+    void setMaterial(unsigned int material) { m_material = material; }
+    unsigned int getMaterial() const { return m_material; }
+    void setOpacity(float opacity) { m_opacity = opacity; }
+    float getOpacity() const { return m_opacity; }
+    bool isTransparent() const { return m_opacity < 1.0f; }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int),
-            &m_indices[0], GL_STATIC_DRAW);
+    unsigned int getPage() const { return m_page; }
+    unsigned int getBaseVertex() const { return m_baseVertex; }
+    unsigned int getFirstIndex() const { return m_firstIndex; }
+    unsigned int getNumVertices() const { return m_numVertices; }
+    unsigned int getNumIndices() const { return m_numIndices; }
+    // Coarse version of the triangles over the same vertices, for views
+    // that move faster than the full mesh can be drawn. None when 0
+    void setCoarseIndices(unsigned int firstIndex, unsigned int numIndices) {
+        m_coarseFirstIndex = firstIndex;
+        m_numCoarseIndices = numIndices;
+    }
+    unsigned int getCoarseFirstIndex() const { return m_coarseFirstIndex; }
+    unsigned int getNumCoarseIndices() const { return m_numCoarseIndices; }
+    // Clusters of the full indices culled one by one, see Meshlets. Empty
+    // for small meshes
+    Meshlets& getMeshlets() { return m_meshlets; }
+    const Meshlets& getMeshlets() const { return m_meshlets; }
+    // Object space bounding box, used for culling
+    const glm::vec3& getBoundsMin() const { return m_boundsMin; }
+    const glm::vec3& getBoundsMax() const { return m_boundsMax; }
 
-        // Vertex positions
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-        // Vertex normals
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    unsigned int getNumInstances() const { return (unsigned int)m_instances.size(); }
+    // Vertex and index bytes, shared by all instances
+    size_t getMeshMemory() const { return m_numVertices * 2 * sizeof(glm::vec3) + (m_numIndices + m_numCoarseIndices) * sizeof(unsigned int); }
+    size_t getInstanceMemory() const { return m_instances.size() * sizeof(glm::mat4); }
 
-        glBindVertexArray(0);
-        if (error != GL_NO_ERROR) {
-            std::cerr << "OpenGL Error: " << error << std::endl;
-        }
-    }
-    unsigned int m_vao, m_vbo, m_ibo;
-    std::vector<Vertex> m_vertices;
-    std::vector<unsigned int> m_indices;
+private:
+    unsigned int m_page, m_baseVertex, m_firstIndex;
+    unsigned int m_numVertices, m_numIndices;
+    unsigned int m_coarseFirstIndex = 0, m_numCoarseIndices = 0;
+    Meshlets m_meshlets;
+    glm::vec3 m_boundsMin, m_boundsMax;
+    std::vector<glm::mat4> m_instances;
+    unsigned int m_material = 0;
+    float m_opacity = 1.0f;
 };
@@ -0,0 +1,507 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <GLFW/glfw3.h>
+#include "glm/glm.hpp"
+#include "mesh.h"
+#include "depthpyramid.h"
+
+// Not in the 4.1 loader, GL 4.3 / ARB_multi_draw_indirect
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+// Layout glMultiDrawElementsIndirect reads from the indirect buffer
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Stores the vertices and indices of all meshes in a few large pages with one
+// vertex format (position and normal blocks) and draws each page with a single
+// multi-draw call. The command list holds one entry per mesh and is rebuilt by
+// cull(), which drops meshes whose instances are all outside the frustum or
+// hidden.
+// Opaque meshes come first in the list and transparent ones after them, so
+// each pass is one contiguous range. Large meshes also store coarse indices
+// after their own, which cull() can pick instead while the view moves, and
+// are split into meshlets so cull() can draw only the clusters that show
+class MeshBatch
+{
+public:
+    // Commands issued by Draw()
+    enum class Pass { All, Opaque, Transparent };
+
+    // Suballocate the mesh in a page with room for it. Normals may be null,
+    // the normal block then stays zero for this mesh
+    Mesh& add(const glm::vec3* positions, const glm::vec3* normals, unsigned int numVertices,
+        const unsigned int* indices, unsigned int numIndices) {
+        std::vector<unsigned int> coarse;
+        if (numIndices / 3 >= coarseMinTriangles)
+            coarse = simplify(positions, numVertices, indices, numIndices);
+        unsigned int pageIndex = allocatePage(numVertices, numIndices + (unsigned int)coarse.size());
+        Page& page = *m_pages[pageIndex];
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, page.vbo);
+        const GLsizeiptr blockSize = numVertices * sizeof(glm::vec3);
+        const GLintptr offset = page.numVertices * sizeof(glm::vec3);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, blockSize, positions);
+        if (normals) {
+            glBufferSubData(GL_COPY_WRITE_BUFFER, page.vertexCapacity * sizeof(glm::vec3) + offset, blockSize, normals);
+        }
+        else {
+            std::vector<glm::vec3> zero(numVertices, glm::vec3(0.0f));
+            glBufferSubData(GL_COPY_WRITE_BUFFER, page.vertexCapacity * sizeof(glm::vec3) + offset, blockSize, zero.data());
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, page.ibo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, page.numIndices * sizeof(unsigned int), numIndices * sizeof(unsigned int), indices);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (page.numIndices + numIndices) * sizeof(unsigned int), coarse.size() * sizeof(unsigned int),
+            coarse.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+        if (numVertices) {
+            boundsMin = boundsMax = positions[0];
+            for (unsigned int i = 1; i < numVertices; i++) {
+                boundsMin = glm::min(boundsMin, positions[i]);
+                boundsMax = glm::max(boundsMax, positions[i]);
+            }
+        }
+
+        m_meshes.emplace_back(pageIndex, page.numVertices, page.numIndices, numVertices, numIndices, boundsMin, boundsMax);
+        m_meshes.back().setCoarseIndices(page.numIndices + numIndices, (unsigned int)coarse.size());
+        if (numIndices / 3 >= meshletMinTriangles)
+            m_meshes.back().getMeshlets().build(positions, numVertices, indices, numIndices);
+        page.numVertices += numVertices;
+        page.numIndices += numIndices + (unsigned int)coarse.size();
+        changed();
+        return m_meshes.back();
+    }
+    // Instances changed after add()
+    void invalidate() { changed(); }
+    // Opacity of all meshes using the material
+    void setOpacity(unsigned int material, float opacity) {
+        for (Mesh& mesh : m_meshes) {
+            if (mesh.getMaterial() == material)
+                mesh.setOpacity(opacity);
+        }
+        changed();
+    }
+    // Changes whenever meshes, instances or opacities do, unique across
+    // batches, so anything derived from the geometry knows to rebuild
+    unsigned int getVersion() const { return m_version; }
+
+    // Rebuild the instance and command lists of every page. With frustum set,
+    // only instances whose bounding box touches the frustum of viewProjection
+    // (projection * view * model) are kept and empty commands are dropped.
+    // With sortTransparent, transparent instances are instead drawn one by
+    // one from back to front, for blending without order-independent
+    // transparency. This sorts every visible transparent instance each frame.
+    // With coarse, meshes that have coarse indices draw those. With
+    // occluders, instances behind the depth of an earlier frame are dropped
+    // too; occluderModelViewProjection is the pyramid's view projection times
+    // the model matrix. With frustum and meshlets, visible instances of
+    // opaque meshes with meshlets get one command per run of clusters that
+    // are in the frustum and not facing away, drawn with multi-draw only
+    void cull(const glm::mat4& viewProjection, bool frustum, bool sortTransparent = false, bool coarse = false,
+        const DepthPyramid* occluders = nullptr, const glm::mat4& occluderModelViewProjection = glm::mat4(1.0f),
+        bool meshlets = false) {
+        if (occluders && !occluders->isReady())
+            occluders = nullptr;
+        // The full list is still uploaded
+        if (!frustum && !sortTransparent && !coarse && !occluders && !m_dirty && !m_culled && !m_sortTransparent && !m_coarse)
+            return;
+
+        // Frustum planes of the clip space transform, pointing inwards. Clip
+        // space w is also the view depth used for sorting
+        const glm::vec4 w(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+        glm::vec4 planes[6];
+        for (int i = 0; i < 3; i++) {
+            glm::vec4 row(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+            planes[2 * i] = w + row;
+            planes[2 * i + 1] = w - row;
+        }
+
+        for (auto& page : m_pages) {
+            page->commands.clear();
+            page->transparentCommands.clear();
+            page->instances.clear();
+            page->opacities.clear();
+        }
+        m_sortedDraws.clear();
+        m_numVisible = 0;
+        m_numOccluded = 0;
+        m_numMeshlets = 0;
+        m_numMeshletsDrawn = 0;
+        // Without multi-draw every run would be a draw call of its own
+        const bool clusters = frustum && meshlets && multiDrawElementsIndirect() != nullptr;
+        for (const Mesh& mesh : m_meshes) {
+            const unsigned int pageIndex = mesh.getPage();
+            Page& page = *m_pages[pageIndex];
+            const glm::vec3 center = (mesh.getBoundsMin() + mesh.getBoundsMax()) * 0.5f;
+            const glm::vec3 extent = (mesh.getBoundsMax() - mesh.getBoundsMin()) * 0.5f;
+            const unsigned int baseInstance = (unsigned int)page.instances.size();
+            const bool useCoarse = coarse && mesh.getNumCoarseIndices();
+            const unsigned int numIndices = useCoarse ? mesh.getNumCoarseIndices() : mesh.getNumIndices();
+            const unsigned int firstIndex = useCoarse ? mesh.getCoarseFirstIndex() : mesh.getFirstIndex();
+            const Meshlets& meshlets = mesh.getMeshlets();
+            const bool useMeshlets = clusters && !useCoarse && !mesh.isTransparent() && !meshlets.empty();
+            for (const glm::mat4& transform : mesh.getInstances()) {
+                if (frustum && !isVisible(planes, transform, center, extent))
+                    continue;
+                if (occluders && occluders->isOccluded(occluderModelViewProjection * transform, center, extent)) {
+                    m_numOccluded++;
+                    continue;
+                }
+                if (useMeshlets) {
+                    // Consecutive clusters are consecutive index runs, so
+                    // each run of visible ones is a single command
+                    const unsigned int instance = (unsigned int)page.instances.size();
+                    const size_t numCommands = page.commands.size();
+                    meshlets.cull(viewProjection * transform, [&](unsigned int begin, unsigned int end) {
+                        const unsigned int first = meshlets.getFirstIndex(begin);
+                        const unsigned int last = meshlets.getFirstIndex(end - 1) + meshlets.getNumIndices(end - 1);
+                        page.commands.push_back({ last - first, 1, firstIndex + first, (GLint)mesh.getBaseVertex(), instance });
+                        m_numMeshletsDrawn += end - begin;
+                    });
+                    m_numMeshlets += meshlets.size();
+                    if (page.commands.size() == numCommands)
+                        continue;
+                    page.instances.push_back(transform);
+                    page.opacities.push_back(mesh.getOpacity());
+                    m_numVisible++;
+                    continue;
+                }
+                if (sortTransparent && mesh.isTransparent()) {
+                    const float depth = glm::dot(w, transform * glm::vec4(center, 1.0f));
+                    m_sortedDraws.push_back({ depth, pageIndex, { numIndices, 1, firstIndex,
+                        (GLint)mesh.getBaseVertex(), (unsigned int)page.instances.size() } });
+                }
+                page.instances.push_back(transform);
+                page.opacities.push_back(mesh.getOpacity());
+            }
+            const unsigned int count = (unsigned int)page.instances.size() - baseInstance;
+            if (count && !useMeshlets) {
+                DrawElementsIndirectCommand command = { numIndices, count, firstIndex, (GLint)mesh.getBaseVertex(), baseInstance };
+                (mesh.isTransparent() ? page.transparentCommands : page.commands).push_back(command);
+                m_numVisible += count;
+            }
+        }
+        for (auto& page : m_pages) {
+            page->numOpaque = (unsigned int)page->commands.size();
+            page->commands.insert(page->commands.end(), page->transparentCommands.begin(), page->transparentCommands.end());
+        }
+
+        // Farthest first, then one multi-draw per run of the same page
+        std::sort(m_sortedDraws.begin(), m_sortedDraws.end(),
+            [](const SortedDraw& a, const SortedDraw& b) { return a.depth > b.depth; });
+        m_sortedCommands.clear();
+        m_sortedRuns.clear();
+        for (const SortedDraw& draw : m_sortedDraws) {
+            if (m_sortedRuns.empty() || m_sortedRuns.back().page != draw.page)
+                m_sortedRuns.push_back({ draw.page, (unsigned int)m_sortedCommands.size(), 0 });
+            m_sortedCommands.push_back(draw.command);
+            m_sortedRuns.back().count++;
+        }
+
+        // Orphan and refill, the previous frame may still read the old data
+        const bool multiDraw = multiDrawElementsIndirect() != nullptr;
+        for (auto& page : m_pages) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, page->instanceVbo);
+            glBufferData(GL_COPY_WRITE_BUFFER, page->instances.size() * sizeof(glm::mat4), page->instances.data(), GL_STREAM_DRAW);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, page->opacityVbo);
+            glBufferData(GL_COPY_WRITE_BUFFER, page->opacities.size() * sizeof(float), page->opacities.data(), GL_STREAM_DRAW);
+            if (multiDraw) {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, page->indirectBuffer);
+                glBufferData(GL_COPY_WRITE_BUFFER, page->commands.size() * sizeof(DrawElementsIndirectCommand),
+                    page->commands.data(), GL_STREAM_DRAW);
+            }
+        }
+        if (multiDraw && !m_sortedCommands.empty()) {
+            if (!m_sortedIndirectBuffer.id)
+                glGenBuffers(1, &m_sortedIndirectBuffer.id);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_sortedIndirectBuffer.id);
+            glBufferData(GL_COPY_WRITE_BUFFER, m_sortedCommands.size() * sizeof(DrawElementsIndirectCommand),
+                m_sortedCommands.data(), GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        m_dirty = false;
+        m_culled = frustum || occluders;
+        m_sortTransparent = sortTransparent;
+        m_coarse = coarse;
+    }
+
+    // One call per page with multi-draw indirect, one per command otherwise.
+    // Sorted transparent instances are drawn last, in their order
+    void Draw(Pass pass = Pass::All) {
+        if (m_dirty)
+            cull(glm::mat4(1.0f), false);
+        GLenum error = glGetError();
+        m_numDrawCalls = 0;
+        for (auto& page : m_pages) {
+            const unsigned int first = pass == Pass::Transparent ? page->numOpaque : 0;
+            const unsigned int last = pass == Pass::Opaque || m_sortTransparent ? page->numOpaque : (unsigned int)page->commands.size();
+            if (first < last)
+                drawCommands(*page, page->indirectBuffer, page->commands.data(), first, last - first);
+        }
+        if (pass != Pass::Opaque) {
+            for (const SortedRun& run : m_sortedRuns)
+                drawCommands(*m_pages[run.page], m_sortedIndirectBuffer.id, m_sortedCommands.data(), run.first, run.count);
+        }
+        glBindVertexArray(0);  // Unbind vao
+        if (error != GL_NO_ERROR) {
+            std::cerr << "OpenGL Error: " << error << std::endl;
+        }
+    }
+
+    const std::vector<Mesh>& getMeshes() const { return m_meshes; }
+    // GL draw calls issued by the last Draw()
+    unsigned int getNumDrawCalls() const { return m_numDrawCalls; }
+    // Instances that passed the last cull(), and those it found occluded
+    unsigned int getNumVisible() const { return m_numVisible; }
+    unsigned int getNumOccluded() const { return m_numOccluded; }
+    // Clusters of the instances the last cull() tested by meshlet, and those
+    // it drew
+    unsigned int getNumMeshlets() const { return m_numMeshlets; }
+    unsigned int getNumMeshletsDrawn() const { return m_numMeshletsDrawn; }
+    // Whether the last cull() kept any transparent instance
+    bool hasTransparency() const {
+        if (!m_sortedDraws.empty())
+            return true;
+        for (const auto& page : m_pages) {
+            if (page->numOpaque < page->commands.size())
+                return true;
+        }
+        return false;
+    }
+
+private:
+    // Shared buffers of a group of meshes. Positions fill the first half of
+    // the vertex buffer and normals the second, both indexed by baseVertex
+    struct Page {
+        unsigned int vao, vbo, ibo, instanceVbo, opacityVbo, indirectBuffer;
+        unsigned int vertexCapacity, indexCapacity;
+        unsigned int numVertices = 0, numIndices = 0;
+        // Built by cull(), the first numOpaque commands are opaque
+        std::vector<DrawElementsIndirectCommand> commands, transparentCommands;
+        unsigned int numOpaque = 0;
+        std::vector<glm::mat4> instances;
+        std::vector<float> opacities;
+
+        Page(unsigned int vertices, unsigned int indices) : vertexCapacity(vertices), indexCapacity(indices) {
+            glGenVertexArrays(1, &vao);
+            glGenBuffers(1, &vbo);
+            glGenBuffers(1, &ibo);
+            glGenBuffers(1, &instanceVbo);
+            glGenBuffers(1, &opacityVbo);
+            glGenBuffers(1, &indirectBuffer);
+
+            glBindVertexArray(vao);
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glBufferData(GL_ARRAY_BUFFER, vertexCapacity * 2 * sizeof(glm::vec3), NULL, GL_STATIC_DRAW);
+            // Vertex positions
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+            // Vertex normals
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)(vertexCapacity * sizeof(glm::vec3)));
+
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+
+            // Instance model matrix, one column per attribute, and opacity,
+            // advancing once per instance
+            for (unsigned int attribute = 2; attribute <= 6; attribute++) {
+                glEnableVertexAttribArray(attribute);
+                glVertexAttribDivisor(attribute, 1);
+            }
+            setInstanceAttributes(*this, 0);
+
+            glBindVertexArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        ~Page() {
+            glDeleteVertexArrays(1, &vao);
+            glDeleteBuffers(1, &vbo);
+            glDeleteBuffers(1, &ibo);
+            glDeleteBuffers(1, &instanceVbo);
+            glDeleteBuffers(1, &opacityVbo);
+            glDeleteBuffers(1, &indirectBuffer);
+        }
+        Page(const Page&) = delete;
+        Page& operator=(const Page&) = delete;
+    };
+
+    // First page size, later pages double up to the maximum. A larger mesh
+    // gets a page of its own size
+    static const unsigned int firstPageVertices = 1u << 18;
+    static const unsigned int firstPageIndices = 1u << 20;
+    static const unsigned int maxPageVertices = 1u << 22;
+    static const unsigned int maxPageIndices = 1u << 24;
+    // Smallest mesh given coarse indices, smaller ones draw fast enough
+    static const unsigned int coarseMinTriangles = 1u << 16;
+    // Smallest mesh split into meshlets, below it the extra commands cost
+    // more than the triangles they skip
+    static const unsigned int meshletMinTriangles = 1u << 14;
+
+    // A transparent instance in back to front order
+    struct SortedDraw {
+        float depth;
+        unsigned int page;
+        DrawElementsIndirectCommand command;
+    };
+    // Consecutive sorted commands of one page
+    struct SortedRun {
+        unsigned int page, first, count;
+    };
+
+    std::vector<std::unique_ptr<Page>> m_pages;
+    std::vector<Mesh> m_meshes;
+    std::vector<SortedDraw> m_sortedDraws;
+    std::vector<DrawElementsIndirectCommand> m_sortedCommands;
+    std::vector<SortedRun> m_sortedRuns;
+    // Created on first use, moves with the batch
+    struct IndirectBuffer {
+        unsigned int id = 0;
+        IndirectBuffer() = default;
+        IndirectBuffer(IndirectBuffer&& other) noexcept : id(other.id) { other.id = 0; }
+        IndirectBuffer& operator=(IndirectBuffer&& other) noexcept { std::swap(id, other.id); return *this; }
+        ~IndirectBuffer() {
+            if (id)
+                glDeleteBuffers(1, &id);
+        }
+    } m_sortedIndirectBuffer;
+    bool m_dirty = false;
+    unsigned int m_version = nextVersion();
+    bool m_culled = false;
+    bool m_sortTransparent = false;
+    bool m_coarse = false;
+    unsigned int m_numDrawCalls = 0;
+    unsigned int m_numVisible = 0;
+    unsigned int m_numOccluded = 0;
+    unsigned int m_numMeshlets = 0, m_numMeshletsDrawn = 0;
+
+    void changed() {
+        m_dirty = true;
+        m_version = nextVersion();
+    }
+    static unsigned int nextVersion() {
+        static unsigned int version = 0;
+        return ++version;
+    }
+
+    unsigned int allocatePage(unsigned int numVertices, unsigned int numIndices) {
+        for (unsigned int i = 0; i < m_pages.size(); i++) {
+            const Page& page = *m_pages[i];
+            if (page.numVertices + numVertices <= page.vertexCapacity && page.numIndices + numIndices <= page.indexCapacity)
+                return i;
+        }
+        unsigned int vertices = firstPageVertices, indices = firstPageIndices;
+        if (!m_pages.empty()) {
+            vertices = std::min(m_pages.back()->vertexCapacity * 2, maxPageVertices);
+            indices = std::min(m_pages.back()->indexCapacity * 2, maxPageIndices);
+        }
+        m_pages.emplace_back(new Page(std::max(vertices, numVertices), std::max(indices, numIndices)));
+        return (unsigned int)m_pages.size() - 1;
+    }
+
+    // Draw count commands of the page starting at first, from indirectBuffer
+    // with multi-draw indirect or one by one from commands
+    void drawCommands(Page& page, unsigned int indirectBuffer, const DrawElementsIndirectCommand* commands,
+        unsigned int first, unsigned int count) {
+        glBindVertexArray(page.vao);
+        if (MultiDrawElementsIndirectProc multiDraw = multiDrawElementsIndirect()) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+            multiDraw(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(first * sizeof(DrawElementsIndirectCommand)), (GLsizei)count, 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+            m_numDrawCalls++;
+            return;
+        }
+        // No base instance before GL 4.2, point the instance
+        // attributes at the command's first instance instead
+        for (unsigned int i = first; i < first + count; i++) {
+            const DrawElementsIndirectCommand& command = commands[i];
+            setInstanceAttributes(page, command.baseInstance);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+                (void*)(command.firstIndex * sizeof(unsigned int)), command.instanceCount, command.baseVertex);
+            m_numDrawCalls++;
+        }
+        setInstanceAttributes(page, 0);
+    }
+
+    // Point the matrix columns and the opacity at the instance buffers,
+    // starting at baseInstance. Expects the page's vao to be bound
+    static void setInstanceAttributes(const Page& page, unsigned int baseInstance) {
+        const size_t offset = baseInstance * sizeof(glm::mat4);
+        glBindBuffer(GL_ARRAY_BUFFER, page.instanceVbo);
+        for (unsigned int column = 0; column < 4; column++)
+            glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(offset + column * sizeof(glm::vec4)));
+        glBindBuffer(GL_ARRAY_BUFFER, page.opacityVbo);
+        glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)(baseInstance * sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // Coarse triangles by vertex clustering (Rossignac and Borrel): vertices
+    // in the same cell of a grid over the bounds merge into the cell's first
+    // vertex and triangles that collapse are dropped. The grid is sized so a
+    // surface keeps about a tenth of its vertices, and the result indexes
+    // the mesh's own vertices, so no vertex is added
+    static std::vector<unsigned int> simplify(const glm::vec3* positions, unsigned int numVertices,
+        const unsigned int* indices, unsigned int numIndices) {
+        glm::vec3 boundsMin = positions[0], boundsMax = positions[0];
+        for (unsigned int i = 1; i < numVertices; i++) {
+            boundsMin = glm::min(boundsMin, positions[i]);
+            boundsMax = glm::max(boundsMax, positions[i]);
+        }
+        const uint64_t cells = std::clamp<uint64_t>((uint64_t)std::sqrt(numVertices / 32.0), 4, 1024);
+        const glm::vec3 toCell = glm::vec3((float)cells) / glm::max(boundsMax - boundsMin, glm::vec3(1e-20f));
+
+        std::vector<unsigned int> representative(numVertices);
+        std::unordered_map<uint64_t, unsigned int> firstInCell;
+        firstInCell.reserve(numVertices / 4);
+        for (unsigned int i = 0; i < numVertices; i++) {
+            const glm::vec3 cell = glm::min((positions[i] - boundsMin) * toCell, glm::vec3((float)(cells - 1)));
+            const uint64_t key = (uint64_t)cell.x + cells * ((uint64_t)cell.y + cells * (uint64_t)cell.z);
+            representative[i] = firstInCell.emplace(key, i).first->second;
+        }
+
+        std::vector<unsigned int> coarse;
+        for (unsigned int i = 0; i + 2 < numIndices; i += 3) {
+            const unsigned int a = representative[indices[i]], b = representative[indices[i + 1]], c = representative[indices[i + 2]];
+            if (a != b && b != c && a != c)
+                coarse.insert(coarse.end(), { a, b, c });
+        }
+        return coarse;
+    }
+
+    // World space box of the instance against the inward frustum planes
+    static bool isVisible(const glm::vec4* planes, const glm::mat4& transform, const glm::vec3& center, const glm::vec3& extent) {
+        const glm::vec3 c = glm::vec3(transform * glm::vec4(center, 1.0f));
+        const glm::vec3 e = glm::abs(glm::vec3(transform[0])) * extent.x + glm::abs(glm::vec3(transform[1])) * extent.y +
+            glm::abs(glm::vec3(transform[2])) * extent.z;
+        for (int i = 0; i < 6; i++) {
+            const glm::vec3 normal(planes[i]);
+            if (glm::dot(normal, c) + glm::dot(glm::abs(normal), e) + planes[i].w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    // Loaded once a context is current. Null on GL 4.1 without the
+    // extension, Draw() then loops over the commands
+    static MultiDrawElementsIndirectProc multiDrawElementsIndirect() {
+        static MultiDrawElementsIndirectProc proc =
+            (GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3) || glfwExtensionSupported("GL_ARB_multi_draw_indirect"))
+            ? (MultiDrawElementsIndirectProc)glfwGetProcAddress("glMultiDrawElementsIndirect") : nullptr;
+        return proc;
+    }
+};
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+#include "cachefolder.h"
+#include "glm/glm.hpp"
+#include "workerpool.h"
+#include <assimp/include/Tracer.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VIEWER_MESHLETS_SSE2
+#endif
+
+// Small clusters of a mesh's triangles, each a run of its index list with a
+// bounding sphere and a cone around its triangle normals, so parts of one
+// large mesh can be culled: clusters outside the frustum, or whose triangles
+// all face away from the eye. Runs are cut from the index order as it is,
+// after at most MAX_VERTICES vertices or MAX_TRIANGLES triangles, like
+// meshoptimizer's scan builder: the importer's cache optimization already
+// keeps consecutive triangles together, and the indices need no reordering.
+//
+// Building is split into chunks of triangles built in parallel, and the
+// result is cached on disk under a hash of the vertices and indices
+class Meshlets
+{
+public:
+    static const unsigned int MAX_VERTICES = 64;
+    static const unsigned int MAX_TRIANGLES = 124;
+
+    // Folder of the cached clusters, empty turns the cache off
+    static std::string& folder() {
+        static std::string folder = cacheFolder("meshlet_cache");
+        return folder;
+    }
+
+    // Clusters of the triangles, from the cache or built
+    void build(const glm::vec3* positions, unsigned int numVertices, const unsigned int* indices, unsigned int numIndices) {
+        ASSIMP_TRACE_SCOPE("meshlets");
+        const uint64_t key = hash(positions, numVertices, indices, numIndices);
+        if (!folder().empty() && load(key)) {
+            m_fromCache = true;
+            return;
+        }
+
+        // Chunks whose clusters do not depend on the number of threads
+        const unsigned int numTriangles = numIndices / 3;
+        const unsigned int chunkTriangles = MAX_TRIANGLES * 512;
+        std::vector<std::vector<Meshlet>> chunks((numTriangles + chunkTriangles - 1) / chunkTriangles);
+        pool().parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t chunk = begin; chunk < end; chunk++) {
+                const unsigned int first = (unsigned int)chunk * chunkTriangles;
+                buildRange(positions, indices, first, std::min(numTriangles, first + chunkTriangles), chunks[chunk]);
+            }
+        });
+        std::vector<Meshlet> meshlets;
+        for (const std::vector<Meshlet>& chunk : chunks)
+            meshlets.insert(meshlets.end(), chunk.begin(), chunk.end());
+        set(meshlets);
+        if (!folder().empty())
+            store(key, meshlets);
+    }
+
+    unsigned int size() const { return (unsigned int)m_firstIndex.size(); }
+    bool empty() const { return m_firstIndex.empty(); }
+    bool isFromCache() const { return m_fromCache; }
+    // Run of the mesh's indices drawn for cluster i
+    unsigned int getFirstIndex(unsigned int i) const { return m_firstIndex[i]; }
+    unsigned int getNumIndices(unsigned int i) const { return m_numIndices[i]; }
+
+    // Call visible(begin, end) for each run of consecutive clusters that may
+    // show under modelViewProjection, a perspective projection * view *
+    // model. Four clusters are tested at once with SSE2
+    template <typename Visible>
+    void cull(const glm::mat4& modelViewProjection, Visible visible) const {
+        // Frustum planes in model space, normalized so sphere distances are
+        // in model units
+        const glm::vec4 w(modelViewProjection[0][3], modelViewProjection[1][3], modelViewProjection[2][3], modelViewProjection[3][3]);
+        glm::vec4 planes[6];
+        for (int i = 0; i < 3; i++) {
+            const glm::vec4 row(modelViewProjection[0][i], modelViewProjection[1][i], modelViewProjection[2][i], modelViewProjection[3][i]);
+            planes[2 * i] = w + row;
+            planes[2 * i + 1] = w - row;
+        }
+        for (glm::vec4& plane : planes)
+            plane /= std::max(glm::length(glm::vec3(plane)), 1e-20f);
+
+        // The eye is the model space point where clip space x, y and w are
+        // zero. Cones are not tested without one (orthographic), or when a
+        // mirroring model matrix flips the winding: a GL perspective has a
+        // negative determinant, so the product does too unless mirrored
+        glm::vec4 eye = glm::inverse(modelViewProjection) * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+        const bool cones = std::abs(eye.w) > 1e-20f && glm::determinant(modelViewProjection) < 0.0f;
+        if (cones)
+            eye /= eye.w;
+
+        const unsigned int count = size();
+        unsigned int runStart = 0, runEnd = 0;
+        auto keep = [&](unsigned int i) {
+            if (runEnd != i || runEnd == runStart) {
+                if (runEnd > runStart)
+                    visible(runStart, runEnd);
+                runStart = i;
+            }
+            runEnd = i + 1;
+        };
+        unsigned int i = 0;
+#ifdef VIEWER_MESHLETS_SSE2
+        for (; i + 4 <= count; i += 4) {
+            const __m128 x = _mm_loadu_ps(&m_centerX[i]), y = _mm_loadu_ps(&m_centerY[i]), z = _mm_loadu_ps(&m_centerZ[i]);
+            const __m128 radius = _mm_loadu_ps(&m_radius[i]);
+            const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), radius);
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const glm::vec4& plane : planes) {
+                const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+                    _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+            }
+            if (cones) {
+                const __m128 dx = _mm_sub_ps(x, _mm_set1_ps(eye.x)), dy = _mm_sub_ps(y, _mm_set1_ps(eye.y)), dz = _mm_sub_ps(z, _mm_set1_ps(eye.z));
+                const __m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(&m_axisX[i])), _mm_mul_ps(dy, _mm_loadu_ps(&m_axisY[i]))),
+                    _mm_mul_ps(dz, _mm_loadu_ps(&m_axisZ[i])));
+                const __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+                const __m128 away = _mm_cmpge_ps(along, _mm_add_ps(_mm_mul_ps(distance, _mm_loadu_ps(&m_cutoff[i])), radius));
+                inside = _mm_andnot_ps(away, inside);
+            }
+            const int mask = _mm_movemask_ps(inside);
+            for (int lane = 0; lane < 4; lane++) {
+                if (mask >> lane & 1)
+                    keep(i + lane);
+            }
+        }
+#endif
+        for (; i < count; i++) {
+            const glm::vec3 center(m_centerX[i], m_centerY[i], m_centerZ[i]);
+            bool inside = true;
+            for (const glm::vec4& plane : planes)
+                inside = inside && glm::dot(glm::vec3(plane), center) + plane.w >= -m_radius[i];
+            if (inside && cones) {
+                const glm::vec3 toCenter = center - glm::vec3(eye);
+                const float along = glm::dot(toCenter, glm::vec3(m_axisX[i], m_axisY[i], m_axisZ[i]));
+                inside = along < glm::length(toCenter) * m_cutoff[i] + m_radius[i];
+            }
+            if (inside)
+                keep(i);
+        }
+        if (runEnd > runStart)
+            visible(runStart, runEnd);
+    }
+
+private:
+    // One cluster as built and cached. coneCutoff is the sine of the cone's
+    // half angle, or 1 when the triangles can face any way
+    struct Meshlet {
+        glm::vec3 center;
+        float radius;
+        glm::vec3 coneAxis;
+        float coneCutoff;
+        unsigned int firstIndex, numIndices;
+    };
+
+    // Structure of arrays for the SIMD test
+    std::vector<float> m_centerX, m_centerY, m_centerZ, m_radius;
+    std::vector<float> m_axisX, m_axisY, m_axisZ, m_cutoff;
+    std::vector<unsigned int> m_firstIndex, m_numIndices;
+    bool m_fromCache = false;
+
+    static WorkerPool& pool() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    void set(const std::vector<Meshlet>& meshlets) {
+        for (std::vector<float>* array : { &m_centerX, &m_centerY, &m_centerZ, &m_radius, &m_axisX, &m_axisY, &m_axisZ, &m_cutoff })
+            array->resize(meshlets.size());
+        m_firstIndex.resize(meshlets.size());
+        m_numIndices.resize(meshlets.size());
+        for (size_t i = 0; i < meshlets.size(); i++) {
+            const Meshlet& meshlet = meshlets[i];
+            m_centerX[i] = meshlet.center.x;
+            m_centerY[i] = meshlet.center.y;
+            m_centerZ[i] = meshlet.center.z;
+            m_radius[i] = meshlet.radius;
+            m_axisX[i] = meshlet.coneAxis.x;
+            m_axisY[i] = meshlet.coneAxis.y;
+            m_axisZ[i] = meshlet.coneAxis.z;
+            m_cutoff[i] = meshlet.coneCutoff;
+            m_firstIndex[i] = meshlet.firstIndex;
+            m_numIndices[i] = meshlet.numIndices;
+        }
+    }
+
+    // Scan triangles [first, last) into clusters
+    static void buildRange(const glm::vec3* positions, const unsigned int* indices, unsigned int first, unsigned int last,
+        std::vector<Meshlet>& meshlets) {
+        // Vertices of the current cluster, an open addressed set cleared
+        // with each cluster
+        const unsigned int slots = 128;
+        unsigned int set[slots];
+        std::fill(set, set + slots, ~0u);
+        unsigned int numVertices = 0, start = first;
+        auto insert = [&](unsigned int vertex, bool add) {
+            unsigned int slot = (vertex * 2654435761u) & (slots - 1);
+            for (; set[slot] != ~0u; slot = (slot + 1) & (slots - 1)) {
+                if (set[slot] == vertex)
+                    return 0u;
+            }
+            if (add)
+                set[slot] = vertex;
+            return 1u;
+        };
+        for (unsigned int triangle = first; triangle < last; triangle++) {
+            const unsigned int* corners = indices + 3 * triangle;
+            const unsigned int added = insert(corners[0], false) + insert(corners[1], false) + insert(corners[2], false);
+            if (numVertices + added > MAX_VERTICES || triangle - start >= MAX_TRIANGLES) {
+                meshlets.push_back(bounds(positions, indices, start, triangle));
+                std::fill(set, set + slots, ~0u);
+                numVertices = 0;
+                start = triangle;
+            }
+            for (int corner = 0; corner < 3; corner++)
+                numVertices += insert(corners[corner], true);
+        }
+        if (start < last)
+            meshlets.push_back(bounds(positions, indices, start, last));
+    }
+
+    // Sphere around the box of the cluster's corners, and the cone of its
+    // triangle normals around their average
+    static Meshlet bounds(const glm::vec3* positions, const unsigned int* indices, unsigned int first, unsigned int last) {
+        Meshlet meshlet;
+        glm::vec3 low(positions[indices[3 * first]]), high(low), axis(0.0f);
+        for (unsigned int i = 3 * first; i < 3 * last; i += 3) {
+            const glm::vec3 a = positions[indices[i]], b = positions[indices[i + 1]], c = positions[indices[i + 2]];
+            low = glm::min(low, glm::min(a, glm::min(b, c)));
+            high = glm::max(high, glm::max(a, glm::max(b, c)));
+            const glm::vec3 normal = glm::cross(b - a, c - a);
+            const float length = glm::length(normal);
+            if (length > 0.0f)
+                axis += normal / length;
+        }
+        meshlet.center = (low + high) * 0.5f;
+        meshlet.radius = 0.0f;
+        float minimum = 1.0f;
+        const float axisLength = glm::length(axis);
+        meshlet.coneAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+        for (unsigned int i = 3 * first; i < 3 * last; i += 3) {
+            const glm::vec3 a = positions[indices[i]], b = positions[indices[i + 1]], c = positions[indices[i + 2]];
+            meshlet.radius = std::max(meshlet.radius, std::max(glm::length(a - meshlet.center),
+                std::max(glm::length(b - meshlet.center), glm::length(c - meshlet.center))));
+            const glm::vec3 normal = glm::cross(b - a, c - a);
+            const float length = glm::length(normal);
+            if (length > 0.0f)
+                minimum = std::min(minimum, glm::dot(meshlet.coneAxis, normal / length));
+        }
+        // A cone of 90 degrees or more never faces away as a whole
+        meshlet.coneCutoff = axisLength > 0.0f && minimum > 0.0f ? std::sqrt(1.0f - minimum * minimum) : 1.0f;
+        meshlet.firstIndex = 3 * first;
+        meshlet.numIndices = 3 * (last - first);
+        return meshlet;
+    }
+
+    // FNV-1a over 64 bit words of the vertices and indices, and the limits
+    static uint64_t hash(const glm::vec3* positions, unsigned int numVertices, const unsigned int* indices, unsigned int numIndices) {
+        uint64_t hash = 14695981039346656037ull;
+        auto add = [&hash](const void* data, size_t size) {
+            const unsigned char* bytes = (const unsigned char*)data;
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                uint64_t word;
+                memcpy(&word, bytes + i, 8);
+                hash = (hash ^ word) * 1099511628211ull;
+            }
+            for (; i < size; i++)
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+        };
+        const unsigned int limits[3] = { MAX_VERTICES, MAX_TRIANGLES, (unsigned int)sizeof(Meshlet) };
+        add(limits, sizeof(limits));
+        add(positions, numVertices * sizeof(glm::vec3));
+        add(indices, numIndices * sizeof(unsigned int));
+        return hash;
+    }
+
+    static const uint32_t magic = 0x31544c4d; // "MLT1"
+
+    struct Header {
+        uint32_t magic;
+        uint32_t count;
+        uint64_t key;
+    };
+
+    static std::string path(uint64_t key) {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return (std::filesystem::path(folder()) / name).string();
+    }
+
+    bool load(uint64_t key) {
+        std::ifstream file(path(key), std::ios::binary);
+        Header header;
+        if (!file.read((char*)&header, sizeof(header)) || header.magic != magic || header.key != key)
+            return false;
+        std::vector<Meshlet> meshlets(header.count);
+        if (!file.read((char*)meshlets.data(), meshlets.size() * sizeof(Meshlet)))
+            return false;
+        set(meshlets);
+        return true;
+    }
+
+    // Written under a temporary name and renamed, like ProgramCache
+    static void store(uint64_t key, const std::vector<Meshlet>& meshlets) {
+        std::error_code error;
+        std::filesystem::create_directories(folder(), error);
+        const std::string target = path(key);
+        const std::string temporary = target + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary);
+            const Header header = { magic, (uint32_t)meshlets.size(), key };
+            file.write((const char*)&header, sizeof(header));
+            file.write((const char*)meshlets.data(), meshlets.size() * sizeof(Meshlet));
+            if (!file)
+                return;
+        }
+        std::filesystem::rename(temporary, target, error);
+        if (error)
+            std::filesystem::remove(temporary, error);
+    }
+};
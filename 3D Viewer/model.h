@@ -2,41 +2,276 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <algorithm>
+#include <filesystem>
+#include <chrono>
 #include <assimp/include/scene.h>
 #include <assimp/include/Importer.hpp>
 #include <assimp/include/postprocess.h>
+#include <assimp/include/MMapIOSystem.h>
+#include <assimp/include/Tracer.h>
+#include <assimp/code/Importer.h>
+#include <assimp/code/GenericProperty.h>
 #include "shader.h"
 #include "mesh.h"
+#include "meshbatch.h"
 #include "menu.h"
+
+// Material properties the viewer uses, colors still come from the menu
+struct Material {
+    std::string name;
+    float opacity;
+};
+
 class Model
 {
 public:
     Model() {
 
     }
-    Model(std::string path) {
-        loadModel(path);
+    Model(std::string path, bool trustedInput = false) {
+        loadModel(path, trustedInput);
     }
 
-    // Call draw function of all meshes in m_meshes
-    void Draw(Shader shader) {
-        for (unsigned int i = 0; i < m_meshes.size(); i++)
-            m_meshes[i].Draw(shader);
+    // Draw all meshes from the shared buffers with the shader in use, a few
+    // calls for the whole model. Opaque and transparent meshes can be drawn
+    // as separate passes
+    void Draw(MeshBatch::Pass pass = MeshBatch::Pass::All) {
+        ASSIMP_TRACE_SCOPE("draw");
+        m_meshBatch.Draw(pass);
+    }
+    // Drop parts outside the view frustum from the draw commands, and sort
+    // transparent parts unless they are drawn order-independent. Coarse draws
+    // the simplified version of large meshes, parts behind the depth in
+    // occluders are dropped, and large meshes draw only their meshlets that
+    // show, see MeshBatch
+    void cull(const glm::mat4& viewProjection, Menu *menu, bool coarse = false, const DepthPyramid* occluders = nullptr) {
+        const glm::mat4 modelMatrix = getModelMatrix(menu);
+        cull(viewProjection * modelMatrix, menu->isFrustumCulling(), menu->getTransparencyMode() == Menu::SortedTransparency,
+            coarse, occluders, occluders ? occluders->getViewProjection() * modelMatrix : glm::mat4(1.0f), menu->isMeshletCulling());
+    }
+    // Same for a model drawn with its own model matrix, e.g. getFitTransform()
+    void cull(const glm::mat4& modelViewProjection, bool frustum, bool sortTransparent, bool coarse = false,
+        const DepthPyramid* occluders = nullptr, const glm::mat4& occluderModelViewProjection = glm::mat4(1.0f),
+        bool meshlets = false) {
+        ASSIMP_TRACE_SCOPE("cull");
+        m_meshBatch.cull(modelViewProjection, frustum, sortTransparent, coarse, occluders, occluderModelViewProjection, meshlets);
+    }
+    // Whether the last cull() kept a transparent part
+    bool hasTransparency() const { return m_meshBatch.hasTransparency(); }
+    // Materials of all loaded files, a multi-file model appends each file's
+    const std::vector<Material>& getMaterials() const { return m_materials; }
+    void setMaterialOpacity(unsigned int material, float opacity) {
+        m_materials[material].opacity = opacity;
+        m_meshBatch.setOpacity(material, opacity);
     }
     //Directly load a model with a shader and a  path
     //Useful when loading a model during program execution
     Model load3DModel(std::string path, Shader shader, Menu *menu) {
         // Instantiate and load model
-        Model ourModel(path);
-        // Build model matrix
+        Model ourModel(path, menu->isTrustedInput());
+        setupShader(shader, menu);
+        return ourModel;
+    }
+    //Load several files as one model, e.g. the parts of an assembly.
+    //Files are imported in parallel, call updateBatch() every frame to
+    //add the parts that have finished
+    Model load3DModels(const std::vector<std::string>& paths, Shader shader, Menu *menu) {
+        Model ourModel;
+        ourModel.loadModels(paths, menu->isTrustedInput());
+        setupShader(shader, menu);
+        return ourModel;
+    }
+
+    // Turn a folder or a ';'-separated list of paths into the model files
+    // to load. Folders contribute every file assimp can import
+    static std::vector<std::string> collectModelFiles(const std::string& input) {
+        std::vector<std::string> files;
+        Assimp::Importer import;
+        std::error_code error;
+        size_t begin = 0;
+        while (begin <= input.size()) {
+            size_t end = input.find(';', begin);
+            if (end == std::string::npos)
+                end = input.size();
+            std::string path = input.substr(begin, end - begin);
+            path.erase(0, path.find_first_not_of(" \t"));
+            path.erase(path.find_last_not_of(" \t") + 1);
+            begin = end + 1;
+
+            if (std::filesystem::is_directory(path, error)) {
+                std::vector<std::string> folder;
+                for (const auto& entry : std::filesystem::directory_iterator(path, error)) {
+                    if (entry.is_regular_file(error) && import.IsExtensionSupported(entry.path().extension().string()))
+                        folder.push_back(entry.path().string());
+                }
+                std::sort(folder.begin(), folder.end());
+                files.insert(files.end(), folder.begin(), folder.end());
+            }
+            else if (!path.empty() && std::filesystem::is_regular_file(path, error)) {
+                files.push_back(path);
+            }
+        }
+        return files;
+    }
+
+    // Add the meshes of batch parts that finished since the last call.
+    // Runs on the GL thread, the import itself happens on the workers
+    void updateBatch() {
+        if (!m_batch)
+            return;
+        ASSIMP_TRACE_SCOPE("updateBatch");
+        unsigned int id;
+        while (m_batch->loader.PollImport(id)) {
+            aiScene* scene = m_batch->loader.GetImport(id);
+            if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+                std::cout << "ASSIMP ERROR: could not load " << m_batch->files[id] << std::endl;
+            else
+                processScene(scene);
+            delete scene;
+            m_batch->loaded++;
+        }
+        if (m_batch->loaded == m_batch->files.size())
+            m_batch.reset();
+    }
+    bool isBatchLoading() const { return m_batch != nullptr; }
+    // Changes with every mesh, instance or opacity change, see MeshBatch
+    unsigned int getGeometryVersion() const { return m_meshBatch.getVersion(); }
+
+    // Draw statistics, parts are the mesh placements in the scene graph
+    unsigned int getNumDrawCalls() const { return m_meshBatch.getNumDrawCalls(); }
+    unsigned int getNumParts() const {
+        unsigned int parts = 0;
+        for (const Mesh& mesh : m_meshBatch.getMeshes())
+            parts += mesh.getNumInstances();
+        return parts;
+    }
+    unsigned int getNumVisibleParts() const { return m_meshBatch.getNumVisible(); }
+    unsigned int getNumOccludedParts() const { return m_meshBatch.getNumOccluded(); }
+    unsigned int getNumMeshlets() const { return m_meshBatch.getNumMeshlets(); }
+    unsigned int getNumMeshletsDrawn() const { return m_meshBatch.getNumMeshletsDrawn(); }
+    // Triangles drawn for all parts, and vertices stored once per mesh
+    unsigned int getNumTriangles() const {
+        unsigned int triangles = 0;
+        for (const Mesh& mesh : m_meshBatch.getMeshes())
+            triangles += mesh.getNumIndices() / 3 * mesh.getNumInstances();
+        return triangles;
+    }
+    unsigned int getNumVertices() const {
+        unsigned int vertices = 0;
+        for (const Mesh& mesh : m_meshBatch.getMeshes())
+            vertices += mesh.getNumVertices();
+        return vertices;
+    }
+    // World space box around all parts, false for an empty model. Kept
+    // until the geometry changes, for callers asking every frame
+    bool getBounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const {
+        if (m_boundsVersion != m_meshBatch.getVersion()) {
+            m_hasBounds = computeBounds(m_boundsMin, m_boundsMax);
+            m_boundsVersion = m_meshBatch.getVersion();
+        }
+        boundsMin = m_boundsMin;
+        boundsMax = m_boundsMax;
+        return m_hasBounds;
+    }
+    // GPU memory of meshes and instance matrices, and what uploading one
+    // copy of the mesh per part would take instead
+    size_t getMeshMemory() const {
+        size_t bytes = 0;
+        for (const Mesh& mesh : m_meshBatch.getMeshes())
+            bytes += mesh.getMeshMemory() + mesh.getInstanceMemory();
+        return bytes;
+    }
+    size_t getMeshMemoryWithoutInstancing() const {
+        size_t bytes = 0;
+        for (const Mesh& mesh : m_meshBatch.getMeshes())
+            bytes += mesh.getMeshMemory() * mesh.getNumInstances();
+        return bytes;
+    }
+    // Seconds spent in the importer and creating the GL buffers by the last
+    // single file load. Uploads are only queued, the driver may finish later
+    double getImportTime() const { return m_importTime; }
+    double getUploadTime() const { return m_uploadTime; }
+    // Centers the model on the origin and scales it to the given radius
+    glm::mat4 getFitTransform(float radius = 3.5f) const {
+        glm::vec3 boundsMin, boundsMax;
+        if (!getBounds(boundsMin, boundsMax))
+            return glm::mat4(1.0f);
+        float size = std::max(glm::length(boundsMax - boundsMin) * 0.5f, 1e-6f);
+        glm::mat4 fit = glm::scale(glm::mat4(1.0f), glm::vec3(radius / size));
+        return glm::translate(fit, -(boundsMin + boundsMax) * 0.5f);
+    }
+    // Build model matrix from the menu transformations
+    static glm::mat4 getModelMatrix(Menu *menu) {
         glm::mat4 model = glm::mat4(1.0f);
 
         //Model Transformations
         model = glm::translate(model, menu->getTranslate());
         model = glm::scale(model, glm::vec3(menu->getScale()));
         model = glm::rotate(model, glm::radians(menu->getRotationAngle()), glm::vec3(menu->getRotate()));
+        return model;
+    }
+
+    unsigned int getBatchLoaded() const { return m_batch ? m_batch->loaded : 0; }
+    unsigned int getBatchTotal() const { return m_batch ? (unsigned int)m_batch->files.size() : 0; }
+private:
+    // Parallel import state of a multi-file model
+    struct Batch {
+        // Shared by all workers, declared first so it outlives the loader
+        Assimp::MMapIOSystem io;
+        Assimp::BatchLoader loader;
+        std::map<unsigned int, std::string> files;
+        unsigned int loaded = 0;
+
+        Batch() : loader(&io) {}
+    };
+
+    // Joined vertices let the cache optimizer reorder faces and vertices for
+    // the post-transform cache, overdraw and linear vertex fetches. Normals
+    // are generated only for meshes which come without them. Repeated parts
+    // are merged into one mesh so they can be drawn instanced
+    static const unsigned int importFlags = aiProcess_Triangulate | aiProcess_FlipUVs |
+        aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality |
+        aiProcess_FindInstances;
+
+    MeshBatch m_meshBatch;
+    // getBounds() as of a geometry version
+    mutable glm::vec3 m_boundsMin = glm::vec3(0.0f), m_boundsMax = glm::vec3(0.0f);
+    mutable bool m_hasBounds = false;
+    mutable unsigned int m_boundsVersion = 0;
+    std::vector<Material> m_materials;
+    double m_importTime = 0.0, m_uploadTime = 0.0;
+    // Null when idle. Replacing the model while it loads drops the queued
+    // parts and waits only for the ones already being imported
+    std::unique_ptr<Batch> m_batch;
+
+    bool computeBounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const {
+        bool empty = true;
+        for (const Mesh& mesh : m_meshBatch.getMeshes()) {
+            if (!mesh.getNumIndices())
+                continue;
+            for (const glm::mat4& transform : mesh.getInstances()) {
+                for (int corner = 0; corner < 8; corner++) {
+                    glm::vec3 local(corner & 1 ? mesh.getBoundsMax().x : mesh.getBoundsMin().x,
+                        corner & 2 ? mesh.getBoundsMax().y : mesh.getBoundsMin().y,
+                        corner & 4 ? mesh.getBoundsMax().z : mesh.getBoundsMin().z);
+                    glm::vec3 world = glm::vec3(transform * glm::vec4(local, 1.0f));
+                    boundsMin = empty ? world : glm::min(boundsMin, world);
+                    boundsMax = empty ? world : glm::max(boundsMax, world);
+                    empty = false;
+                }
+            }
+        }
+        return !empty;
+    }
+
+    // Send model matrix, material and lighting to the shader
+    static void setupShader(Shader shader, Menu *menu) {
         // Send model matrix to vertex shader as it remains constant
-        shader.setMat4("model", model);
+        shader.setMat4("model", getModelMatrix(menu));
 
         //Material Colors
         shader.setVec3("material.ambient", menu->getAmbientMaterialColor());
@@ -48,16 +283,23 @@ public:
         shader.setVec3("light.ambient", menu->getAmbientLightingColor());
         shader.setVec3("light.diffuse", menu->getDiffuseLightingColor());
         shader.setVec3("light.specular", menu->getSpecularLightingColor());
-
-        return ourModel;
     }
-private:
-    std::vector<Mesh> m_meshes;
 
     // Load model and call processNode
-    void loadModel(std::string path) {
+    void loadModel(std::string path, bool trustedInput) {
         Assimp::Importer import;
-        const aiScene* scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+        // Face indices are copied out below, so let the importer carve them
+        // from one arena instead of allocating every face separately
+        import.SetPropertyBool(AI_CONFIG_IMPORT_SCENE_ARENA, true);
+        // Map files instead of reading them, binary formats parse in place
+        import.SetIOHandler(new Assimp::MMapIOSystem());
+        // Trusted files skip the scene checks and channels the viewer ignores
+        import.SetPropertyBool(AI_CONFIG_IMPORT_TRUSTED_INPUT, trustedInput);
+        // Print how much the vertex cache optimization gained
+        import.SetPropertyBool(AI_CONFIG_PP_ICL_LOG_ACMR, true);
+        auto start = std::chrono::steady_clock::now();
+        const aiScene* scene = import.ReadFile(path, importFlags);
+        auto imported = std::chrono::steady_clock::now();
 
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
         {
@@ -65,48 +307,97 @@ private:
             return;
         }
 
-        processNode(scene->mRootNode, scene);
+        processScene(scene);
+        m_importTime = std::chrono::duration<double>(imported - start).count();
+        m_uploadTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - imported).count();
+    }
+
+    // Queue all files on a BatchLoader with one worker per core
+    void loadModels(const std::vector<std::string>& paths, bool trustedInput) {
+        m_batch.reset(new Batch());
+        m_batch->loader.setNumThreads(0);
+
+        Assimp::BatchLoader::PropertyMap properties;
+        SetGenericProperty(properties.ints, AI_CONFIG_IMPORT_SCENE_ARENA, 1);
+        SetGenericProperty(properties.ints, AI_CONFIG_IMPORT_TRUSTED_INPUT, trustedInput ? 1 : 0);
+        SetGenericProperty(properties.ints, AI_CONFIG_PP_ICL_LOG_ACMR, 1);
+
+        // The loader merges requests for the same file and would hand out
+        // one scene twice, so drop duplicates up front
+        std::set<std::string> unique;
+        std::error_code error;
+        for (const std::string& path : paths) {
+            std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+            unique.insert(error ? path : canonical.string());
+        }
+        for (const std::string& path : unique) {
+            unsigned int id = m_batch->loader.AddLoadRequest(path, importFlags, &properties);
+            m_batch->files[id] = path;
+        }
+        m_batch->loader.LoadAsync();
     }
 
-    // Recursively process each Node by calling processMesh on each node's 
-    // meshes and adding them to m_meshes vector
-    void processNode(aiNode* node, const aiScene* scene) {
+    // Upload every mesh of the scene once and draw all nodes that use it as
+    // instances. Identical meshes are merged by aiProcess_FindInstances
+    void processScene(const aiScene* scene) {
+        ASSIMP_TRACE_SCOPE("upload");
+        const unsigned int firstMaterial = (unsigned int)m_materials.size();
+        for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+        {
+            aiString name;
+            float opacity = 1.0f;
+            scene->mMaterials[i]->Get(AI_MATKEY_NAME, name);
+            scene->mMaterials[i]->Get(AI_MATKEY_OPACITY, opacity);
+            m_materials.push_back({ name.length ? name.C_Str() : "Material " + std::to_string(m_materials.size()),
+                glm::clamp(opacity, 0.0f, 1.0f) });
+        }
+
+        std::map<unsigned int, std::vector<glm::mat4>> instances;
+        processNode(scene->mRootNode, glm::mat4(1.0f), instances);
+        for (const auto& [index, transforms] : instances)
+        {
+            const unsigned int material = firstMaterial + scene->mMeshes[index]->mMaterialIndex;
+            Mesh& mesh = processMesh(scene->mMeshes[index], scene);
+            mesh.setInstances(transforms);
+            mesh.setMaterial(material);
+            if (material < m_materials.size())
+                mesh.setOpacity(m_materials[material].opacity);
+        }
+    }
+    // Recursively collect the world transform of each node's meshes
+    void processNode(const aiNode* node, const glm::mat4& parent, std::map<unsigned int, std::vector<glm::mat4>>& instances) {
+        // aiMatrix4x4 is row-major, glm is column-major
+        glm::mat4 transform = parent * glm::transpose(glm::make_mat4(&node->mTransformation.a1));
         // Process all the node's meshes (if any)
         for (unsigned int i = 0; i < node->mNumMeshes; i++)
         {
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            m_meshes.push_back(processMesh(mesh, scene));
+            instances[node->mMeshes[i]].push_back(transform);
         }
         // Do the same for each of its children
         for (unsigned int i = 0; i < node->mNumChildren; i++)
         {
-            processNode(node->mChildren[i], scene);
+            processNode(node->mChildren[i], transform, instances);
         }
     }
-    // Create mesh object with vertex and index daa
-    Mesh processMesh(aiMesh* mesh, const aiScene* scene) {
-        std::vector<Vertex> vertices;
+    // Add the mesh to the shared buffers straight from the importer's vertex and index arrays
+    Mesh& processMesh(aiMesh* mesh, const aiScene* scene) {
+        static_assert(sizeof(aiVector3D) == sizeof(glm::vec3), "vertex arrays are uploaded as they are");
+        const glm::vec3* positions = reinterpret_cast<const glm::vec3*>(mesh->mVertices);
+        const glm::vec3* normals = reinterpret_cast<const glm::vec3*>(mesh->mNormals);
+
+        // Use the flat triangle array as it is if the importer provides one
+        if (mesh->HasTriangleIndices())
+            return m_meshBatch.add(positions, normals, mesh->mNumVertices, mesh->mTriangleIndices, mesh->mNumFaces * 3);
+
+        // Otherwise gather the triangles, points and lines are not drawn
         std::vector<unsigned int> indices;
-        // Load verticies
-        for (unsigned int i = 0; i < mesh->mNumVertices; i++)
-        {
-            Vertex vertex = {glm::vec3(0, 0, 0), glm::vec3(0, 0, 0)};
-            vertex.Position.x = mesh->mVertices[i].x;
-            vertex.Position.y = mesh->mVertices[i].y;
-            vertex.Position.z = mesh->mVertices[i].z;
-            vertex.Normal.x = mesh->mNormals[i].x;
-            vertex.Normal.y = mesh->mNormals[i].y;
-            vertex.Normal.z = mesh->mNormals[i].z;
-            vertices.push_back(vertex);
-        }
-        // Load indices
+        indices.reserve(mesh->mNumFaces * 3);
         for (unsigned int i = 0; i < mesh->mNumFaces; i++)
         {
-            aiFace face = mesh->mFaces[i];
-            for (unsigned int j = 0; j < face.mNumIndices; j++)
-                indices.push_back(face.mIndices[j]);
+            const aiFace& face = mesh->mFaces[i];
+            if (face.mNumIndices == 3)
+                indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
         }
-
-        return Mesh(vertices, indices);
+        return m_meshBatch.add(positions, normals, mesh->mNumVertices, indices.data(), (unsigned int)indices.size());
     }
 };
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <filesystem>
+#include "cachefolder.h"
+
+// Linked programs saved as driver binaries (glGetProgramBinary), so later
+// launches skip compiling and linking. A program's key hashes its sources,
+// defines and the driver's vendor, renderer and version strings, so edited
+// shaders or a driver update miss the cache. A binary the driver rejects
+// anyway is compiled from source again and replaced
+class ProgramCache
+{
+public:
+    // Folder of the binaries, empty turns the cache off. Set it before
+    // building shaders on other threads
+    static std::string& folder() {
+        static std::string folder = cacheFolder("shader_cache");
+        return folder;
+    }
+    static bool isEnabled() {
+        if (folder().empty())
+            return false;
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+
+    // FNV-1a of the sources and defines, and of the current context's driver
+    static uint64_t key(const std::vector<std::string>& sources, const std::string& defines) {
+        uint64_t hash = 14695981039346656037ull;
+        auto add = [&hash](const char* text, size_t length) {
+            for (size_t i = 0; i < length; i++) {
+                hash ^= (unsigned char)text[i];
+                hash *= 1099511628211ull;
+            }
+            // Separator, so moving text between parts changes the key
+            hash ^= 0xff;
+            hash *= 1099511628211ull;
+        };
+        for (const std::string& source : sources)
+            add(source.data(), source.size());
+        add(defines.data(), defines.size());
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const char* text = (const char*)glGetString(name);
+            add(text ? text : "", text ? strlen(text) : 0);
+        }
+        return hash;
+    }
+
+    // Load the binary of key into program, false if there is none or the
+    // driver does not link it
+    static bool load(unsigned int program, uint64_t key) {
+        std::ifstream file(path(key), std::ios::binary);
+        Header header;
+        if (!file.read((char*)&header, sizeof(header)) || header.magic != magic || header.key != key)
+            return false;
+        std::vector<char> binary(header.size);
+        if (!file.read(binary.data(), binary.size()))
+            return false;
+        glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        return linked == GL_TRUE;
+    }
+
+    // Save the linked program, retrievable if GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    // was set before linking. Written under a temporary name and renamed, so
+    // threads saving the same program never leave a torn file
+    static void store(unsigned int program, uint64_t key) {
+        GLint size = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+        if (size <= 0)
+            return;
+        Header header = { magic, 0, key, 0 };
+        std::vector<char> binary(size);
+        GLsizei written = 0;
+        glGetProgramBinary(program, size, &written, &header.format, binary.data());
+        if (written <= 0)
+            return;
+        header.size = (uint32_t)written;
+
+        std::error_code error;
+        std::filesystem::create_directories(folder(), error);
+        const std::string target = path(key);
+        const std::string temporary = target + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary);
+            file.write((const char*)&header, sizeof(header));
+            file.write(binary.data(), written);
+            if (!file)
+                return;
+        }
+        std::filesystem::rename(temporary, target, error);
+        if (error)
+            std::filesystem::remove(temporary, error);
+    }
+
+private:
+    static const uint32_t magic = 0x31425056; // "VPB1"
+
+    struct Header {
+        uint32_t magic;
+        GLenum format;
+        uint64_t key;
+        uint32_t size;
+    };
+
+    static std::string path(uint64_t key) {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return (std::filesystem::path(folder()) / name).string();
+    }
+};
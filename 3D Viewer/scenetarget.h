@@ -0,0 +1,172 @@
+#pragma once
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include "shader.h"
+
+// Offscreen target the scene is drawn into, at a scale of the window size.
+// Frames are resolved and averaged into the refined image (see
+// AdaptiveQuality), which present() stretches over the window, sharpened
+// when it is upscaled. Anti-aliasing is either multisampling, or FXAA on
+// the resolved frame with 0 samples, much cheaper for fragment-bound
+// renderers. Usage per frame:
+//
+//   scene.resize(width, height, scale);
+//   scene.bind();
+//   draw the scene, passes binding their own targets use getFramebuffer()
+//   scene.resolve(sample);
+//   scene.present(0, width, height, sharpness);
+class SceneTarget
+{
+public:
+    explicit SceneTarget(int samples = 4) : m_samples(samples),
+        m_present("shaders/fullscreen.glsl", "shaders/present.glsl"),
+        m_fxaa("shaders/fullscreen.glsl", "shaders/fxaa.glsl") {
+        GLint program = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        m_present.use();
+        m_present.setInt("image", 0);
+        m_fxaa.use();
+        m_fxaa.setInt("image", 0);
+        glUseProgram(program);
+
+        glGenVertexArrays(1, &m_vao);
+        glGenFramebuffers(3, m_framebuffers);
+        glGenRenderbuffers(2, m_renderbuffers);
+        glGenTextures(2, m_textures);
+    }
+    ~SceneTarget() {
+        glDeleteProgram(m_present.get_id());
+        glDeleteProgram(m_fxaa.get_id());
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteFramebuffers(3, m_framebuffers);
+        glDeleteRenderbuffers(2, m_renderbuffers);
+        glDeleteTextures(2, m_textures);
+    }
+    SceneTarget(const SceneTarget&) = delete;
+    SceneTarget& operator=(const SceneTarget&) = delete;
+
+    // Size the targets to scale of the window, at least one pixel
+    void resize(int windowWidth, int windowHeight, float scale) {
+        const int width = std::max(1, (int)std::lround(windowWidth * scale));
+        const int height = std::max(1, (int)std::lround(windowHeight * scale));
+        if (width != m_width || height != m_height)
+            allocate(width, height);
+    }
+    // Samples of the scene, 0 anti-aliases resolved frames with FXAA instead.
+    // Takes effect at the next resize()
+    void setSamples(int samples) {
+        if (samples != m_samples) {
+            m_samples = samples;
+            m_width = m_height = 0;
+        }
+    }
+    int getSamples() const { return m_samples; }
+    // Draw into the multisampled target
+    void bind() {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[0]);
+        glViewport(0, 0, m_width, m_height);
+    }
+    unsigned int getFramebuffer() const { return m_framebuffers[0]; }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    // Resolve the frame and average it into the refined image, as its
+    // sample-th frame. Sample 0 starts a new image
+    void resolve(unsigned int sample) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffers[0]);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffers[1]);
+        glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+        // The first frame replaces the image, whatever it held before
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[2]);
+        if (sample > 0) {
+            glEnable(GL_BLEND);
+            glBlendColor(0.0f, 0.0f, 0.0f, 1.0f / (sample + 1));
+            glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+        }
+        if (m_samples > 0)
+            draw(m_present, m_textures[0], m_width, m_height);
+        else
+            draw(m_fxaa, m_textures[0], m_width, m_height);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDisable(GL_BLEND);
+    }
+
+    // Stretch the refined image over target (0 for the window), sharpened
+    // by sharpness in [0, 1] if it is smaller than the target
+    void present(unsigned int target, int width, int height, float sharpness = 0.0f) {
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+        const bool upscaled = m_width < width || m_height < height;
+        draw(m_present, m_textures[1], width, height, upscaled ? sharpness : 0.0f);
+    }
+
+private:
+    int m_samples;
+    Shader m_present, m_fxaa;
+    unsigned int m_vao;
+    // Multisampled scene, its resolve and the refined image
+    unsigned int m_framebuffers[3];
+    // Multisampled color and depth
+    unsigned int m_renderbuffers[2];
+    // Resolved frame and refined image, filtered for stretching
+    unsigned int m_textures[2];
+    int m_width = 0, m_height = 0;
+
+    // Full-screen pass of texture into the bound framebuffer
+    void draw(Shader& shader, unsigned int texture, int width, int height, float sharpness = 0.0f) {
+        GLint program = 0, polygonMode[2] = { GL_FILL, GL_FILL };
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        glGetIntegerv(GL_POLYGON_MODE, polygonMode);
+        glViewport(0, 0, width, height);
+        glDisable(GL_DEPTH_TEST);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+        shader.use();
+        shader.setVec2("output_size", glm::vec2(width, height));
+        if (&shader == &m_present)
+            shader.setFloat("sharpness", sharpness);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glBindVertexArray(m_vao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glUseProgram(program);
+        glPolygonMode(GL_FRONT_AND_BACK, polygonMode[0]);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    void allocate(int width, int height) {
+        m_width = width;
+        m_height = height;
+
+        glBindRenderbuffer(GL_RENDERBUFFER, m_renderbuffers[0]);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_samples, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_renderbuffers[1]);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_samples, GL_DEPTH_COMPONENT24, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[0]);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_renderbuffers[0]);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_renderbuffers[1]);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "Scene framebuffer incomplete" << std::endl;
+
+        // The refined image is a running average, so it keeps more precision
+        const GLenum formats[2] = { GL_RGBA8, GL_RGBA16F };
+        for (int i = 0; i < 2; i++) {
+            glBindTexture(GL_TEXTURE_2D, m_textures[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, formats[i], width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffers[i + 1]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_textures[i], 0);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+};
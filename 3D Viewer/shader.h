@@ -3,43 +3,76 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
 #include "glm/glm.hpp"
 #include "glm/gtc/type_ptr.hpp"
+#include "programcache.h"
 
 class Shader
 {
 public:
-    Shader(std::string vertex_path, std::string fragment_path, std::string geometry_path) {
-        // Compile
+    // The geometry stage is optional, e.g. for full-screen passes. Each
+    // define is added to every stage as "#define <define>", see preprocess().
+    // Linked programs are reused from ProgramCache when it has them
+    Shader(std::string vertex_path, std::string fragment_path, std::string geometry_path = "",
+        const std::vector<std::string>& defines = {}) {
+        auto start = std::chrono::steady_clock::now();
         GLenum error = glGetError();
+        std::string define_lines;
+        for (const std::string& define : defines)
+            define_lines += "#define " + define + "\n";
+        std::vector<std::string> sources = { preprocess(vertex_path, define_lines), preprocess(fragment_path, define_lines) };
+        if (!geometry_path.empty())
+            sources.push_back(preprocess(geometry_path, define_lines));
         unsigned int program = glCreateProgram();
-        unsigned int vertex_shader = compile(GL_VERTEX_SHADER, vertex_path);
-        unsigned int fragment_shader = compile(GL_FRAGMENT_SHADER, fragment_path);
-        unsigned int geometry_shader = compile(GL_GEOMETRY_SHADER, geometry_path);
-        // Link
-        glAttachShader(program, vertex_shader);
-        glAttachShader(program, fragment_shader);
-        glAttachShader(program, geometry_shader);
-        glLinkProgram(program);
-        // Check for errors
-        int result;
-        char error_log[512];
-        glGetProgramiv(program, GL_LINK_STATUS, &result);
-        if (result == GL_FALSE)
-        {
-            glGetProgramInfoLog(program, 512, nullptr, error_log);
-            std::cout << "FAILED TO LINK SHADERS: " << error_log << std::endl;
+        const bool cache = ProgramCache::isEnabled();
+        const uint64_t key = cache ? ProgramCache::key(sources, define_lines) : 0;
+        m_from_cache = cache && ProgramCache::load(program, key);
+        if (!m_from_cache) {
+            // Compile
+            unsigned int vertex_shader = compile(GL_VERTEX_SHADER, sources[0]);
+            unsigned int fragment_shader = compile(GL_FRAGMENT_SHADER, sources[1]);
+            unsigned int geometry_shader = sources.size() > 2 ? compile(GL_GEOMETRY_SHADER, sources[2]) : 0;
+            // Link
+            glAttachShader(program, vertex_shader);
+            glAttachShader(program, fragment_shader);
+            if (geometry_shader)
+                glAttachShader(program, geometry_shader);
+            if (cache)
+                glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            glLinkProgram(program);
+            // Check for errors
+            int result;
+            char error_log[512];
+            glGetProgramiv(program, GL_LINK_STATUS, &result);
+            if (result == GL_FALSE)
+            {
+                glGetProgramInfoLog(program, 512, nullptr, error_log);
+                std::cout << "FAILED TO LINK SHADERS: " << error_log << std::endl;
+            }
+            else if (cache)
+            {
+                ProgramCache::store(program, key);
+            }
+            // Free compiled shaders
+            glDetachShader(program, vertex_shader);
+            glDetachShader(program, fragment_shader);
+            glDeleteShader(vertex_shader);
+            glDeleteShader(fragment_shader);
+            if (geometry_shader) {
+                glDetachShader(program, geometry_shader);
+                glDeleteShader(geometry_shader);
+            }
         }
         // Validate
         glValidateProgram(program);
         m_id = program;
-        // Free compiled shaders
-        glDeleteShader(vertex_shader);
-        glDeleteShader(fragment_shader);
-        glDeleteShader(geometry_shader);     
         if (error != GL_NO_ERROR) {
             std::cerr << "OpenGL Error: " << error << std::endl;
         }
+        m_build_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
     }
 
     // Bind shader program to opengl
@@ -64,6 +97,22 @@ public:
         int location = glGetUniformLocation(m_id, var_name.c_str());
         glUniform1f(location, value);    
     }
+    void setInt(const std::string& var_name, int value) {
+        int location = glGetUniformLocation(m_id, var_name.c_str());
+        glUniform1i(location, value);
+    }
+    void setVec2(const std::string& var_name, glm::vec2 vector) {
+        int location = glGetUniformLocation(m_id, var_name.c_str());
+        glUniform2f(location, vector.x, vector.y);
+    }
+    void setVec4(const std::string& var_name, glm::vec4 vector) {
+        int location = glGetUniformLocation(m_id, var_name.c_str());
+        glUniform4f(location, vector.x, vector.y, vector.z, vector.w);
+    }
+    void setIVec3(const std::string& var_name, glm::ivec3 vector) {
+        int location = glGetUniformLocation(m_id, var_name.c_str());
+        glUniform3i(location, vector.x, vector.y, vector.z);
+    }
 
     void reloadValues(Menu* menu) {
         setVec3("material.ambient", menu->getAmbientMaterialColor());
@@ -71,21 +120,62 @@ public:
         setVec3("material.specular", menu->getSpecularMaterialColor());
         setFloat("material.shininess", menu->getShininess());
         setVec3("light.ambient", menu->getAmbientLightingColor());
-        setVec3("light.diffuse", menu->getDiffuseLightingColor());
-        setVec3("light.specular", menu->getSpecularLightingColor());
+        // The scene ambient stays when the camera light is off
+        setVec3("light.diffuse", menu->isCameraLight() ? menu->getDiffuseLightingColor() : glm::vec3(0.0f));
+        setVec3("light.specular", menu->isCameraLight() ? menu->getSpecularLightingColor() : glm::vec3(0.0f));
     }
     unsigned int get_id(void) { return m_id; }
+    // Whether the program came from ProgramCache, and the seconds it took
+    // to read, compile and link or load it
+    bool is_from_cache(void) const { return m_from_cache; }
+    double get_build_time(void) const { return m_build_time; }
 
 private:
     unsigned int m_id;
+    bool m_from_cache = false;
+    double m_build_time = 0.0;
 
-    unsigned int compile(unsigned int type, const std::string& path) {
-        // Read shader text into c string
+    static std::string read(const std::string& path) {
+        // Read shader text
         std::ifstream shader_source(path);
         std::stringstream shader_buf;
         shader_buf << shader_source.rdbuf();
-        std::string shader_str = shader_buf.str();
-        const char* shader_cstr = shader_str.c_str();
+        return shader_buf.str();
+    }
+
+    // Shader text with the define lines after its #version line, and every
+    // #include "file" line replaced by that file, relative to the including
+    // one. Each file is included once, like with #pragma once
+    static std::string preprocess(const std::string& path, const std::string& define_lines) {
+        std::vector<std::string> included;
+        std::string source = include(path, included);
+        size_t version = source.find("#version");
+        size_t insert = version == std::string::npos ? 0 : source.find('\n', version);
+        insert = insert == std::string::npos ? source.size() : insert + (version == std::string::npos ? 0 : 1);
+        return source.insert(insert, define_lines);
+    }
+    static std::string include(const std::string& path, std::vector<std::string>& included) {
+        included.push_back(path);
+        std::istringstream lines(read(path));
+        std::string line, source;
+        while (std::getline(lines, line)) {
+            size_t directive = line.find_first_not_of(" \t");
+            size_t open = line.find('"'), close = line.rfind('"');
+            if (directive != std::string::npos && line.compare(directive, 8, "#include") == 0 && open != close) {
+                std::string name = line.substr(open + 1, close - open - 1);
+                size_t folder = path.find_last_of("/\\");
+                std::string file = folder == std::string::npos ? name : path.substr(0, folder + 1) + name;
+                if (std::find(included.begin(), included.end(), file) == included.end())
+                    source += include(file, included);
+                continue;
+            }
+            source += line + "\n";
+        }
+        return source;
+    }
+
+    unsigned int compile(unsigned int type, const std::string& source) {
+        const char* shader_cstr = source.c_str();
        // Compile shader
         unsigned int id = glCreateShader(type);
         glShaderSource(id, 1, &shader_cstr, nullptr);
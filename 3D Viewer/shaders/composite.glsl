@@ -0,0 +1,18 @@
+#version 330 core
+
+// Resolves the weighted blended transparency targets over the opaque image
+uniform sampler2D accumulation;
+uniform sampler2D revealage;
+
+out vec4 frag_color;
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float revealed = texelFetch(revealage, texel, 0).r;
+    // Nothing transparent here
+    if (revealed >= 1.0)
+        discard;
+    vec4 accum = texelFetch(accumulation, texel, 0);
+    frag_color = vec4(accum.rgb / max(accum.a, 1e-5), 1.0 - revealed);
+}
@@ -0,0 +1,6 @@
+#version 330 core
+
+// Depth only passes, the depth test writes all there is
+void main()
+{
+}
@@ -17,20 +17,35 @@ struct Light {
 in FragData{
     vec3 frag_pos;
     vec3 frag_norm;
+    float frag_opacity;
 } fs_in;
 
-out vec4 frag_color;
+layout(location = 0) out vec4 frag_color;
+layout(location = 1) out float frag_revealage;
 
 uniform Material material;
+// Follows the camera, or shines from a fixed direction with shadows. See
+// lights.h for the lights placed in the scene
 uniform Light light;
 uniform vec3 view_pos;
 
+#ifdef SCENE_LIGHTS
+#include "lights.glsl"
+#endif
+#ifdef SHADOWS
+#include "shadows.glsl"
+#endif
+
 void main()
 {
     vec3 ambient = light.ambient * material.ambient;
 
     vec3 unit_frag_norm = normalize(fs_in.frag_norm);
+#ifdef SHADOWS
+    vec3 light_dir = -normalize(shadow_light_dir);
+#else
     vec3 light_dir = normalize(light.position - fs_in.frag_pos);
+#endif
     float diffuse_mag = max(dot(unit_frag_norm, light_dir), 0.0);
     vec3 diffuse = light.diffuse * (diffuse_mag * material.diffuse);
 
@@ -39,7 +54,24 @@ void main()
     float spec = pow(max(dot(view_dir, reflect_dir), 0.0), material.shininess);
     vec3 specular = light.specular * (spec * material.specular);
 
+#ifdef SHADOWS
+    float lit = shadow(fs_in.frag_pos, unit_frag_norm);
+    diffuse *= lit;
+    specular *= lit;
+#endif
     vec3 result = ambient + diffuse + specular;
+#ifdef SCENE_LIGHTS
+    result += scene_lights(unit_frag_norm, view_dir);
+#endif
 
-    frag_color = vec4(result, 1.0);
+    float alpha = fs_in.frag_opacity;
+#ifdef OIT_ACCUMULATE
+    // Weighted blended transparency, see transparency.h. Weight from McGuire
+    // and Bavoil, favours near and opaque surfaces
+    float weight = clamp(pow(min(1.0, alpha * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+    frag_color = vec4(result * alpha, alpha) * weight;
+    frag_revealage = alpha;
+#else
+    frag_color = vec4(result, alpha);
+#endif
 }
@@ -0,0 +1,51 @@
+#version 330 core
+
+// Post-process anti-aliasing of an image the same size as the output, see
+// scenetarget.h. A reduced FXAA: edges are found from the luma of the
+// neighbours and blurred along their direction, in one pass of 9 reads
+uniform sampler2D image;
+uniform vec2 output_size;
+
+out vec4 frag_color;
+
+const vec3 LUMA = vec3(0.299, 0.587, 0.114);
+// Contrast below which a pixel is left alone, absolute and relative
+const float EDGE_MIN = 1.0 / 32.0;
+const float EDGE_RELATIVE = 1.0 / 8.0;
+// Limits of the blur direction, in texels
+const float REDUCE_MIN = 1.0 / 128.0;
+const float REDUCE_MUL = 1.0 / 8.0;
+const float SPAN_MAX = 8.0;
+
+void main()
+{
+    vec2 texel = 1.0 / output_size;
+    vec2 uv = gl_FragCoord.xy * texel;
+    vec3 center = texture(image, uv).rgb;
+    float lumaCenter = dot(center, LUMA);
+    float lumaNW = dot(texture(image, uv + vec2(-1.0, 1.0) * texel).rgb, LUMA);
+    float lumaNE = dot(texture(image, uv + vec2(1.0, 1.0) * texel).rgb, LUMA);
+    float lumaSW = dot(texture(image, uv + vec2(-1.0, -1.0) * texel).rgb, LUMA);
+    float lumaSE = dot(texture(image, uv + vec2(1.0, -1.0) * texel).rgb, LUMA);
+
+    float lumaMin = min(lumaCenter, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(lumaCenter, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+    if (lumaMax - lumaMin < max(EDGE_MIN, lumaMax * EDGE_RELATIVE)) {
+        frag_color = vec4(center, 1.0);
+        return;
+    }
+
+    // Across the luma gradient is along the edge
+    vec2 direction = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+    float reduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * REDUCE_MUL, REDUCE_MIN);
+    float scale = 1.0 / (min(abs(direction.x), abs(direction.y)) + reduce);
+    direction = clamp(direction * scale, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * texel;
+
+    vec3 inner = 0.5 * (texture(image, uv + direction * (1.0 / 3.0 - 0.5)).rgb +
+        texture(image, uv + direction * (2.0 / 3.0 - 0.5)).rgb);
+    vec3 outer = inner * 0.5 + 0.25 * (texture(image, uv - direction * 0.5).rgb +
+        texture(image, uv + direction * 0.5).rgb);
+    // The wider blur overshoots when it leaves the range of the neighbourhood
+    float lumaOuter = dot(outer, LUMA);
+    frag_color = vec4(lumaOuter < lumaMin || lumaOuter > lumaMax ? inner : outer, 1.0);
+}
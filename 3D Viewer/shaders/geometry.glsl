@@ -6,11 +6,13 @@ layout(triangle_strip, max_vertices = 3) out;
 in FragData{
     vec3 frag_pos;
     vec3 frag_norm;
+    float frag_opacity;
 } gs_in[];
 
 out FragData{
     vec3 frag_pos;
     vec3 frag_norm;
+    float frag_opacity;
 } gs_out;
 out vec2 TexCoords;
 
@@ -26,17 +28,20 @@ vec3 GetNormal()
 void main() {
     vec3 normal = GetNormal();
 
-    gl_Position = gl_in[0].gl_Position + vec4(normal * distance, 1.0);
+    gl_Position = gl_in[0].gl_Position + vec4(normal * distance, 0.0);
     gs_out.frag_pos = gs_in[0].frag_pos;
     gs_out.frag_norm = gs_in[0].frag_norm;
+    gs_out.frag_opacity = gs_in[0].frag_opacity;
     EmitVertex();
-    gl_Position = gl_in[1].gl_Position + vec4(normal * distance, 1.0);
+    gl_Position = gl_in[1].gl_Position + vec4(normal * distance, 0.0);
     gs_out.frag_pos = gs_in[1].frag_pos;
     gs_out.frag_norm = gs_in[1].frag_norm;
+    gs_out.frag_opacity = gs_in[1].frag_opacity;
     EmitVertex();
-    gl_Position = gl_in[2].gl_Position + vec4(normal * distance, 1.0);
+    gl_Position = gl_in[2].gl_Position + vec4(normal * distance, 0.0);
     gs_out.frag_pos = gs_in[2].frag_pos;
     gs_out.frag_norm = gs_in[2].frag_norm;
+    gs_out.frag_opacity = gs_in[2].frag_opacity;
     EmitVertex();
     EndPrimitive();
 
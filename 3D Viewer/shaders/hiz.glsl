@@ -0,0 +1,21 @@
+#version 330 core
+
+// One level of the depth pyramid from the level below, see depthpyramid.h.
+// Each texel keeps the farthest depth of the 2x2 texels under it, 3 wide
+// along an odd edge so no texel of the level below is skipped
+uniform sampler2D depth;
+
+out float farthest;
+
+void main()
+{
+    ivec2 size = textureSize(depth, 0);
+    ivec2 base = ivec2(gl_FragCoord.xy) * 2;
+    ivec2 count = ivec2(base.x + 3 == size.x ? 3 : 2, base.y + 3 == size.y ? 3 : 2);
+    float result = 0.0;
+    for (int y = 0; y < count.y; y++) {
+        for (int x = 0; x < count.x; x++)
+            result = max(result, texelFetch(depth, min(base + ivec2(x, y), size - 1), 0).r);
+    }
+    farthest = result;
+}
@@ -0,0 +1,67 @@
+// Lights placed in the scene, see lights.h. Included by fragment.glsl in
+// the SCENE_LIGHTS variants, after its material uniform and FragData input
+
+uniform mat4 view;
+
+// Clustered lights. Light data is float bits in unsigned texels, so all
+// three samplers have one type and may share a unit while nothing is bound
+uniform usamplerBuffer light_data;
+uniform usamplerBuffer light_grid;
+uniform usamplerBuffer light_indices;
+uniform int directional_light_count;
+uniform int clustered_light_count;
+uniform ivec3 cluster_grid;
+uniform vec2 cluster_tile_size;
+uniform vec2 cluster_depth_scale_bias;
+
+const float SPOT_LIGHT = 1.0;
+
+// Texel row of a light: position and range, color and type, direction and
+// cosine of the outer angle, cosine of the inner angle
+vec4 light_texel(int light, int row)
+{
+    return uintBitsToFloat(texelFetch(light_data, light * 4 + row));
+}
+
+// Diffuse and specular of one light arriving from light_dir
+vec3 shade(vec3 light_dir, vec3 color, vec3 normal, vec3 view_dir)
+{
+    float diffuse_mag = max(dot(normal, light_dir), 0.0);
+    vec3 reflect_dir = reflect(-light_dir, normal);
+    float spec = pow(max(dot(view_dir, reflect_dir), 0.0), material.shininess);
+    return color * (diffuse_mag * material.diffuse + spec * material.specular);
+}
+
+vec3 scene_lights(vec3 normal, vec3 view_dir)
+{
+    vec3 result = vec3(0.0);
+    // Directional lights come first and reach every fragment
+    for (int i = 0; i < directional_light_count; i++)
+        result += shade(-light_texel(i, 2).xyz, light_texel(i, 1).rgb, normal, view_dir);
+    if (clustered_light_count == 0)
+        return result;
+
+    // Point and spot lights binned into this fragment's cluster
+    float depth = -(view * vec4(fs_in.frag_pos, 1.0)).z;
+    ivec3 cluster = ivec3(ivec2(gl_FragCoord.xy / cluster_tile_size),
+        int(floor(log(max(depth, 1e-6)) * cluster_depth_scale_bias.x + cluster_depth_scale_bias.y)));
+    cluster = clamp(cluster, ivec3(0), cluster_grid - 1);
+    uvec2 range = texelFetch(light_grid, cluster.x + cluster_grid.x * (cluster.y + cluster_grid.y * cluster.z)).rg;
+    for (uint i = 0u; i < range.y; i++) {
+        int light = int(texelFetch(light_indices, int(range.x + i)).r);
+        vec4 position_range = light_texel(light, 0);
+        vec4 color_type = light_texel(light, 1);
+        vec3 to_light = position_range.xyz - fs_in.frag_pos;
+        float light_distance = length(to_light);
+        vec3 light_dir = to_light / max(light_distance, 1e-6);
+        // Inverse square, faded to zero at the range
+        float fade = clamp(1.0 - pow(light_distance / position_range.w, 4.0), 0.0, 1.0);
+        float attenuation = fade * fade / (1.0 + light_distance * light_distance);
+        if (color_type.w == SPOT_LIGHT) {
+            vec4 direction_outer = light_texel(light, 2);
+            attenuation *= smoothstep(direction_outer.w, light_texel(light, 3).x, dot(-light_dir, direction_outer.xyz));
+        }
+        result += shade(light_dir, color_type.rgb * attenuation, normal, view_dir);
+    }
+    return result;
+}
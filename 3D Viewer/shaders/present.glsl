@@ -0,0 +1,35 @@
+#version 330 core
+
+// Stretches an image over the output, see scenetarget.h. With sharpness above
+// zero, a contrast adaptive sharpening filter (after AMD's CAS) restores some
+// of the detail an upscale blurs: the less headroom the local contrast leaves, the
+// weaker the sharpening, so edges do not ring
+uniform sampler2D image;
+uniform vec2 output_size;
+uniform float sharpness;
+
+out vec4 frag_color;
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / output_size;
+    vec3 center = texture(image, uv).rgb;
+    if (sharpness <= 0.0) {
+        frag_color = vec4(center, 1.0);
+        return;
+    }
+
+    // Cross of neighbours one texel of the image away
+    vec2 texel = 1.0 / vec2(textureSize(image, 0));
+    vec3 up = texture(image, uv + vec2(0.0, texel.y)).rgb;
+    vec3 down = texture(image, uv - vec2(0.0, texel.y)).rgb;
+    vec3 left = texture(image, uv - vec2(texel.x, 0.0)).rgb;
+    vec3 right = texture(image, uv + vec2(texel.x, 0.0)).rgb;
+
+    vec3 lowest = min(center, min(min(up, down), min(left, right)));
+    vec3 highest = max(center, max(max(up, down), max(left, right)));
+    vec3 amount = sqrt(clamp(min(lowest, 2.0 - highest) / max(highest, 1e-4), 0.0, 1.0));
+    vec3 weight = -amount * mix(0.125, 0.2, sharpness);
+    vec3 color = (center + (up + down + left + right) * weight) / (1.0 + 4.0 * weight);
+    frag_color = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+
+// Casters drawn into the shadow maps, see shadowmap.h
+layout(location = 0) in vec3 position;
+layout(location = 2) in mat4 instance;
+
+uniform mat4 model;
+uniform mat4 light_view_projection;
+
+void main()
+{
+    gl_Position = light_view_projection * model * instance * vec4(position, 1.0);
+}
@@ -0,0 +1,35 @@
+// Cascaded shadow maps of the scene light, see shadowmap.h. Included by
+// fragment.glsl in the SHADOWS variants
+
+// Match CascadedShadowMap
+const int SHADOW_CASCADES = 3;
+const float SHADOW_MAP_SIZE = 2048.0;
+
+uniform sampler2DArrayShadow shadow_map;
+uniform mat4 shadow_matrices[SHADOW_CASCADES];
+// World size of a texel of each cascade
+uniform float shadow_texel_size[SHADOW_CASCADES];
+// Direction the light shines in
+uniform vec3 shadow_light_dir;
+
+// Fraction of the light reaching position, from the finest cascade that
+// holds it, filtered over 3x3 texels. Lit outside every cascade
+float shadow(vec3 position, vec3 normal)
+{
+    const float margin = 2.0 / SHADOW_MAP_SIZE;
+    for (int i = 0; i < SHADOW_CASCADES; i++) {
+        // Pushed out along the normal by about a texel, so the surface
+        // does not shadow itself
+        vec3 offset = position + normal * shadow_texel_size[i] * 1.5;
+        vec3 coord = (shadow_matrices[i] * vec4(offset, 1.0)).xyz * 0.5 + 0.5;
+        if (any(lessThan(coord.xy, vec2(margin))) || any(greaterThan(coord.xy, vec2(1.0 - margin))))
+            continue;
+        float lit = 0.0;
+        for (int y = -1; y <= 1; y++) {
+            for (int x = -1; x <= 1; x++)
+                lit += texture(shadow_map, vec4(coord.xy + vec2(x, y) / SHADOW_MAP_SIZE, float(i), min(coord.z, 1.0)));
+        }
+        return lit / 9.0;
+    }
+    return 1.0;
+}
@@ -0,0 +1,61 @@
+#version 330 core
+
+// Ambient occlusion at half resolution, see ambientocclusion.h. Points on a
+// disk around the pixel occlude it by how far they rise above its surface,
+// weighed down with distance up to radius. The pattern turns from pixel to
+// pixel and the blur after averages it out
+uniform sampler2D depth;
+// Perspective terms of the projection, see AmbientOcclusion::apply
+uniform vec4 unproject;
+uniform vec2 linearize;
+uniform float radius;
+uniform int samples;
+
+// Occlusion, 1 for none, and the linear depth for the blur
+out vec2 occlusion_depth;
+
+vec3 view_position(vec2 uv, float d)
+{
+    float z = linearize.x / (d * 2.0 - 1.0 + linearize.y);
+    return vec3((uv * 2.0 - 1.0 + unproject.zw) * unproject.xy * z, -z);
+}
+
+void main()
+{
+    // Texel i holds full resolution pixel 2i
+    vec2 size = vec2(textureSize(depth, 0));
+    vec2 uv = (floor(gl_FragCoord.xy) * 2.0 + 0.5) / size;
+    float d = texture(depth, uv).r;
+    if (d >= 1.0) {
+        // Nothing drawn, and a depth no surface is near
+        occlusion_depth = vec2(1.0, 60000.0);
+        return;
+    }
+    vec3 position = view_position(uv, d);
+
+    // Normal from the neighbors on the same side of an edge, the ones with
+    // the smaller depth step
+    vec2 texel = 1.0 / size;
+    vec3 right = view_position(uv + vec2(texel.x, 0.0), texture(depth, uv + vec2(texel.x, 0.0)).r) - position;
+    vec3 left = position - view_position(uv - vec2(texel.x, 0.0), texture(depth, uv - vec2(texel.x, 0.0)).r);
+    vec3 up = view_position(uv + vec2(0.0, texel.y), texture(depth, uv + vec2(0.0, texel.y)).r) - position;
+    vec3 down = position - view_position(uv - vec2(0.0, texel.y), texture(depth, uv - vec2(0.0, texel.y)).r);
+    vec3 normal = normalize(cross(abs(right.z) < abs(left.z) ? right : left, abs(up.z) < abs(down.z) ? up : down));
+
+    // The disk radius at this depth, in texture coordinates
+    vec2 disk = radius / (unproject.xy * 2.0 * -position.z);
+    float turn = 6.2831853 * fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+    float inverse_radius2 = 1.0 / (radius * radius), spacing = inversesqrt(float(samples));
+    float sum = 0.0;
+    for (int i = 0; i < samples; i++) {
+        float angle = float(i) * 2.3999632 + turn;
+        vec2 offset = vec2(cos(angle), sin(angle)) * (sqrt(float(i) + 0.5) * spacing) * disk;
+        float sample_depth = texture(depth, uv + offset).r;
+        vec3 v = view_position(uv + offset, sample_depth) - position;
+        float vv = dot(v, v);
+        // Below a small angle the surface occludes itself through depth error
+        float rise = dot(v, normal) * inversesqrt(vv + 1e-8);
+        sum += max(rise - 0.1, 0.0) * max(1.0 - vv * inverse_radius2, 0.0);
+    }
+    occlusion_depth = vec2(clamp(1.0 - 4.0 * sum / float(samples), 0.0, 1.0), -position.z);
+}
@@ -0,0 +1,32 @@
+#version 330 core
+
+// One direction of the separable blur of the occlusion, see
+// ambientocclusion.h. Texels count less the further their depth is from the
+// center's, so occlusion does not bleed across silhouettes
+uniform sampler2D occlusion;
+// (1, 0) or (0, 1)
+uniform vec2 direction;
+
+out vec2 occlusion_depth;
+
+// Binomial weights of 5 taps, the center first
+const float binomial[3] = float[3](0.375, 0.25, 0.0625);
+
+void main()
+{
+    vec2 texel = 1.0 / vec2(textureSize(occlusion, 0));
+    vec2 uv = gl_FragCoord.xy * texel;
+    vec2 center = texture(occlusion, uv).rg;
+    // Depth differences past 2% of the depth do not count
+    float sharpness = 50.0 / center.g;
+    float total = center.r * binomial[0], weights = binomial[0];
+    for (int i = 1; i <= 2; i++) {
+        vec2 before = texture(occlusion, uv - direction * (float(i) * texel)).rg;
+        vec2 after = texture(occlusion, uv + direction * (float(i) * texel)).rg;
+        float weight_before = binomial[i] * max(1.0 - abs(before.g - center.g) * sharpness, 0.0);
+        float weight_after = binomial[i] * max(1.0 - abs(after.g - center.g) * sharpness, 0.0);
+        total += before.r * weight_before + after.r * weight_after;
+        weights += weight_before + weight_after;
+    }
+    occlusion_depth = vec2(total / weights, center.g);
+}
@@ -0,0 +1,36 @@
+#version 330 core
+
+// Occlusion at full resolution, taken out of the ambient light, see
+// ambientocclusion.h. Of the four half resolution texels around the pixel,
+// those nearer its depth count more than their bilinear weight, so edges
+// stay sharp. Blended by subtraction into the image
+uniform sampler2D depth;
+uniform sampler2D occlusion;
+// Perspective terms of the projection, see AmbientOcclusion::apply
+uniform vec2 linearize;
+uniform vec3 ambient;
+
+out vec4 frag_color;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float d = texelFetch(depth, pixel, 0).r;
+    if (d >= 1.0)
+        discard;
+    float z = linearize.x / (d * 2.0 - 1.0 + linearize.y);
+
+    // Half resolution texel i holds full resolution pixel 2i, odd pixels
+    // lie halfway to the next
+    vec2 texel = 1.0 / vec2(textureSize(occlusion, 0));
+    vec2 uv = (vec2(pixel >> 1) + 0.5) * texel;
+    vec2 f = vec2(pixel & 1) * 0.5;
+    vec2 t00 = texture(occlusion, uv).rg;
+    vec2 t10 = texture(occlusion, uv + vec2(texel.x, 0.0)).rg;
+    vec2 t01 = texture(occlusion, uv + vec2(0.0, texel.y)).rg;
+    vec2 t11 = texture(occlusion, uv + texel).rg;
+    vec4 weights = vec4((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y) + 1e-3;
+    weights /= abs(vec4(t00.g, t10.g, t01.g, t11.g) - z) + 1e-3 * z;
+    float occluded = dot(weights, vec4(t00.r, t10.r, t01.r, t11.r)) / dot(weights, vec4(1.0));
+    frag_color = vec4(ambient * (1.0 - occluded), 0.0);
+}
@@ -2,10 +2,13 @@
 
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
+layout(location = 2) in mat4 instance;
+layout(location = 6) in float opacity;
 
 out FragData{
     vec3 frag_pos;
     vec3 frag_norm;
+    float frag_opacity;
 } vs_out;
 
 uniform mat4 model;
@@ -14,7 +17,9 @@ uniform mat4 projection;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(position, 1.0);
-    vs_out.frag_pos = vec3(model * vec4(position, 1.0));
-    vs_out.frag_norm = mat3(transpose(inverse(model))) * normal;
+    mat4 world = model * instance;
+    gl_Position = projection * view * world * vec4(position, 1.0);
+    vs_out.frag_pos = vec3(world * vec4(position, 1.0));
+    vs_out.frag_norm = mat3(transpose(inverse(world))) * normal;
+    vs_out.frag_opacity = opacity;
 }
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <GLFW/glfw3.h>
+#include <assimp/include/Tracer.h>
+#include "shader.h"
+
+// Permutations of one shader, each feature a #define in the sources (see
+// Shader::preprocess), so features cost nothing in the shaders that leave
+// them out. A variant is built the first time it is selected, and linked
+// programs go through ProgramCache like any other shader
+class ShaderVariants
+{
+public:
+    enum Feature {
+        // Geometry stage pushing triangles along their normal by "distance"
+        EXPLODE = 1,
+        // Directional and clustered lights, see lights.h
+        SCENE_LIGHTS = 2,
+        // Accumulation targets of weighted blended transparency, see transparency.h
+        OIT_ACCUMULATE = 4,
+        // Scene light from a fixed direction through cascaded shadow maps, see shadowmap.h
+        SHADOWS = 8,
+    };
+    static const unsigned int NUM_VARIANTS = 16;
+
+    // With a context sharing objects with the current one, optional features
+    // are compiled on a thread of their own, and select() makes do without
+    // them until they are ready. Without one every variant is built when it
+    // is first selected. The geometry stage is only attached for EXPLODE
+    ShaderVariants(const std::string& vertexPath, const std::string& fragmentPath, const std::string& geometryPath,
+        unsigned int optionalFeatures = EXPLODE | SCENE_LIGHTS, GLFWwindow* compileContext = nullptr)
+        : m_vertexPath(vertexPath), m_fragmentPath(fragmentPath), m_geometryPath(geometryPath),
+        m_optional(compileContext ? optionalFeatures : 0), m_context(compileContext) {
+        if (m_context)
+            m_compiler = std::thread(&ShaderVariants::compile, this);
+    }
+    ~ShaderVariants() {
+        if (m_compiler.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_wake.notify_one();
+            m_compiler.join();
+        }
+        for (std::unique_ptr<Shader>& variant : m_variants) {
+            if (variant)
+                glDeleteProgram(variant->get_id());
+        }
+        for (Finished& finished : m_finished) {
+            glDeleteSync(finished.fence);
+            glDeleteProgram(finished.shader->get_id());
+        }
+    }
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // The variant with these features, or the closest one built so far.
+    // Call it once per pass and keep the result for the pass' draws
+    Shader& select(unsigned int features) {
+        if (m_context)
+            collect();
+        if (!m_variants[features]) {
+            const unsigned int fallback = features & ~m_optional;
+            if (fallback != features) {
+                request(features);
+                features = fallback;
+            }
+            if (!m_variants[features])
+                m_variants[features].reset(build(features));
+        }
+        return *m_variants[features];
+    }
+    bool isReady(unsigned int features) const { return m_variants[features] != nullptr; }
+
+    // Number of variants built, and those of them loaded from ProgramCache
+    unsigned int getNumBuilt() const {
+        unsigned int built = 0;
+        for (const std::unique_ptr<Shader>& variant : m_variants)
+            built += variant != nullptr;
+        return built;
+    }
+    unsigned int getNumFromCache() const {
+        unsigned int cached = 0;
+        for (const std::unique_ptr<Shader>& variant : m_variants)
+            cached += variant && variant->is_from_cache();
+        return cached;
+    }
+    bool isCompiling() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return !m_queue.empty() || !m_finished.empty() || m_busy;
+    }
+
+private:
+    struct Finished {
+        unsigned int features;
+        std::unique_ptr<Shader> shader;
+        GLsync fence;
+    };
+
+    std::string m_vertexPath, m_fragmentPath, m_geometryPath;
+    unsigned int m_optional;
+    GLFWwindow* m_context;
+    std::unique_ptr<Shader> m_variants[NUM_VARIANTS];
+    // Variants asked for, whether queued, compiling or finished
+    bool m_requested[NUM_VARIANTS] = {};
+
+    std::thread m_compiler;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<unsigned int> m_queue;
+    std::vector<Finished> m_finished;
+    bool m_busy = false;
+    bool m_stop = false;
+
+    Shader* build(unsigned int features) const {
+        std::vector<std::string> defines;
+        if (features & EXPLODE)
+            defines.push_back("EXPLODE");
+        if (features & SCENE_LIGHTS)
+            defines.push_back("SCENE_LIGHTS");
+        if (features & OIT_ACCUMULATE)
+            defines.push_back("OIT_ACCUMULATE");
+        if (features & SHADOWS)
+            defines.push_back("SHADOWS");
+        return new Shader(m_vertexPath, m_fragmentPath, features & EXPLODE ? m_geometryPath : "", defines);
+    }
+
+    void request(unsigned int features) {
+        if (m_requested[features])
+            return;
+        m_requested[features] = true;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(features);
+        }
+        m_wake.notify_one();
+    }
+
+    // Take the programs whose compile the main context can see by now
+    void collect() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < m_finished.size();) {
+            GLenum status = glClientWaitSync(m_finished[i].fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                i++;
+                continue;
+            }
+            glDeleteSync(m_finished[i].fence);
+            m_variants[m_finished[i].features] = std::move(m_finished[i].shader);
+            m_finished.erase(m_finished.begin() + i);
+        }
+    }
+
+    // Compiler thread, on the context sharing objects with the main one
+    void compile() {
+        Assimp::Profiling::Tracer::SetThreadName("shader compiler");
+        glfwMakeContextCurrent(m_context);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_wake.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+            if (m_stop)
+                break;
+            const unsigned int features = m_queue.front();
+            m_queue.erase(m_queue.begin());
+            m_busy = true;
+            lock.unlock();
+            Finished finished = { features, nullptr, nullptr };
+            {
+                ASSIMP_TRACE_SCOPE("compile variant");
+                finished.shader.reset(build(features));
+            }
+            // The main context may use the program once this fence is signaled
+            finished.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+            lock.lock();
+            m_busy = false;
+            m_finished.push_back(std::move(finished));
+        }
+        lock.unlock();
+        glfwMakeContextCurrent(NULL);
+    }
+};
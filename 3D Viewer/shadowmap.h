@@ -0,0 +1,208 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "shader.h"
+
+// Cascaded shadow maps of a directional light, one layer of a depth texture
+// array per cascade, sampled by the SHADOWS variants (shaders/shadows.glsl).
+// The viewer's camera orbits a fixed target, so rather than splitting the
+// view frustum by depth, the cascades are nested squares around the target
+// as the light sees it: the innermost about the size of the view there, the
+// last covering the whole scene. Every cascade is clipped to the light's
+// view of the scene box and spans its full depth, so each holds all casters
+// over the part it covers.
+//
+// The fit depends on the light, the scene box and transform, and the zoom
+// rounded to powers of two, but not on the camera's direction, so orbiting
+// keeps the maps: fit() reports whether they need drawing again, for a new
+// light or geometry version or zoom level. Usage per frame:
+//
+//   if (shadows.fit(direction, boundsMin, boundsMax, model, version, target, viewExtent))
+//       shadows.render([](const glm::mat4& lightViewProjection, Shader& depth) { draw the casters });
+//   shadows.apply(shader);
+class CascadedShadowMap
+{
+public:
+    // Match shaders/shadows.glsl
+    static const int CASCADES = 3;
+    static const int SIZE = 2048;
+    // After the clustered light buffers, see ClusteredLights::apply
+    static const int TEXTURE_UNIT = 5;
+    // Innermost cascade at most 2^MAX_HALVINGS times smaller than the scene
+    static const int MAX_HALVINGS = 8;
+
+    CascadedShadowMap() : m_depth("shaders/shadow.glsl", "shaders/depthonly.glsl") {
+        glGenTextures(1, &m_texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, SIZE, SIZE, CASCADES, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        // Filtered depth comparisons for sampler2DArrayShadow
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        GLint framebuffer = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+        glGenFramebuffers(1, &m_framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_texture, 0, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "Shadow framebuffer incomplete" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+    ~CascadedShadowMap() {
+        glDeleteProgram(m_depth.get_id());
+        glDeleteFramebuffers(1, &m_framebuffer);
+        glDeleteTextures(1, &m_texture);
+    }
+    CascadedShadowMap(const CascadedShadowMap&) = delete;
+    CascadedShadowMap& operator=(const CascadedShadowMap&) = delete;
+
+    // Direction a light shines in, from its azimuth around the vertical and
+    // its elevation above the horizon, in degrees
+    static glm::vec3 direction(float azimuth, float elevation) {
+        const float a = glm::radians(azimuth), e = glm::radians(elevation);
+        return -glm::vec3(std::cos(e) * std::cos(a), std::sin(e), std::cos(e) * std::sin(a));
+    }
+
+    // Fit the cascades to the casters: the box from boundsMin to boundsMax
+    // under transform, at geometry version. target is the point the camera
+    // orbits and viewExtent the half height of the view there. Returns
+    // whether the maps are out of date and need render()
+    bool fit(const glm::vec3& direction, const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& transform,
+        unsigned int version, const glm::vec3& target, float viewExtent) {
+        const glm::vec3 forward = glm::normalize(direction);
+        const glm::vec3 up = std::abs(forward.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        const glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), forward, up);
+
+        // The scene box as the light sees it, padded so surfaces lying on
+        // its faces stay inside the depth range
+        glm::vec3 low(FLT_MAX), high(-FLT_MAX);
+        for (int corner = 0; corner < 8; corner++) {
+            const glm::vec3 local(corner & 1 ? boundsMax.x : boundsMin.x, corner & 2 ? boundsMax.y : boundsMin.y,
+                corner & 4 ? boundsMax.z : boundsMin.z);
+            const glm::vec3 light = glm::vec3(lightView * transform * glm::vec4(local, 1.0f));
+            low = glm::min(low, light);
+            high = glm::max(high, light);
+        }
+        const float pad = std::max(glm::length(high - low) * 0.01f, 1e-4f);
+        low -= pad;
+        high += pad;
+
+        // The innermost square is the scene's halved while it stays larger
+        // than the view, so zooming only refits past a factor of two
+        const float sceneHalf = std::max(high.x - low.x, high.y - low.y) * 0.5f;
+        int halvings = 0;
+        while (halvings < MAX_HALVINGS && sceneHalf / (float)(2 << halvings) >= viewExtent)
+            halvings++;
+        const glm::vec2 center = glm::vec2(lightView * glm::vec4(target, 1.0f));
+
+        glm::mat4 matrices[CASCADES];
+        float texelSizes[CASCADES];
+        for (int i = 0; i < CASCADES; i++) {
+            glm::vec2 rectLow(low), rectHigh(high);
+            if (i + 1 < CASCADES) {
+                const float half = sceneHalf * std::exp2(-(float)halvings * (CASCADES - 1 - i) / (CASCADES - 1));
+                rectLow = glm::max(rectLow, center - half);
+                rectHigh = glm::min(rectHigh, center + half);
+                // A target outside the scene, nothing finer to draw
+                if (rectHigh.x <= rectLow.x || rectHigh.y <= rectLow.y) {
+                    rectLow = glm::vec2(low);
+                    rectHigh = glm::vec2(high);
+                }
+            }
+            // The light looks down -z, its nearest casters have the highest z
+            matrices[i] = glm::ortho(rectLow.x, rectHigh.x, rectLow.y, rectHigh.y, -high.z, -low.z) * lightView;
+            texelSizes[i] = std::max(rectHigh.x - rectLow.x, rectHigh.y - rectLow.y) / SIZE;
+        }
+
+        bool current = m_rendered && version == m_version && transform == m_transform && forward == m_direction;
+        for (int i = 0; i < CASCADES; i++)
+            current = current && matrices[i] == m_matrices[i];
+        if (current)
+            return false;
+        m_version = version;
+        m_transform = transform;
+        m_direction = forward;
+        std::copy(matrices, matrices + CASCADES, m_matrices);
+        std::copy(texelSizes, texelSizes + CASCADES, m_texelSizes);
+        return true;
+    }
+
+    // Draw every cascade of the last fit(). draw(lightViewProjection, depth)
+    // draws the casters with the depth shader in use, which takes the model
+    // matrix as "model" and instances like the scene shaders
+    template <typename DrawCasters>
+    void render(DrawCasters draw) {
+        GLint framebuffer = 0, program = 0, viewport[4], polygonMode[2] = { GL_FILL, GL_FILL };
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetIntegerv(GL_POLYGON_MODE, polygonMode);
+        const GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glViewport(0, 0, SIZE, SIZE);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        // Both faces cast, so open meshes do too. The slope scaled offset
+        // keeps lit surfaces from shadowing themselves
+        glDisable(GL_CULL_FACE);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0f, 2.0f);
+        m_depth.use();
+        for (int i = 0; i < CASCADES; i++) {
+            // Zoomed out the cascades can be the same, and the shader never
+            // gets past the first of them
+            if (i > 0 && m_matrices[i] == m_matrices[i - 1])
+                continue;
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_texture, 0, i);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            m_depth.setMat4("light_view_projection", m_matrices[i]);
+            draw(m_matrices[i], m_depth);
+        }
+        glDisable(GL_POLYGON_OFFSET_FILL);
+
+        if (cullFace)
+            glEnable(GL_CULL_FACE);
+        glPolygonMode(GL_FRONT_AND_BACK, polygonMode[0]);
+        glUseProgram(program);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        m_rendered = true;
+    }
+
+    // Bind the maps and set the cascades of a SHADOWS variant
+    void apply(Shader& shader) const {
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+        glActiveTexture(GL_TEXTURE0);
+        shader.setInt("shadow_map", TEXTURE_UNIT);
+        shader.setVec3("shadow_light_dir", m_direction);
+        for (int i = 0; i < CASCADES; i++) {
+            shader.setMat4("shadow_matrices[" + std::to_string(i) + "]", m_matrices[i]);
+            shader.setFloat("shadow_texel_size[" + std::to_string(i) + "]", m_texelSizes[i]);
+        }
+    }
+
+private:
+    Shader m_depth;
+    unsigned int m_texture = 0, m_framebuffer = 0;
+    // What the maps were last fitted to
+    glm::mat4 m_matrices[CASCADES];
+    float m_texelSizes[CASCADES] = {};
+    glm::mat4 m_transform = glm::mat4(1.0f);
+    glm::vec3 m_direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    unsigned int m_version = 0;
+    bool m_rendered = false;
+};
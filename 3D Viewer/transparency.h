@@ -0,0 +1,161 @@
+#pragma once
+
+#include <iostream>
+#include "shader.h"
+
+// Weighted blended order-independent transparency (McGuire and Bavoil, 2013).
+// Transparent surfaces are drawn in any order into two targets: the sum of
+// their weighted, premultiplied colors and the product of their
+// transparencies. composite() blends the weighted average over the opaque
+// image, so no mesh has to be sorted. Usage per frame:
+//
+//   draw the opaque meshes into target
+//   oit.begin(target, width, height);
+//   draw the transparent meshes with the OIT_ACCUMULATE shader variant
+//   oit.composite(target);
+//
+// The opaque depth is copied in first, so transparent surfaces behind opaque
+// ones are rejected. The accumulation targets are not multisampled
+class WeightedBlendedOIT
+{
+public:
+    WeightedBlendedOIT() : m_composite("shaders/fullscreen.glsl", "shaders/composite.glsl") {
+        GLint program = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        m_composite.use();
+        m_composite.setInt("accumulation", 0);
+        m_composite.setInt("revealage", 1);
+        glUseProgram(program);
+
+        glGenVertexArrays(1, &m_vao);
+        glGenFramebuffers(1, &m_framebuffer);
+        glGenTextures(2, m_textures);
+        glGenRenderbuffers(1, &m_depth);
+    }
+    ~WeightedBlendedOIT() {
+        glDeleteProgram(m_composite.get_id());
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteFramebuffers(1, &m_framebuffer);
+        glDeleteTextures(2, m_textures);
+        glDeleteRenderbuffers(1, &m_depth);
+    }
+    WeightedBlendedOIT(const WeightedBlendedOIT&) = delete;
+    WeightedBlendedOIT& operator=(const WeightedBlendedOIT&) = delete;
+
+    // Take the depth of target (0 for the window), clear the accumulation
+    // targets and set up their blending. Leaves them bound for drawing
+    void begin(unsigned int target, int width, int height) {
+        if (width != m_width || height != m_height || target != m_target)
+            allocate(target, width, height);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, target);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffer);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glViewport(0, 0, width, height);
+
+        const float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        const float one[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        glClearBufferfv(GL_COLOR, 0, zero);
+        glClearBufferfv(GL_COLOR, 1, one);
+
+        // Test against the opaque depth without writing it
+        glDepthMask(GL_FALSE);
+        glEnable(GL_BLEND);
+        glBlendFunci(0, GL_ONE, GL_ONE);
+        glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+    }
+
+    // Blend the transparent layer over target and restore the default state
+    void composite(unsigned int target) {
+        GLint program = 0, polygonMode[2] = { GL_FILL, GL_FILL };
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        glGetIntegerv(GL_POLYGON_MODE, polygonMode);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+        glViewport(0, 0, m_width, m_height);
+        glDisable(GL_DEPTH_TEST);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        m_composite.use();
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, m_textures[1]);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_textures[0]);
+        glBindVertexArray(m_vao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glUseProgram(program);
+        glPolygonMode(GL_FRONT_AND_BACK, polygonMode[0]);
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_TRUE);
+    }
+
+private:
+    Shader m_composite;
+    unsigned int m_vao, m_framebuffer, m_depth;
+    // Accumulated color and revealage
+    unsigned int m_textures[2];
+    int m_width = 0, m_height = 0;
+    unsigned int m_target = ~0u;
+
+    // Size the targets, with a depth format the blit from target accepts
+    void allocate(unsigned int target, int width, int height) {
+        m_width = width;
+        m_height = height;
+        m_target = target;
+
+        const GLenum formats[2] = { GL_RGBA16F, GL_R8 };
+        for (int i = 0; i < 2; i++) {
+            glBindTexture(GL_TEXTURE_2D, m_textures[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, formats[i], width, height, 0, i ? GL_RED : GL_RGBA, GL_FLOAT, NULL);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, depthFormat(target), width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_textures[0], 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_textures[1], 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, stencilBits(target) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+            GL_RENDERBUFFER, m_depth);
+        const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, drawBuffers);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "Transparency framebuffer incomplete" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+    }
+
+    // Depth blits need matching formats, pick the one of target
+    static GLenum depthFormat(unsigned int target) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, target);
+        GLint depthBits = 24, componentType = GL_UNSIGNED_NORMALIZED;
+        const GLenum attachment = target ? GL_DEPTH_ATTACHMENT : GL_DEPTH;
+        glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depthBits);
+        glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE, &componentType);
+        const bool stencil = stencilBits(target) > 0;
+        if (componentType == GL_FLOAT)
+            return stencil ? GL_DEPTH32F_STENCIL8 : GL_DEPTH_COMPONENT32F;
+        if (stencil)
+            return GL_DEPTH24_STENCIL8;
+        return depthBits <= 16 ? GL_DEPTH_COMPONENT16 : depthBits >= 32 ? GL_DEPTH_COMPONENT32 : GL_DEPTH_COMPONENT24;
+    }
+    static GLint stencilBits(unsigned int target) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, target);
+        const GLenum attachment = target ? GL_STENCIL_ATTACHMENT : GL_STENCIL;
+        GLint type = GL_NONE, bits = 0;
+        glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+        if (type != GL_NONE)
+            glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &bits);
+        return bits;
+    }
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <assimp/include/Tracer.h>
+
+// Persistent threads for short loops that run every frame, where starting
+// threads each time would cost more than the work itself
+class WorkerPool
+{
+public:
+    // One thread per core besides the caller, which also takes part
+    explicit WorkerPool(unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency()) - 1) {
+        for (unsigned int i = 0; i < numThreads; i++)
+            m_threads.emplace_back(&WorkerPool::work, this);
+    }
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& thread : m_threads)
+            thread.join();
+    }
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Call job(begin, end) on chunks of [0, count) and return when all are
+    // done. Runs on the caller alone when there is a single chunk
+    void parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& job) {
+        chunkSize = std::max<size_t>(1, chunkSize);
+        if (count <= chunkSize || m_threads.empty()) {
+            if (count)
+                job(0, count);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &job;
+            m_count = count;
+            m_chunkSize = chunkSize;
+            m_next = 0;
+            m_busy = (unsigned int)m_threads.size();
+            m_generation++;
+        }
+        m_wake.notify_all();
+        run(job, count, chunkSize);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]() { return m_busy == 0; });
+        m_job = nullptr;
+    }
+    unsigned int getNumThreads() const { return (unsigned int)m_threads.size() + 1; }
+
+private:
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake, m_done;
+    // Current loop, written under the mutex before the workers wake
+    const std::function<void(size_t, size_t)>* m_job = nullptr;
+    size_t m_count = 0, m_chunkSize = 1;
+    std::atomic<size_t> m_next{ 0 };
+    unsigned int m_busy = 0;
+    unsigned long long m_generation = 0;
+    bool m_stop = false;
+
+    void run(const std::function<void(size_t, size_t)>& job, size_t count, size_t chunkSize) {
+        for (size_t begin = m_next.fetch_add(chunkSize); begin < count; begin = m_next.fetch_add(chunkSize))
+            job(begin, std::min(begin + chunkSize, count));
+    }
+    void work() {
+        Assimp::Profiling::Tracer::SetThreadName("worker pool");
+        unsigned long long generation = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_wake.wait(lock, [&]() { return m_stop || m_generation != generation; });
+            if (m_stop)
+                return;
+            generation = m_generation;
+            const std::function<void(size_t, size_t)>& job = *m_job;
+            const size_t count = m_count, chunkSize = m_chunkSize;
+            lock.unlock();
+            run(job, count, chunkSize);
+            lock.lock();
+            if (--m_busy == 0)
+                m_done.notify_one();
+        }
+    }
+};